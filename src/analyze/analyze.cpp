@@ -65,10 +65,22 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         get_clause(x->conds, query->conds);
         check_clause({x->tab_name}, query->conds);        
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(parse)) {
-        // 处理insert 的values值
-        for (auto &sv_val : x->vals) {
-            query->values.push_back(convert_sv_value(sv_val));
+        // 处理insert 的values值，多行VALUES按行依次展开，每行的值个数必须等于表的列数
+        size_t num_cols = sm_manager_->db_.get_table(x->tab_name).cols.size();
+        for (auto &row : x->rows) {
+            if (row.size() != num_cols) {
+                throw InvalidValueCountError();
+            }
+            for (auto &sv_val : row) {
+                query->values.push_back(convert_sv_value(sv_val));
+            }
+        }
+    } else if (auto x = std::dynamic_pointer_cast<ast::LoadData>(parse)) {
+        if (!sm_manager_->db_.is_table(x->tab_name)) {
+            throw TableNotFoundError(x->tab_name);
         }
+    } else if (auto x = std::dynamic_pointer_cast<ast::SetVariable>(parse)) {
+        query->values.push_back(convert_sv_value(x->val));
     } else {
         // do nothing
     }
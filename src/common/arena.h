@@ -0,0 +1,83 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @description: 按块分配的bump分配器。每次分配只移动块内的指针，不能单独释放，
+ * 所有内存在reset或析构时一次性释放，适合生命周期相同的大量小对象（如一条查询中的元组）
+ */
+class Arena {
+   public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @description: 分配size字节，内容未初始化
+     * @param {size_t} size 字节数
+     * @param {size_t} align 对齐要求，必须是2的幂
+     * @return {char*} 分配到的地址，在reset之前一直有效
+     */
+    char *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (size + align > block_size_) {
+            // 大于块大小的请求单独占用一块，当前块不变，不浪费其剩余空间
+            blocks_.emplace_back(new char[size + align]);
+            bytes_allocated_ += size;
+            return align_up(blocks_.back().get(), align);
+        }
+        char *aligned = cur_ == nullptr ? nullptr : align_up(cur_, align);
+        if (aligned == nullptr || aligned + size > end_) {
+            new_block(block_size_);
+            aligned = align_up(cur_, align);
+        }
+        cur_ = aligned + size;
+        bytes_allocated_ += size;
+        return aligned;
+    }
+
+    // 释放所有块，之前分配的地址全部失效
+    void reset() {
+        blocks_.clear();
+        cur_ = end_ = nullptr;
+        bytes_allocated_ = 0;
+    }
+
+    size_t get_bytes_allocated() const { return bytes_allocated_; }
+
+    size_t get_num_blocks() const { return blocks_.size(); }
+
+   private:
+    static char *align_up(char *p, size_t align) {
+        uintptr_t addr = (reinterpret_cast<uintptr_t>(p) + align - 1) & ~(uintptr_t)(align - 1);
+        return reinterpret_cast<char *>(addr);
+    }
+
+    void new_block(size_t size) {
+        blocks_.emplace_back(new char[size]);
+        cur_ = blocks_.back().get();
+        end_ = cur_ + size;
+    }
+
+    size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char *cur_ = nullptr;
+    char *end_ = nullptr;
+    size_t bytes_allocated_ = 0;
+};
@@ -56,19 +56,38 @@ struct Value {
     void init_raw(int len) {
         assert(raw == nullptr);
         raw = std::make_shared<RmRecord>(len);
+        write_raw(raw->data, len);
+    }
+
+    // 把值按len字节的字段格式写入dst，不分配内存
+    void write_raw(char *dst, int len) const {
         if (type == TYPE_INT) {
             assert(len == sizeof(int));
-            *(int *)(raw->data) = int_val;
+            *(int *)(dst) = int_val;
         } else if (type == TYPE_FLOAT) {
             assert(len == sizeof(float));
-            *(float *)(raw->data) = float_val;
+            *(float *)(dst) = float_val;
         } else if (type == TYPE_STRING) {
             if (len < (int)str_val.size()) {
                 throw StringOverflowError();
             }
-            memset(raw->data, 0, len);
-            memcpy(raw->data, str_val.c_str(), str_val.size());
+            memset(dst, 0, len);
+            memcpy(dst, str_val.c_str(), str_val.size());
+        }
+    }
+
+    /**
+     * @description: 返回值按len字节的字段格式编码后的数据，已经init_raw时直接返回raw，否则在arena中编码一份
+     * @param {int} len 字段长度
+     * @param {Arena*} arena 分配编码结果的arena
+     */
+    const char *raw_data(int len, Arena *arena) const {
+        if (raw != nullptr) {
+            return raw->data;
         }
+        char *dst = arena->allocate(len);
+        write_raw(dst, len);
+        return dst;
     }
 };
 
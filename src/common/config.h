@@ -35,8 +35,22 @@ static constexpr int HEADER_PAGE_ID = 0;                                      //
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
 static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_MAX_SIZE = 262144;                           // upper bound for online resize 1GB
+static constexpr int BUFFER_POOL_PARTITIONS = 16;                             // independently latched shards of the pool
+static constexpr int BUFFER_POOL_LATCH_SAMPLE_RATE = 64;                      // time one in N partition latch holds
+static constexpr int BUFFER_POOL_STATS_INTERVAL_SEC = 60;                     // period of the stats dump, 0 disables
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;                          // back frame data with 2MB pages if possible
+static constexpr bool BUFFER_POOL_NUMA_AWARE = true;                          // bind partitions round-robin to NUMA nodes
+static constexpr bool USE_DIRECT_IO = false;                                  // open table/index files with O_DIRECT
+static constexpr bool USE_ASYNC_IO = false;                                   // serve buffer pool misses through io_uring
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 256;                              // io_uring submission queue entries
+static constexpr int ASYNC_IO_THREADS = 4;                                    // workers of the thread-pool io backend
+static constexpr int READ_AHEAD_MIN_PAGES = 4;                                // initial sequential read-ahead window
+static constexpr int READ_AHEAD_MAX_PAGES = 128;                              // largest read-ahead window (512KB)
+static constexpr int READ_AHEAD_POOL_FRACTION = 8;                            // window never exceeds pool_size / 8
+static constexpr int RM_RECORD_INLINE_SIZE = 64;                              // records up to this size live inside RmRecord
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -49,7 +63,18 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
 
-// replacer
+// periodic buffer pool stats dump, appended in the database directory
+static const std::string BUFFER_POOL_STATS_FILE_NAME = "buffer_pool_stats.txt";
+
+// replacer, one of "LRU", "CLOCK", "LRU-K", "2Q"; can be overridden at startup
 static const std::string REPLACER_TYPE = "LRU";
+static constexpr size_t LRU_K = 2;                                            // history depth of the LRU-K replacer
+static constexpr size_t TWO_Q_A1_FRACTION = 4;                                // 2Q keeps at most pool_size / 4 frames in A1
+
+// background page cleaner
+static constexpr double PAGE_CLEANER_DIRTY_RATIO = 0.1;                       // keep at most 10% of the frames dirty
+static constexpr size_t PAGE_CLEANER_MAX_PAGES_PER_SEC = 4096;                // write-back rate limit (16MB/s)
+static constexpr int PAGE_CLEANER_INTERVAL_MS = 100;                          // the cleaner wakes up this often
+static constexpr size_t PAGE_CLEANER_LRU_SCAN_DEPTH = 1024;                   // cold frames examined per partition per round
 
 static const std::string DB_META_NAME = "db.meta";
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include "transaction/transaction.h"
 #include "transaction/concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
+#include "common/arena.h"
 
 // class TransactionManager;
 
@@ -35,4 +36,5 @@ public:
     char *data_send_;
     int *offset_;
     bool ellipsis_;
+    Arena arena_;       // 本条语句执行期间的临时内存（谓词常量、索引键、算子的输出缓冲区），在Portal::drop时一次性释放
 };
\ No newline at end of file
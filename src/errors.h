@@ -82,6 +82,11 @@ class IndexEntryNotFoundError : public RMDBError {
     IndexEntryNotFoundError() : RMDBError("Index entry not found") {}
 };
 
+class IndexDuplicateKeyError : public RMDBError {
+   public:
+    IndexDuplicateKeyError() : RMDBError("Duplicate index key") {}
+};
+
 // SM errors
 class DatabaseNotFoundError : public RMDBError {
    public:
@@ -149,6 +154,11 @@ class IncompatibleTypeError : public RMDBError {
         : RMDBError("Incompatible type error: lhs " + lhs + ", rhs " + rhs) {}
 };
 
+class UnknownVariableError : public RMDBError {
+   public:
+    UnknownVariableError(const std::string &name) : RMDBError("Unknown variable: " + name) {}
+};
+
 class AmbiguousColumnError : public RMDBError {
    public:
     AmbiguousColumnError(const std::string &col_name) : RMDBError("Ambiguous column: " + col_name) {}
@@ -0,0 +1,463 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "data_loader.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOADER_HAS_AVX2_PATH 1
+#endif
+
+namespace {
+
+/* 解析出错时抛出，offset为出错的行在数据块中的位置，由调用者换算为文件中的位置 */
+struct ParseError {
+    size_t offset;
+    std::string msg;
+};
+
+#ifdef LOADER_HAS_AVX2_PATH
+bool has_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+/** @return [p, end)中第一个逗号或换行符的位置，不跨过end之前最后一个完整的32字节块，没有时返回块之后的位置 */
+__attribute__((target("avx2"))) const char *find_delim_avx2(const char *p, const char *end) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, comma), _mm256_cmpeq_epi8(v, newline));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return p;
+}
+#endif
+
+/** @return [p, end)中第一个逗号或换行符的位置，没有时返回end */
+const char *find_delim(const char *p, const char *end) {
+#ifdef LOADER_HAS_AVX2_PATH
+    if (end - p >= 32 && has_avx2()) {
+        p = find_delim_avx2(p, end);
+        if (p < end && (*p == ',' || *p == '\n')) {
+            return p;
+        }
+    }
+#endif
+    while (p < end && *p != ',' && *p != '\n') {
+        p++;
+    }
+    return p;
+}
+
+}  // namespace
+
+DataLoader::DataLoader(SmManager *sm_manager, const std::string &tab_name, Context *context)
+    : sm_manager_(sm_manager), context_(context) {
+    tab_ = sm_manager_->db_.get_table(tab_name);
+    fh_ = sm_manager_->fhs_.at(tab_name).get();
+    record_size_ = fh_->get_file_hdr().record_size;
+    for (auto &index : tab_.indexes) {
+        std::vector<ColType> col_types;
+        std::vector<int> col_lens;
+        for (auto &col : index.cols) {
+            col_types.push_back(col.type);
+            col_lens.push_back(col.len);
+        }
+        sorters_.push_back(std::make_unique<IxExternalSorter>(col_types, col_lens));
+    }
+}
+
+LoadStats DataLoader::load(const std::string &file_name, LoadFormat format) {
+    format_ = format;
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileNotFoundError(file_name);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    LoadStats stats;
+
+    // 工作线程从pending中取出数据块解析，结果按序号放入done；主线程按序号顺序写入表中
+    std::mutex latch;
+    std::condition_variable cv;
+    std::deque<Chunk *> pending;
+    std::map<size_t, std::unique_ptr<Chunk>> done;
+    bool stop = false;
+    int num_workers = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, MAX_WORKERS);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_workers; i++) {
+        workers.emplace_back([&]() {
+            std::unique_lock<std::mutex> lock(latch);
+            while (true) {
+                cv.wait(lock, [&]() { return stop || !pending.empty(); });
+                if (stop) {
+                    return;
+                }
+                Chunk *chunk = pending.front();
+                pending.pop_front();
+                lock.unlock();
+                try {
+                    parse(*chunk);
+                } catch (...) {
+                    chunk->error = std::current_exception();
+                }
+                lock.lock();
+                done.emplace(chunk->seq, std::unique_ptr<Chunk>(chunk));
+                cv.notify_all();
+            }
+        });
+    }
+    auto stop_workers = [&]() {
+        {
+            std::scoped_lock lock(latch);
+            stop = true;
+            for (Chunk *chunk : pending) {
+                delete chunk;
+            }
+            pending.clear();
+        }
+        cv.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        close(fd);
+    };
+
+    try {
+        std::vector<char> carry;  // 上一次读取中最后一个换行符之后的不完整的行
+        off_t read_offset = 0;    // 下一次读取的位置
+        off_t chunk_offset = 0;   // 下一个数据块在文件中的起始位置
+        bool eof = false;
+        size_t next_read_seq = 0;
+        size_t next_insert_seq = 0;
+        size_t max_in_flight = 2 * num_workers;
+        while (true) {
+            // 保持流水线中有足够的数据块，使工作线程不空闲
+            while (!eof && next_read_seq - next_insert_seq < max_in_flight) {
+                auto chunk = std::make_unique<Chunk>();
+                chunk->data = std::move(carry);
+                carry.clear();
+                size_t old_size = chunk->data.size();
+                chunk->data.resize(old_size + CHUNK_SIZE);
+                ssize_t n = pread(fd, chunk->data.data() + old_size, CHUNK_SIZE, read_offset);
+                if (n < 0) {
+                    throw UnixError();
+                }
+                read_offset += n;
+                stats.bytes += n;
+                chunk->data.resize(old_size + n);
+                eof = n == 0;
+                size_t cut = chunk->data.size();
+                if (format_ == LOAD_FORMAT_CSV && !eof) {
+                    auto last = static_cast<const char *>(memrchr(chunk->data.data(), '\n', chunk->data.size()));
+                    cut = last == nullptr ? 0 : last - chunk->data.data() + 1;
+                } else if (format_ == LOAD_FORMAT_BINARY) {
+                    cut -= cut % record_size_;
+                    if (eof && cut != chunk->data.size()) {
+                        throw InternalError("LOAD DATA: file size is not a multiple of the record size " +
+                                            std::to_string(record_size_));
+                    }
+                }
+                carry.assign(chunk->data.begin() + cut, chunk->data.end());
+                chunk->data.resize(cut);
+                if (chunk->data.empty()) {
+                    // 一行超过CHUNK_SIZE时继续读取，直到读到换行符
+                    continue;
+                }
+                chunk->seq = next_read_seq++;
+                chunk->file_offset = chunk_offset;
+                chunk_offset += cut;
+                {
+                    std::scoped_lock lock(latch);
+                    pending.push_back(chunk.release());
+                }
+                cv.notify_all();
+            }
+            if (eof && next_insert_seq == next_read_seq) {
+                break;
+            }
+
+            std::unique_ptr<Chunk> chunk;
+            {
+                std::unique_lock<std::mutex> lock(latch);
+                cv.wait(lock, [&]() { return done.count(next_insert_seq) > 0; });
+                chunk = std::move(done[next_insert_seq]);
+                done.erase(next_insert_seq);
+            }
+            next_insert_seq++;
+            if (chunk->error) {
+                std::rethrow_exception(chunk->error);
+            }
+            insert_chunk(*chunk);
+            stats.rows += chunk->num_rows;
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report >= std::chrono::seconds(1)) {
+                double seconds = std::chrono::duration<double>(now - start).count();
+                std::cout << "LOAD DATA " << tab_.name << ": " << stats.rows << " rows, "
+                          << static_cast<size_t>(stats.rows / seconds) << " rows/s" << std::endl;
+                last_report = now;
+            }
+        }
+    } catch (...) {
+        stop_workers();
+        rollback();
+        throw;
+    }
+    stop_workers();
+
+    try {
+        build_indexes();
+    } catch (...) {
+        rollback();
+        throw;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "LOAD DATA " << tab_.name << ": " << stats.rows << " rows in " << stats.seconds << " s, "
+              << static_cast<size_t>(stats.rows_per_sec()) << " rows/s" << std::endl;
+    return stats;
+}
+
+/**
+ * @description: 在工作线程中把数据块解析为记录，出错时抛出的异常由主线程重新抛出
+ */
+void DataLoader::parse(Chunk &chunk) const {
+    if (format_ == LOAD_FORMAT_BINARY) {
+        chunk.num_rows = static_cast<int>(chunk.data.size() / record_size_);
+        chunk.records = std::move(chunk.data);
+        return;
+    }
+    try {
+        parse_csv(chunk);
+    } catch (ParseError &e) {
+        throw InternalError("LOAD DATA: " + e.msg + " at byte offset " +
+                            std::to_string(chunk.file_offset + static_cast<off_t>(e.offset)));
+    }
+}
+
+void DataLoader::parse_csv(Chunk &chunk) const {
+    const char *base = chunk.data.data();
+    const char *p = base;
+    const char *end = base + chunk.data.size();
+    size_t num_cols = tab_.cols.size();
+    std::string quoted;
+    while (p < end) {
+        const char *line = p;
+        if (*p == '\n' || (*p == '\r' && p + 1 < end && p[1] == '\n')) {
+            p += *p == '\n' ? 1 : 2;  // 跳过空行
+            continue;
+        }
+        chunk.records.resize(chunk.records.size() + record_size_);
+        char *rec = chunk.records.data() + chunk.records.size() - record_size_;
+        memset(rec, 0, record_size_);
+        for (size_t i = 0; i < num_cols; i++) {
+            const char *field_begin;
+            const char *field_end;
+            if (p < end && *p == '"') {
+                // 带引号的字段，两个双引号表示一个双引号。数据块在换行符处切分时不考虑引号，
+                // 因此引号中的换行符无论是否跨数据块都视为错误，结果才与数据块的大小无关
+                quoted.clear();
+                p++;
+                const char *line_end = static_cast<const char *>(memchr(p, '\n', end - p));
+                if (line_end == nullptr) {
+                    line_end = end;
+                }
+                while (true) {
+                    const char *q = static_cast<const char *>(memchr(p, '"', line_end - p));
+                    if (q == nullptr) {
+                        const char *msg = line_end < end ? "newline in quoted field" : "unterminated quoted field";
+                        throw ParseError{static_cast<size_t>(line - base), msg};
+                    }
+                    quoted.append(p, q);
+                    p = q + 1;
+                    if (p < end && *p == '"') {
+                        quoted.push_back('"');
+                        p++;
+                        continue;
+                    }
+                    break;
+                }
+                field_begin = quoted.data();
+                field_end = quoted.data() + quoted.size();
+                if (p < end && *p == '\r' && (p + 1 == end || p[1] == '\n')) {
+                    p++;
+                }
+            } else {
+                field_begin = p;
+                p = find_delim(p, end);
+                field_end = p;
+                if (field_end > field_begin && field_end[-1] == '\r' && (p == end || *p == '\n')) {
+                    field_end--;
+                }
+            }
+            try {
+                convert_field(field_begin, field_end, tab_.cols[i], rec + tab_.cols[i].offset);
+            } catch (RMDBError &e) {
+                // 去掉RMDBError消息开头的"Error: "
+                std::string msg = e.what();
+                msg = msg.substr(std::min(msg.size(), strlen("Error: ")));
+                throw ParseError{static_cast<size_t>(line - base), "column " + tab_.cols[i].name + ": " + msg};
+            }
+            if (i + 1 < num_cols) {
+                if (p >= end || *p != ',') {
+                    throw ParseError{static_cast<size_t>(line - base),
+                                     "expected " + std::to_string(num_cols) + " fields, got " + std::to_string(i + 1)};
+                }
+                p++;
+            } else if (p < end && *p != '\n') {
+                throw ParseError{static_cast<size_t>(line - base),
+                                 "expected " + std::to_string(num_cols) + " fields, got more"};
+            } else if (p < end) {
+                p++;
+            }
+        }
+        chunk.num_rows++;
+    }
+}
+
+void DataLoader::convert_field(const char *begin, const char *end, const ColMeta &col, char *dst) const {
+    if (col.type == TYPE_STRING) {
+        if (end - begin > col.len) {
+            throw StringOverflowError();
+        }
+        memcpy(dst, begin, end - begin);
+        return;
+    }
+    // 数值两侧允许有空格
+    while (begin < end && *begin == ' ') {
+        begin++;
+    }
+    while (end > begin && end[-1] == ' ') {
+        end--;
+    }
+    if (col.type == TYPE_INT) {
+        int value;
+        auto result = std::from_chars(begin, end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            throw IncompatibleTypeError(coltype2str(TYPE_INT), "'" + std::string(begin, end) + "'");
+        }
+        memcpy(dst, &value, sizeof(int));
+    } else {
+        char buf[64];
+        size_t len = std::min<size_t>(end - begin, sizeof(buf) - 1);
+        memcpy(buf, begin, len);
+        buf[len] = '\0';
+        char *parsed;
+        float value = strtof(buf, &parsed);
+        if (len == 0 || parsed != buf + len || len != static_cast<size_t>(end - begin)) {
+            throw IncompatibleTypeError(coltype2str(TYPE_FLOAT), "'" + std::string(begin, end) + "'");
+        }
+        memcpy(dst, &value, sizeof(float));
+    }
+}
+
+/**
+ * @description: 把解析好的数据块按页面批量写入表中并记下Rid，表上有索引时把每条记录的键和Rid交给对应的排序器
+ */
+void DataLoader::insert_chunk(Chunk &chunk) {
+    std::vector<char *> bufs(chunk.num_rows);
+    for (int i = 0; i < chunk.num_rows; i++) {
+        bufs[i] = chunk.records.data() + static_cast<size_t>(i) * record_size_;
+    }
+    std::vector<Rid> rids(chunk.num_rows);
+    fh_->insert_records(bufs.data(), chunk.num_rows, rids.data(), context_);
+    loaded_rids_.insert(loaded_rids_.end(), rids.begin(), rids.end());
+    if (tab_.indexes.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < tab_.indexes.size(); i++) {
+        auto &index = tab_.indexes[i];
+        std::vector<char> key(index.col_tot_len);
+        for (int row = 0; row < chunk.num_rows; row++) {
+            int offset = 0;
+            for (auto &col : index.cols) {
+                memcpy(key.data() + offset, bufs[row] + col.offset, col.len);
+                offset += col.len;
+            }
+            sorters_[i]->add(key.data(), rids[row]);
+        }
+    }
+}
+
+/**
+ * @description: 数据全部写入之后为每个索引建立B+树：索引为空时批量建立，否则按键的顺序依次插入，相邻的插入落在同一个叶结点上
+ */
+void DataLoader::build_indexes() {
+    for (size_t i = 0; i < tab_.indexes.size(); i++) {
+        auto &index = tab_.indexes[i];
+        auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_.name, index.cols)).get();
+        auto &sorter = sorters_[i];
+        sorter->finish();
+        num_indexes_touched_ = i + 1;
+        if (ih->is_empty()) {
+            ih->bulk_load(sorter.get());
+        } else {
+            std::vector<char> key(index.col_tot_len);
+            Rid rid;
+            while (sorter->next(key.data(), &rid)) {
+                if (ih->insert_entry(key.data(), rid, context_->txn_) == IX_NO_PAGE) {
+                    throw IndexDuplicateKeyError();
+                }
+            }
+        }
+        // 尽早释放排序器的内存和临时文件
+        sorter.reset();
+    }
+}
+
+/**
+ * @description: 导入失败时撤销已写入的数据：先从已经修改过的索引中删除指向导入记录的键，再删除这些记录。
+ * 导入的键与表中原有记录的键重复时，索引项仍指向原有记录，不会被删除
+ */
+void DataLoader::rollback() {
+    for (size_t i = 0; i < num_indexes_touched_; i++) {
+        auto &index = tab_.indexes[i];
+        auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_.name, index.cols)).get();
+        std::vector<char> key(index.col_tot_len);
+        std::vector<Rid> result;
+        for (auto &rid : loaded_rids_) {
+            {
+                RecordView record = fh_->get_record_view(rid, context_);
+                int offset = 0;
+                for (auto &col : index.cols) {
+                    memcpy(key.data() + offset, record.data() + col.offset, col.len);
+                    offset += col.len;
+                }
+            }
+            result.clear();
+            if (ih->get_value(key.data(), &result, context_->txn_) && result.front() == rid) {
+                ih->delete_entry(key.data(), context_->txn_);
+            }
+        }
+    }
+    for (auto &rid : loaded_rids_) {
+        fh_->delete_record(rid, context_);
+    }
+    loaded_rids_.clear();
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/context.h"
+#include "index/ix.h"
+#include "index/ix_external_sort.h"
+#include "system/sm.h"
+
+enum LoadFormat { LOAD_FORMAT_CSV, LOAD_FORMAT_BINARY };
+
+/* LOAD DATA的执行结果 */
+struct LoadStats {
+    size_t rows = 0;       // 导入的记录条数
+    size_t bytes = 0;      // 读取的文件字节数
+    double seconds = 0;    // 总耗时，包括建索引
+
+    double rows_per_sec() const { return seconds > 0 ? rows / seconds : 0; }
+};
+
+/*
+DataLoader执行LOAD DATA语句，把本地文件中的数据按流水线导入表中：
+主线程按CHUNK_SIZE读取文件，在最后一个换行符处切分，交给工作线程解析和转换为记录格式；
+解析完成的数据块按文件中的顺序由主线程经RmFileHandle::insert_records按页面批量写入，
+写入的同时把每条记录的索引键和Rid交给各索引的IxExternalSorter外部排序，所有数据写完之后，
+索引为空时由排好序的键自底向上批量建立B+树，否则按键的顺序逐条插入；键重复时导入失败。导入过程中每秒在服务端输出一次进度。
+CSV格式每行一条记录，字段以逗号分隔，可以用双引号括起（其中的两个双引号表示一个双引号），字段中不能含换行符；
+BINARY格式由连续的定长记录组成，每条记录与表的记录格式相同。
+导入失败时删除已写入的记录和索引中指向它们的键，表和索引回到导入之前的状态
+*/
+class DataLoader {
+   public:
+    static constexpr size_t CHUNK_SIZE = 4 << 20;  // 每个数据块读取的字节数
+    static constexpr int MAX_WORKERS = 8;
+
+    DataLoader(SmManager *sm_manager, const std::string &tab_name, Context *context);
+
+    /**
+     * @description: 导入文件中的全部数据
+     * @return {LoadStats} 导入的记录数和耗时
+     * @param {string&} file_name 文件路径，相对路径相对于数据库目录
+     * @param {LoadFormat} format 文件格式
+     */
+    LoadStats load(const std::string &file_name, LoadFormat format);
+
+   private:
+    struct Chunk {
+        size_t seq;                 // 数据块在文件中的序号
+        off_t file_offset;          // 数据块在文件中的起始位置，用于报告出错的位置
+        std::vector<char> data;     // 文件内容，CSV格式中以完整的行结束
+        std::vector<char> records;  // 解析得到的记录，每条record_size字节
+        int num_rows = 0;
+        std::exception_ptr error;
+    };
+
+    void parse(Chunk &chunk) const;
+
+    void parse_csv(Chunk &chunk) const;
+
+    // 把[begin, end)中的字段值转换为col的记录格式，写入dst
+    void convert_field(const char *begin, const char *end, const ColMeta &col, char *dst) const;
+
+    void insert_chunk(Chunk &chunk);
+
+    void build_indexes();
+
+    void rollback();
+
+    SmManager *sm_manager_;
+    TabMeta tab_;
+    RmFileHandle *fh_;
+    Context *context_;
+    int record_size_;
+    LoadFormat format_ = LOAD_FORMAT_CSV;
+    std::vector<std::unique_ptr<IxExternalSorter>> sorters_;  // 每个索引一个，收集导入记录的键和Rid
+    std::vector<Rid> loaded_rids_;                           // 已写入表中的记录，导入失败时据此删除
+    size_t num_indexes_touched_ = 0;                         // build_indexes已经开始修改的索引个数
+};
@@ -10,6 +10,11 @@ See the Mulan PSL v2 for more details. */
 
 #include "execution_manager.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "data_loader.h"
 #include "executor_delete.h"
 #include "executor_index_scan.h"
 #include "executor_insert.h"
@@ -23,16 +28,19 @@ See the Mulan PSL v2 for more details. */
 const char *help_info = "Supported SQL syntax:\n"
                    "  command ;\n"
                    "command:\n"
-                   "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
+                   "  CREATE TABLE table_name (column_name type [, column_name type ...]) [LAYOUT = {ROW | PAX}] [COMPRESSION = {NONE | LZ}]\n"
                    "  DROP TABLE table_name\n"
                    "  CREATE INDEX table_name (column_name)\n"
                    "  DROP INDEX table_name (column_name)\n"
-                   "  INSERT INTO table_name VALUES (value [, value ...])\n"
+                   "  INSERT INTO table_name VALUES (value [, value ...]) [, (value [, value ...]) ...]\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  LOAD DATA 'file_name' INTO table_name [FORMAT = {CSV | BINARY}]\n"
+                   "  SET variable = value\n"
+                   "  SHOW {TABLES | BUFFERPOOL}\n"
                    "type:\n"
-                   "  {INT | FLOAT | CHAR(n)}\n"
+                   "  {INT | FLOAT | CHAR(n) | VARCHAR(n)}\n"
                    "where_clause:\n"
                    "  condition [AND condition ...]\n"
                    "condition:\n"
@@ -50,7 +58,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, context, x->table_options_);
                 break;
             }
             case T_DropTable:
@@ -75,7 +83,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     }
 }
 
-// 执行help; show tables; desc table; begin; commit; abort;语句
+// 执行help; show tables; show bufferpool; desc table; begin; commit; abort; set; load data;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -90,6 +98,11 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_tables(context);
                 break;
             }
+            case T_ShowBufferPool:
+            {
+                show_buffer_pool(context);
+                break;
+            }
             case T_DescTable:
             {
                 sm_manager_->desc_table(x->tab_name_, context);
@@ -119,6 +132,16 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 txn_mgr_->abort(context->txn_, context->log_mgr_);
                 break;
             }     
+            case T_SetVariable:
+            {
+                set_variable(x->tab_name_, x->value_);
+                break;
+            }
+            case T_LoadData:
+            {
+                load_data(static_cast<const LoadDataPlan &>(*x), context);
+                break;
+            }
             default:
                 throw InternalError("Unexpected field type");
                 break;                        
@@ -127,6 +150,123 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
     }
 }
 
+/**
+ * @description: 执行set语句，修改系统变量，变量名不区分大小写
+ * 目前支持buffer_pool_size：在线调整缓冲池的帧数，其他会话照常执行
+ * @param {string&} name 变量名
+ * @param {Value&} value 新的值
+ */
+void QlManager::set_variable(const std::string &name, const Value &value) {
+    std::string var = name;
+    std::transform(var.begin(), var.end(), var.begin(), ::tolower);
+    if (var == "buffer_pool_size") {
+        if (value.type != TYPE_INT) {
+            throw IncompatibleTypeError(coltype2str(TYPE_INT), coltype2str(value.type));
+        }
+        if (value.int_val <= 0) {
+            throw InternalError("buffer_pool_size must be positive");
+        }
+        sm_manager_->get_bpm()->resize(static_cast<size_t>(value.int_val));
+    } else {
+        throw UnknownVariableError(name);
+    }
+}
+
+/**
+ * @description: 执行load data语句，把文件中的数据导入表中，输出导入的记录数和速度
+ * @param {LoadDataPlan&} plan
+ * @param {Context*} context
+ */
+void QlManager::load_data(const LoadDataPlan &plan, Context *context) {
+    DataLoader loader(sm_manager_, plan.tab_name_, context);
+    LoadStats stats = loader.load(plan.file_name_, plan.binary_ ? LOAD_FORMAT_BINARY : LOAD_FORMAT_CSV);
+    std::stringstream seconds;
+    seconds << std::fixed << std::setprecision(3) << stats.seconds;
+
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Metric", "Value"}, context);
+    printer.print_separator(context);
+    printer.print_record({"rows", std::to_string(stats.rows)}, context);
+    printer.print_record({"bytes", std::to_string(stats.bytes)}, context);
+    printer.print_record({"seconds", seconds.str()}, context);
+    printer.print_record({"rows_per_sec", std::to_string(static_cast<size_t>(stats.rows_per_sec()))}, context);
+    printer.print_separator(context);
+}
+
+/**
+ * @description: 输出缓冲池的统计信息：第一张表为整个缓冲池的计数和I/O延迟，第二张表为各个文件的访问统计
+ * @param {Context*} context
+ */
+void QlManager::show_buffer_pool(Context *context) {
+    BufferPoolManager *bpm = sm_manager_->get_bpm();
+    BufferPoolStats stats = bpm->get_stats();
+    auto fixed = [](double value, int precision) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(precision) << value;
+        return ss.str();
+    };
+    std::vector<std::pair<std::string, std::string>> rows = {
+        {"pool_size", std::to_string(stats.pool_size)},
+        {"partitions", std::to_string(stats.num_partitions)},
+        {"dirty_pages", std::to_string(stats.dirty_pages)},
+        {"hits", std::to_string(stats.hits)},
+        {"misses", std::to_string(stats.misses)},
+        {"hit_ratio", fixed(stats.hit_ratio(), 4)},
+        {"evictions", std::to_string(stats.evictions)},
+        {"writebacks", std::to_string(stats.writebacks)},
+        {"pin_waits", std::to_string(stats.pin_waits)},
+        {"pin_wait_us", std::to_string(stats.pin_wait_ns / 1000)},
+        {"latch_acquires", std::to_string(stats.latch_acquisitions)},
+        {"latch_contended", std::to_string(stats.latch_contended)},
+        {"latch_hold_ns", fixed(stats.avg_latch_hold_ns(), 1)},
+    };
+    for (auto &io : {std::make_pair(std::string("read"), &stats.read_latency),
+                     std::make_pair(std::string("write"), &stats.write_latency)}) {
+        const LatencySnapshot &latency = *io.second;
+        rows.emplace_back(io.first + "_ios", std::to_string(latency.count));
+        rows.emplace_back(io.first + "_avg_us", fixed(latency.avg_us(), 1));
+        rows.emplace_back(io.first + "_p99_us",
+                          latency.count == 0 ? "0" : "<" + std::to_string(latency.percentile_us(0.99)));
+        for (int i = 0; i < LatencySnapshot::NUM_BUCKETS; i++) {
+            if (latency.buckets[i] != 0) {
+                rows.emplace_back(io.first + "<" + std::to_string(LatencySnapshot::bucket_upper_us(i)) + "us",
+                                  std::to_string(latency.buckets[i]));
+            }
+        }
+    }
+
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Metric", "Value"}, context);
+    printer.print_separator(context);
+    for (auto &row : rows) {
+        printer.print_record({row.first, row.second}, context);
+    }
+    printer.print_separator(context);
+
+    if (stats.files.empty()) {
+        return;
+    }
+    RecordPrinter file_printer(5);
+    file_printer.print_separator(context);
+    file_printer.print_record({"File", "Hits", "Misses", "Evictions", "Writebacks"}, context);
+    file_printer.print_separator(context);
+    for (auto &entry : stats.files) {
+        std::string file_name;
+        try {
+            file_name = sm_manager_->get_disk_manager()->get_file_name(entry.first);
+        } catch (RMDBError &e) {
+            file_name = std::to_string(entry.first);
+        }
+        const FileStats &file = entry.second;
+        file_printer.print_record({file_name, std::to_string(file.hits), std::to_string(file.misses),
+                                   std::to_string(file.evictions), std::to_string(file.writebacks)},
+                                  context);
+    }
+    file_printer.print_separator(context);
+}
+
 // 执行select语句，select语句的输出除了需要返回客户端外，还需要写入output.txt文件中
 void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot, std::vector<TabCol> sel_cols, 
                             Context *context) {
@@ -154,11 +294,11 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
     size_t num_rec = 0;
     // 执行query_plan
     for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple()) {
-        auto Tuple = executorTreeRoot->Next();
+        RecordView Tuple = executorTreeRoot->view();
         std::vector<std::string> columns;
         for (auto &col : executorTreeRoot->cols()) {
             std::string col_str;
-            char *rec_buf = Tuple->data + col.offset;
+            const char *rec_buf = Tuple.data() + col.offset;
             if (col.type == TYPE_INT) {
                 col_str = std::to_string(*(int *)rec_buf);
             } else if (col.type == TYPE_FLOAT) {
@@ -41,4 +41,11 @@ class QlManager {
                         Context *context);
 
     void run_dml(std::unique_ptr<AbstractExecutor> exec);
+
+   private:
+    void set_variable(const std::string &name, const Value &value);
+
+    void show_buffer_pool(Context *context);
+
+    void load_data(const LoadDataPlan &plan, Context *context);
 };
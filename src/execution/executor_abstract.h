@@ -42,6 +42,13 @@ class AbstractExecutor {
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
+    /**
+     * @description: 返回当前元组的只读视图，在beginTuple/nextTuple移动到其他元组之前有效。
+     * 默认实现物化Next()的结果；元组就在页面中的算子应重写该函数，直接返回指向页面的视图
+     * @return {RecordView} 当前元组的视图，没有元组时返回空视图
+     */
+    virtual RecordView view() { return RecordView(Next()); }
+
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
@@ -37,10 +37,17 @@ class DeleteExecutor : public AbstractExecutor {
     }
 
     std::unique_ptr<RmRecord> Next() override {
+        // 索引键的缓冲区在arena中分配一次，每条记录复用
+        int max_key_len = 0;
+        for (auto& index : tab_.indexes) {
+            max_key_len = std::max(max_key_len, index.col_tot_len);
+        }
+        char* key = context_->arena_.allocate(max_key_len);
+
         // 遍历所有需要删除的记录
         for (auto& rid : rids_) {
-            // 先读取记录内容，用于构造索引键
-            auto record = fh_->get_record(rid, context_);
+            // 先读取记录内容，用于构造索引键，记录只在页面中读取，不复制
+            RecordView record = fh_->get_record_view(rid, context_);
             
             // 删除索引条目
             for (size_t i = 0; i < tab_.indexes.size(); ++i) {
@@ -48,16 +55,14 @@ class DeleteExecutor : public AbstractExecutor {
                 auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
                 
                 // 构造索引键
-                char* key = new char[index.col_tot_len];
                 int offset = 0;
                 for (size_t j = 0; j < index.col_num; ++j) {
-                    memcpy(key + offset, record->data + index.cols[j].offset, index.cols[j].len);
+                    memcpy(key + offset, record.data() + index.cols[j].offset, index.cols[j].len);
                     offset += index.cols[j].len;
                 }
                 
                 // 从索引中删除条目
                 ih->delete_entry(key, context_->txn_);
-                delete[] key;
             }
             
             // 从记录文件中删除记录
@@ -9,6 +9,8 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include <algorithm>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -18,7 +20,7 @@ See the Mulan PSL v2 for more details. */
 class InsertExecutor : public AbstractExecutor {
    private:
     TabMeta tab_;                   // 表的元数据
-    std::vector<Value> values_;     // 需要插入的数据
+    std::vector<Value> values_;     // 需要插入的数据，多行时按行依次存放
     RmFileHandle *fh_;              // 表的数据文件句柄
     std::string tab_name_;          // 表名称
     Rid rid_;                       // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值
@@ -30,7 +32,7 @@ class InsertExecutor : public AbstractExecutor {
         tab_ = sm_manager_->db_.get_table(tab_name);
         values_ = values;
         tab_name_ = tab_name;
-        if (values.size() != tab_.cols.size()) {
+        if (values.empty() || values.size() % tab_.cols.size() != 0) {
             throw InvalidValueCountError();
         }
         fh_ = sm_manager_->fhs_.at(tab_name).get();
@@ -38,31 +40,61 @@ class InsertExecutor : public AbstractExecutor {
     };
 
     std::unique_ptr<RmRecord> Next() override {
-        // Make record buffer
-        RmRecord rec(fh_->get_file_hdr().record_size);
-        for (size_t i = 0; i < values_.size(); i++) {
-            auto &col = tab_.cols[i];
-            auto &val = values_[i];
-            if (col.type != val.type) {
-                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+        // Make record buffer，记录和索引键都在本条语句的arena中分配；先检查所有行的类型，任何一行不合法时整条语句不插入
+        size_t num_cols = tab_.cols.size();
+        int num_rows = static_cast<int>(values_.size() / num_cols);
+        int record_size = fh_->get_file_hdr().record_size;
+        char *data = context_->arena_.allocate(static_cast<size_t>(num_rows) * record_size);
+        std::vector<char *> bufs(num_rows);
+        for (int row = 0; row < num_rows; row++) {
+            bufs[row] = data + static_cast<size_t>(row) * record_size;
+            memset(bufs[row], 0, record_size);
+            for (size_t i = 0; i < num_cols; i++) {
+                auto &col = tab_.cols[i];
+                auto &val = values_[row * num_cols + i];
+                if (col.type != val.type) {
+                    throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+                }
+                val.write_raw(bufs[row] + col.offset, col.len);
             }
-            val.init_raw(col.len);
-            memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
-        // Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_);
-        
-        // Insert into index
+        // Insert into record file，单行走原来的路径，多行按页面批量填充
+        std::vector<Rid> rids(num_rows);
+        if (num_rows == 1) {
+            rids[0] = fh_->insert_record(bufs[0], context_);
+        } else {
+            fh_->insert_records(bufs.data(), num_rows, rids.data(), context_);
+        }
+        rid_ = rids.back();
+
+        // Insert into index，多行时按键排序后插入，相邻的插入落在同一个叶结点上
+        std::vector<int> order(num_rows);
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            char* keys = context_->arena_.allocate(static_cast<size_t>(num_rows) * index.col_tot_len);
+            std::vector<ColType> col_types;
+            std::vector<int> col_lens;
+            for (auto &col : index.cols) {
+                col_types.push_back(col.type);
+                col_lens.push_back(col.len);
+            }
+            for (int row = 0; row < num_rows; row++) {
+                char *key = keys + static_cast<size_t>(row) * index.col_tot_len;
+                int offset = 0;
+                for(size_t j = 0; j < index.col_num; ++j) {
+                    memcpy(key + offset, bufs[row] + index.cols[j].offset, index.cols[j].len);
+                    offset += index.cols[j].len;
+                }
+                order[row] = row;
+            }
+            auto key_of = [&](int row) { return keys + static_cast<size_t>(row) * index.col_tot_len; };
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return ix_compare(key_of(a), key_of(b), col_types, col_lens) < 0;
+            });
+            for (int row : order) {
+                ih->insert_entry(key_of(row), rids[row], context_->txn_);
             }
-            ih->insert_entry(key, rid_, context_->txn_);
         }
         return nullptr;
     }
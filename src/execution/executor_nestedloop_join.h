@@ -24,11 +24,15 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                 // join后获得的记录的字段
 
     std::vector<Condition> fed_conds_;          // join条件
+    std::vector<const char *> rhs_vals_;        // 右部常量编码后的数据，右部为列时为nullptr
     bool isend;
+    RecordView left_view_;                      // 左子节点当前元组的视图，左子节点移动时失效
+    char *out_buf_;                             // view()返回的连接结果，在arena中分配，每条结果复用
 
    public:
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, 
-                            std::vector<Condition> conds) {
+                            std::vector<Condition> conds, Context *context) {
+        context_ = context;
         left_ = std::move(left);
         right_ = std::move(right);
         len_ = left_->tupleLen() + right_->tupleLen();
@@ -41,47 +45,34 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
-
+        for (auto &cond : fed_conds_) {
+            rhs_vals_.push_back(cond.is_rhs_val ? cond.rhs_val.raw_data(get_col(cols_, cond.lhs_col)->len,
+                                                                        &context_->arena_)
+                                                : nullptr);
+        }
+        out_buf_ = context_->arena_.allocate(len_);
     }
 
     void beginTuple() override {
         // 1. 使用执行器 left_ 定位到左子节点算子的第一条结果元组
         left_->beginTuple();
+        left_view_ = RecordView();
         
         // 2. 使用执行器 right_ 定位到右子节点算子的第一条结果元组
         right_->beginTuple();
         
-        // 初始化结束标志
-        isend = left_->is_end() || right_->is_end();
-        
-        // 如果没有结束，查找第一个满足条件的记录对
-        if (!isend) {
-            findNextValidPair();
-        }
+        // 查找第一个满足条件的记录对
+        isend = false;
+        findNextValidPair();
     }
 
     void nextTuple() override {
-        // 1. 如果执行器 right_ 未处于右子节点算子结果的末尾，则使用执行器 right_ 定位到右子节点算子的下一条结果元组
-        if (!right_->is_end()) {
-            right_->nextTuple();
-            if (!right_->is_end()) {
-                // 查找下一个满足条件的记录对
-                findNextValidPair();
-                return;
-            }
-        }
-        
-        // 2. 如果执行器 right_ 处于右子节点算子结果的末尾，则使用执行器 left_ 定位到左子节点算子的下一条结果元组，
-        //    使用执行器 right_ 定位到右子节点算子的第一条结果元组
-        left_->nextTuple();
-        if (!left_->is_end()) {
-            right_->beginTuple(); // 重新开始右侧扫描
-            // 查找下一个满足条件的记录对
-            findNextValidPair();
-        } else {
-            // 更新结束标志
-            isend = true;
+        // 执行器 right_ 定位到右子节点算子的下一条结果元组，到达末尾时由 findNextValidPair 移动 left_ 并重新开始 right_
+        if (isend) {
+            return;
         }
+        right_->nextTuple();
+        findNextValidPair();
     }
 
     std::unique_ptr<RmRecord> Next() override {
@@ -90,28 +81,32 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
             return nullptr;
         }
         
-        // 获取当前左右记录
-        auto left_record = left_->Next();
-        auto right_record = right_->Next();
-        
-        // 检查是否有记录（这里应该总是有，因为 findNextValidPair 已经确保了）
-        if (left_record == nullptr || right_record == nullptr) {
-            isend = true;
+        // 获取当前左右记录的视图，只在这里把连接结果复制成一条记录
+        RecordView right_view = right_->view();
+        if (!left_view_ || !right_view) {
             return nullptr;
         }
         
-        // 创建结果元组
-        RmRecord result_record(len_);
-        
-        // 连接左右记录的数据
-        // 先复制左侧记录的数据
-        memcpy(result_record.data, left_record->data, left_->tupleLen());
-        
-        // 再复制右侧记录的数据（偏移量为左侧记录的长度）
-        memcpy(result_record.data + left_->tupleLen(), right_record->data, right_->tupleLen());
-        
-        // 返回结果元组指针
-        return std::make_unique<RmRecord>(std::move(result_record));
+        auto result_record = std::make_unique<RmRecord>(len_);
+        memcpy(result_record->data, left_view_.data(), left_->tupleLen());
+        memcpy(result_record->data + left_->tupleLen(), right_view.data(), right_->tupleLen());
+        return result_record;
+    }
+
+    /**
+     * @brief 把当前的连接结果写入输出缓冲区并返回其视图，不为每条结果分配内存
+     */
+    RecordView view() override {
+        if (isend) {
+            return RecordView();
+        }
+        RecordView right_view = right_->view();
+        if (!left_view_ || !right_view) {
+            return RecordView();
+        }
+        memcpy(out_buf_, left_view_.data(), left_->tupleLen());
+        memcpy(out_buf_ + left_->tupleLen(), right_view.data(), right_->tupleLen());
+        return RecordView(out_buf_, len_, PageGuard());
     }
 
     Rid &rid() override { return _abstract_rid; }
@@ -125,39 +120,26 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     const std::vector<ColMeta> &cols() const override { return cols_; }
 
     private:
-    // 查找下一个满足连接条件的记录对
+    // 从当前的记录对开始查找下一个满足连接条件的记录对，左元组的视图在右子节点的一轮扫描中复用
     void findNextValidPair() {
-        while (!left_->is_end() && !right_->is_end()) {
-            auto left_record = left_->Next();
-            auto right_record = right_->Next();
-            
-            if (left_record == nullptr || right_record == nullptr) {
-                isend = true;
-                return;
-            }
-            
-            // 检查连接条件
-            if (eval_conds(left_record.get(), right_record.get(), fed_conds_, cols_)) {
-                // 找到满足条件的记录对，停止查找
-                return;
-            }
-            
-            // 当前记录对不满足条件，移动到下一个记录对
+        while (!left_->is_end()) {
             if (!right_->is_end()) {
-                right_->nextTuple();
-                if (right_->is_end()) {
-                    // 右侧结束，移动左侧
-                    left_->nextTuple();
-                    if (!left_->is_end()) {
-                        right_->beginTuple();
-                    }
+                if (!left_view_) {
+                    left_view_ = left_->view();
                 }
-            } else {
-                // 右侧已经结束，移动左侧
-                left_->nextTuple();
-                if (!left_->is_end()) {
-                    right_->beginTuple();
+                RecordView right_view = right_->view();
+                if (eval_conds(left_view_.data(), right_view.data(), fed_conds_, cols_)) {
+                    // 找到满足条件的记录对，停止查找
+                    return;
                 }
+                right_->nextTuple();
+                continue;
+            }
+            // 右侧已经结束，移动左侧并重新开始右侧扫描
+            left_view_ = RecordView();
+            left_->nextTuple();
+            if (!left_->is_end()) {
+                right_->beginTuple();
             }
         }
         
@@ -165,52 +147,43 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         isend = true;
     }
 
-    bool eval_cond(const RmRecord *lhs_rec, const RmRecord *rhs_rec, const Condition &cond, const std::vector<ColMeta> &rec_cols) {
+    bool eval_cond(const char *lhs_rec, const char *rhs_rec, const Condition &cond, const char *rhs_val,
+                   const std::vector<ColMeta> &rec_cols) {
         // 1. 获取连接条件左部表达式的类型和值
         auto lhs_col_it = get_col(rec_cols, cond.lhs_col);
-        char *lhs_data = nullptr;
+        const char *lhs_data = nullptr;
         ColType lhs_type = lhs_col_it->type;
         int lhs_len = lhs_col_it->len;
         
         // 判断左部列来自哪个记录（左记录还是右记录）
         if (lhs_col_it->offset < left_->tupleLen()) {
             // 来自左记录
-            lhs_data = lhs_rec->data + lhs_col_it->offset;
+            lhs_data = lhs_rec + lhs_col_it->offset;
         } else {
             // 来自右记录，需要调整偏移量
-            lhs_data = rhs_rec->data + (lhs_col_it->offset - left_->tupleLen());
+            lhs_data = rhs_rec + (lhs_col_it->offset - left_->tupleLen());
         }
         
         // 2. 获取连接条件右部表达式的类型和值
-        char *rhs_data = nullptr;
+        const char *rhs_data = nullptr;
         ColType rhs_type;
-        int rhs_len;
-        
-        Value temp_rhs_val;  // 用于存储临时的右部值
         
         if (cond.is_rhs_val) {
-            // 右部是常量值
-            temp_rhs_val = cond.rhs_val;
-            // 只有在 raw 为空时才调用 init_raw
-            if (temp_rhs_val.raw == nullptr) {
-                temp_rhs_val.init_raw(lhs_len);  // 初始化为与左部相同的长度
-            }
-            rhs_data = temp_rhs_val.raw->data;
-            rhs_type = temp_rhs_val.type;
-            rhs_len = lhs_len;
+            // 右部是常量值，已在构造时按左部的长度编码
+            rhs_data = rhs_val;
+            rhs_type = cond.rhs_val.type;
         } else {
             // 右部是另一列
             auto rhs_col_it = get_col(rec_cols, cond.rhs_col);
             rhs_type = rhs_col_it->type;
-            rhs_len = rhs_col_it->len;
             
             // 判断右部列来自哪个记录（左记录还是右记录）
             if (rhs_col_it->offset < left_->tupleLen()) {
                 // 来自左记录
-                rhs_data = lhs_rec->data + rhs_col_it->offset;
+                rhs_data = lhs_rec + rhs_col_it->offset;
             } else {
                 // 来自右记录，需要调整偏移量
-                rhs_data = rhs_rec->data + (rhs_col_it->offset - left_->tupleLen());
+                rhs_data = rhs_rec + (rhs_col_it->offset - left_->tupleLen());
             }
         }
         
@@ -235,9 +208,12 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         }
     }
 
-    bool eval_conds(const RmRecord *lhs_rec, const RmRecord *rhs_rec, const std::vector<Condition> &conds, const std::vector<ColMeta> &rec_cols) {
-        return std::all_of(conds.begin(), conds.end(),
-            [&](const Condition &cond) { return eval_cond(lhs_rec, rhs_rec, cond, rec_cols); }
-        );
+    bool eval_conds(const char *lhs_rec, const char *rhs_rec, const std::vector<Condition> &conds, const std::vector<ColMeta> &rec_cols) {
+        for (size_t i = 0; i < conds.size(); i++) {
+            if (!eval_cond(lhs_rec, rhs_rec, conds[i], rhs_vals_[i], rec_cols)) {
+                return false;
+            }
+        }
+        return true;
     }
 };
\ No newline at end of file
@@ -21,10 +21,12 @@ class ProjectionExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                     // 需要投影的字段
     size_t len_;                                    // 字段总长度
     std::vector<size_t> sel_idxs_;                  
+    char *out_buf_;                                 // view()返回的投影结果，在arena中分配，每条结果复用
 
    public:
-    ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols) {
+    ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols, Context *context) {
         prev_ = std::move(prev);
+        context_ = context;
 
         size_t curr_offset = 0;
         auto &prev_cols = prev_->cols();
@@ -37,6 +39,7 @@ class ProjectionExecutor : public AbstractExecutor {
             cols_.push_back(col);
         }
         len_ = curr_offset;
+        out_buf_ = context_->arena_.allocate(len_);
     }
 
     void beginTuple() override {
@@ -51,31 +54,25 @@ class ProjectionExecutor : public AbstractExecutor {
 
     std::unique_ptr<RmRecord> Next() override {
         // 1. 创建结果元组（RmRecord 类）
-        RmRecord result_record(len_);
+        auto result_record = std::make_unique<RmRecord>(len_);
         
         // 2. 将子节点算子的当前元组进行投影，填充结果元组
-        auto child_record = prev_->Next();
-        if (child_record == nullptr) {
+        if (!project(result_record->data)) {
             return nullptr;
         }
         
-        // 获取子节点的列信息
-        auto &prev_cols = prev_->cols();
-        
-        // 根据 sel_idxs_ 复制需要投影的字段
-        for (size_t i = 0; i < sel_idxs_.size(); i++) {
-            size_t child_col_idx = sel_idxs_[i];
-            const auto &child_col = prev_cols[child_col_idx];
-            const auto &result_col = cols_[i];
-            
-            // 从子记录中复制数据到结果记录
-            memcpy(result_record.data + result_col.offset,
-                   child_record->data + child_col.offset,
-                   child_col.len);
-        }
-        
         // 3. 返回结果元组指针
-        return std::make_unique<RmRecord>(std::move(result_record));
+        return result_record;
+    }
+
+    /**
+     * @brief 把投影结果写入输出缓冲区并返回其视图，不为每条结果分配内存
+     */
+    RecordView view() override {
+        if (!project(out_buf_)) {
+            return RecordView();
+        }
+        return RecordView(out_buf_, len_, PageGuard());
     }
 
     Rid &rid() override { return _abstract_rid; }
@@ -90,4 +87,19 @@ class ProjectionExecutor : public AbstractExecutor {
     size_t tupleLen() const override { return len_; }
 
     const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    // 把子节点当前元组中被选择的字段写入dst；只读取子节点元组的视图，不复制整条元组
+    bool project(char *dst) {
+        RecordView child_record = prev_->view();
+        if (!child_record) {
+            return false;
+        }
+        auto &prev_cols = prev_->cols();
+        for (size_t i = 0; i < sel_idxs_.size(); i++) {
+            const auto &child_col = prev_cols[sel_idxs_[i]];
+            memcpy(dst + cols_[i].offset, child_record.data() + child_col.offset, child_col.len);
+        }
+        return true;
+    }
 };
\ No newline at end of file
@@ -24,10 +24,19 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;         // scan后生成的记录的字段
     size_t len_;                        // scan后生成的每条记录的长度
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
+    std::vector<const char *> rhs_vals_;    // fed_conds_中右部常量按左部字段格式编码后的数据，右部为列时为nullptr
 
     Rid rid_;
     std::unique_ptr<RecScan> scan_;     // table_iterator
 
+    // PAX格式的表按页扫描：谓词只读取涉及的列的列向量，满足条件的记录再拼成整条记录
+    RmScan *pax_scan_ = nullptr;        // 与scan_相同，用于按页移动
+    RmColumnPage column_page_;          // 当前页面，持有页面的pin
+    std::vector<const ColMeta *> pred_cols_;    // 谓词涉及的列
+    std::vector<int> pred_col_nos_;     // pred_cols_在PAX页面中的列号
+    char *probe_buf_ = nullptr;         // 只填入谓词涉及的列的记录，供eval_conds使用
+    char *out_buf_ = nullptr;           // 拼出的当前记录
+
     SmManager *sm_manager_;
 
    public:
@@ -43,6 +52,22 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+        // 右部常量只编码一次，不在每条记录上重新构造
+        for (auto &cond : fed_conds_) {
+            const char *rhs_val = nullptr;
+            if (cond.is_rhs_val) {
+                auto lhs_col = std::find_if(cols_.begin(), cols_.end(),
+                                            [&](const ColMeta &col) { return col.name == cond.lhs_col.col_name; });
+                if (lhs_col == cols_.end()) {
+                    throw ColumnNotFoundError(cond.lhs_col.tab_name + "." + cond.lhs_col.col_name);
+                }
+                rhs_val = cond.rhs_val.raw_data(lhs_col->len, &context_->arena_);
+            }
+            rhs_vals_.push_back(rhs_val);
+        }
+        if (fh_->is_pax()) {
+            init_pax();
+        }
     }
 
     /**
@@ -52,16 +77,19 @@ class SeqScanExecutor : public AbstractExecutor {
     void beginTuple() override {
         // 1. 创建该表的记录迭代器 scan_
         scan_ = std::make_unique<RmScan>(fh_);
+        if (fh_->is_pax()) {
+            pax_scan_ = static_cast<RmScan *>(scan_.get());
+            column_page_ = RmColumnPage();
+            seek_pax(pax_scan_->rid().slot_no);
+            return;
+        }
         
         // 2. 使用记录迭代器 scan_ 扫描表中元组，直至遇到第一条满足选择条件的元组，将该元组的Rid记录在 rid_ 中
         while (!scan_->is_end()) {
             rid_ = scan_->rid();
             
-            // 获取当前记录
-            auto record = fh_->get_record(rid_, context_);
-            
-            // 检查是否满足条件
-            if (eval_conds(record.get(), fed_conds_, cols_)) {
+            // 直接在页面中的记录上检查是否满足条件，不复制记录
+            if (eval_conds(fh_->get_record_view(rid_, context_).data(), fed_conds_, cols_)) {
                 // 找到满足条件的元组，停止扫描
                 return;
             }
@@ -83,6 +111,11 @@ class SeqScanExecutor : public AbstractExecutor {
             return;
         }
         
+        if (fh_->is_pax()) {
+            seek_pax(column_page_.next_used(rid_.slot_no));
+            return;
+        }
+
         // 移动到下一条记录
         scan_->next();
         
@@ -90,11 +123,8 @@ class SeqScanExecutor : public AbstractExecutor {
         while (!scan_->is_end()) {
             rid_ = scan_->rid();
             
-            // 获取当前记录
-            auto record = fh_->get_record(rid_, context_);
-            
-            // 检查是否满足条件
-            if (eval_conds(record.get(), fed_conds_, cols_)) {
+            // 直接在页面中的记录上检查是否满足条件，不复制记录
+            if (eval_conds(fh_->get_record_view(rid_, context_).data(), fed_conds_, cols_)) {
                 // 找到满足条件的元组，停止扫描
                 return;
             }
@@ -117,10 +147,28 @@ class SeqScanExecutor : public AbstractExecutor {
             return nullptr;  // 如果已经到达扫描末尾，返回空指针
         }
         
+        if (fh_->is_pax()) {
+            column_page_.read_record(rid_.slot_no, out_buf_);
+            return std::make_unique<RmRecord>(len_, out_buf_);
+        }
         // 使用 rid_ 从文件中获取记录
         return fh_->get_record(rid_, context_);
     }
 
+    /**
+     * @brief 返回指向页面中当前记录的视图，不复制记录
+     */
+    RecordView view() override {
+        if (is_end()) {
+            return RecordView();
+        }
+        if (fh_->is_pax()) {
+            column_page_.read_record(rid_.slot_no, out_buf_);
+            return RecordView(out_buf_, len_, PageGuard());
+        }
+        return fh_->get_record_view(rid_, context_);
+    }
+
     Rid &rid() override { return rid_; }
 
     bool is_end() const override { 
@@ -138,7 +186,60 @@ class SeqScanExecutor : public AbstractExecutor {
     const std::vector<ColMeta> &cols() const override { return cols_; }
 
     private:
-    bool eval_cond(const RmRecord *rec, const Condition &cond, const std::vector<ColMeta> &rec_cols) {
+    // 找出谓词涉及的列及其在PAX页面中的列号
+    void init_pax() {
+        auto add_pred_col = [&](const TabCol &tab_col) {
+            auto col = std::find_if(cols_.begin(), cols_.end(),
+                                    [&](const ColMeta &col_meta) { return col_meta.name == tab_col.col_name; });
+            if (col == cols_.end()) {
+                throw ColumnNotFoundError(tab_col.tab_name + "." + tab_col.col_name);
+            }
+            if (std::find(pred_cols_.begin(), pred_cols_.end(), &*col) == pred_cols_.end()) {
+                pred_cols_.push_back(&*col);
+                pred_col_nos_.push_back(fh_->column_of(col->offset));
+            }
+        };
+        for (auto &cond : fed_conds_) {
+            add_pred_col(cond.lhs_col);
+            if (!cond.is_rhs_val) {
+                add_pred_col(cond.rhs_col);
+            }
+        }
+        probe_buf_ = context_->arena_.allocate(len_);
+        out_buf_ = context_->arena_.allocate(len_);
+    }
+
+    /**
+     * @description: PAX格式：从当前页面的slot_no开始（含slot_no）查找下一条满足条件的记录，
+     * 只把谓词涉及的列从列向量复制到probe_buf_中求值，找到时赋值给rid_
+     * @param {int} slot_no 当前页面中开始查找的已用slot，为num_slots时从下一个页面开始
+     */
+    void seek_pax(int slot_no) {
+        while (!pax_scan_->is_end()) {
+            int page_no = pax_scan_->rid().page_no;
+            if (!column_page_ || column_page_.page_no() != page_no) {
+                column_page_ = fh_->get_column_page(page_no);
+            }
+            int num_slots = column_page_.num_slots();
+            for (; slot_no < num_slots; slot_no = column_page_.next_used(slot_no)) {
+                for (size_t i = 0; i < pred_cols_.size(); i++) {
+                    int width = pred_cols_[i]->len;
+                    memcpy(probe_buf_ + pred_cols_[i]->offset,
+                           column_page_.column(pred_col_nos_[i]) + slot_no * width, width);
+                }
+                if (eval_conds(probe_buf_, fed_conds_, cols_)) {
+                    rid_ = Rid{page_no, slot_no};
+                    return;
+                }
+            }
+            pax_scan_->next_page();
+            slot_no = pax_scan_->rid().slot_no;
+        }
+        // 扫描结束，释放最后一个页面的pin
+        column_page_ = RmColumnPage();
+    }
+
+    bool eval_cond(const char *rec, const Condition &cond, const char *rhs_val, const std::vector<ColMeta> &rec_cols) {
         // 1. 获取条件左部表达式的类型和值
         auto lhs_col_it = std::find_if(rec_cols.begin(), rec_cols.end(),
             [&](const ColMeta &col_meta) {
@@ -150,27 +251,18 @@ class SeqScanExecutor : public AbstractExecutor {
         }
         
         // 获取左部值在记录中的数据
-        char *lhs_data = rec->data + lhs_col_it->offset;
+        const char *lhs_data = rec + lhs_col_it->offset;
         ColType lhs_type = lhs_col_it->type;
         int lhs_len = lhs_col_it->len;
         
         // 2. 获取条件右部表达式的类型和值
-        char *rhs_data = nullptr;
+        const char *rhs_data = nullptr;
         ColType rhs_type;
-        int rhs_len;
-        
-        Value temp_rhs_val;  // 用于存储临时的右部值
         
         if (cond.is_rhs_val) {
-            // 右部是常量值
-            temp_rhs_val = cond.rhs_val;
-            // 只有在 raw 为空时才调用 init_raw
-            if (temp_rhs_val.raw == nullptr) {
-                temp_rhs_val.init_raw(lhs_len);  // 初始化为与左部相同的长度
-            }
-            rhs_data = temp_rhs_val.raw->data;
-            rhs_type = temp_rhs_val.type;
-            rhs_len = lhs_len;
+            // 右部是常量值，已在构造时按左部的长度编码
+            rhs_data = rhs_val;
+            rhs_type = cond.rhs_val.type;
         } else {
             // 右部是另一列
             auto rhs_col_it = std::find_if(rec_cols.begin(), rec_cols.end(),
@@ -182,9 +274,8 @@ class SeqScanExecutor : public AbstractExecutor {
                 throw ColumnNotFoundError(cond.rhs_col.tab_name + "." + cond.rhs_col.col_name);
             }
             
-            rhs_data = rec->data + rhs_col_it->offset;
+            rhs_data = rec + rhs_col_it->offset;
             rhs_type = rhs_col_it->type;
-            rhs_len = rhs_col_it->len;
         }
         
         // 检查类型是否匹配
@@ -208,9 +299,12 @@ class SeqScanExecutor : public AbstractExecutor {
         }
     }
 
-    bool eval_conds(const RmRecord *rec, const std::vector<Condition> &conds, const std::vector<ColMeta> &rec_cols) {
-        return std::all_of(conds.begin(), conds.end(),
-            [&](const Condition &cond) { return eval_cond(rec, cond, rec_cols); }
-        );
+    bool eval_conds(const char *rec, const std::vector<Condition> &conds, const std::vector<ColMeta> &rec_cols) {
+        for (size_t i = 0; i < conds.size(); i++) {
+            if (!eval_cond(rec, conds[i], rhs_vals_[i], rec_cols)) {
+                return false;
+            }
+        }
+        return true;
     }
 };
\ No newline at end of file
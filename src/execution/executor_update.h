@@ -24,6 +24,9 @@ class UpdateExecutor : public AbstractExecutor {
     std::string tab_name_;
     std::vector<SetClause> set_clauses_;
     SmManager *sm_manager_;
+    char *new_record_buf_;      // 新记录的缓冲区，在arena中分配，每条记录复用
+    char *old_key_buf_;         // 旧、新索引键的缓冲区，长度为最长的索引键
+    char *new_key_buf_;
 
    public:
     UpdateExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<SetClause> set_clauses,
@@ -36,16 +39,24 @@ class UpdateExecutor : public AbstractExecutor {
         conds_ = conds;
         rids_ = rids;
         context_ = context;
+
+        int max_key_len = 0;
+        for (auto &index : tab_.indexes) {
+            max_key_len = std::max(max_key_len, index.col_tot_len);
+        }
+        new_record_buf_ = context_->arena_.allocate(fh_->get_file_hdr().record_size);
+        old_key_buf_ = context_->arena_.allocate(max_key_len);
+        new_key_buf_ = context_->arena_.allocate(max_key_len);
     }
     std::unique_ptr<RmRecord> Next() override {
         // 遍历所有需要更新的记录
         for (auto& rid : rids_) {
-            // 先读取原记录用于索引删除
-            auto old_record = fh_->get_record(rid, context_);
+            // 先读取原记录用于索引删除，原记录只在页面中读取，不复制
+            RecordView old_record = fh_->get_record_view(rid, context_);
             
             // 创建新记录，首先复制原记录
-            RmRecord new_record(fh_->get_file_hdr().record_size);
-            memcpy(new_record.data, old_record->data, fh_->get_file_hdr().record_size);
+            char *new_record = new_record_buf_;
+            memcpy(new_record, old_record.data(), fh_->get_file_hdr().record_size);
             
             // 根据 set_clauses_ 更新新记录的字段
             for (auto& set_clause : set_clauses_) {
@@ -57,13 +68,8 @@ class UpdateExecutor : public AbstractExecutor {
                     throw IncompatibleTypeError(coltype2str(col_meta->type), coltype2str(set_clause.rhs.type));
                 }
                 
-                // 创建一个新的 Value 对象来避免 raw 指针冲突
-                Value new_val = set_clause.rhs;
-                new_val.raw = nullptr;  // 重置 raw 指针
-                new_val.init_raw(col_meta->len);
-                
-                // 将新值复制到记录中对应位置
-                memcpy(new_record.data + col_meta->offset, new_val.raw->data, col_meta->len);
+                // 将新值直接写入记录中对应位置
+                set_clause.rhs.write_raw(new_record + col_meta->offset, col_meta->len);
             }
             
             // 更新索引：先删除旧索引条目，再插入新索引条目
@@ -72,18 +78,18 @@ class UpdateExecutor : public AbstractExecutor {
                 auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
                 
                 // 构造旧记录的索引键
-                char* old_key = new char[index.col_tot_len];
+                char* old_key = old_key_buf_;
                 int offset = 0;
                 for (size_t j = 0; j < index.col_num; ++j) {
-                    memcpy(old_key + offset, old_record->data + index.cols[j].offset, index.cols[j].len);
+                    memcpy(old_key + offset, old_record.data() + index.cols[j].offset, index.cols[j].len);
                     offset += index.cols[j].len;
                 }
                 
                 // 构造新记录的索引键
-                char* new_key = new char[index.col_tot_len];
+                char* new_key = new_key_buf_;
                 offset = 0;
                 for (size_t j = 0; j < index.col_num; ++j) {
-                    memcpy(new_key + offset, new_record.data + index.cols[j].offset, index.cols[j].len);
+                    memcpy(new_key + offset, new_record + index.cols[j].offset, index.cols[j].len);
                     offset += index.cols[j].len;
                 }
                 
@@ -92,13 +98,10 @@ class UpdateExecutor : public AbstractExecutor {
                 
                 // 插入新索引条目
                 ih->insert_entry(new_key, rid, context_->txn_);
-                
-                delete[] old_key;
-                delete[] new_key;
             }
             
             // 最后更新记录文件中的记录
-            fh_->update_record(rid, new_record.data, context_);
+            fh_->update_record(rid, new_record, context_);
         }
         
         return nullptr;
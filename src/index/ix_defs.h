@@ -21,6 +21,9 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+constexpr double IX_BULK_FILL_FACTOR = 0.9;             // 批量建索引时结点的填充率，为之后的插入预留空间
+constexpr size_t IX_SORT_MEMORY_LIMIT = 64 << 20;       // 批量建索引时外部排序使用的内存上限，超过则写出有序run
+constexpr bool IX_OPTIMISTIC_LATCHING = true;           // 插入删除先在读latch下查找叶子，需要分裂或合并时再用写latch重试
 
 class IxFileHdr {
 public: 
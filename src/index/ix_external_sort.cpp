@@ -0,0 +1,152 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_external_sort.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "errors.h"
+#include "ix_index_handle.h"
+
+static constexpr size_t RUN_IO_BUFFER_SIZE = 256 << 10;  // 每个run文件的stdio缓冲区大小
+
+IxExternalSorter::IxExternalSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens,
+                                   size_t memory_limit)
+    : col_types_(col_types), col_lens_(col_lens), memory_limit_(memory_limit) {
+    key_len_ = 0;
+    for (int len : col_lens_) {
+        key_len_ += len;
+    }
+    entry_len_ = key_len_ + sizeof(Rid);
+}
+
+IxExternalSorter::~IxExternalSorter() {
+    for (auto &run : runs_) {
+        fclose(run.file);
+    }
+}
+
+int IxExternalSorter::compare(const char *a, const char *b) const {
+    int res = ix_compare(a, b, col_types_, col_lens_);
+    if (res != 0) {
+        return res;
+    }
+    // 键相同时按Rid排序，使结果确定
+    Rid ra, rb;
+    memcpy(&ra, a + key_len_, sizeof(Rid));
+    memcpy(&rb, b + key_len_, sizeof(Rid));
+    if (ra.page_no != rb.page_no) {
+        return ra.page_no < rb.page_no ? -1 : 1;
+    }
+    return ra.slot_no < rb.slot_no ? -1 : (ra.slot_no > rb.slot_no ? 1 : 0);
+}
+
+void IxExternalSorter::add(const char *key, const Rid &rid) {
+    assert(!finished_);
+    size_t pos = buffer_.size();
+    buffer_.resize(pos + entry_len_);
+    memcpy(buffer_.data() + pos, key, key_len_);
+    memcpy(buffer_.data() + pos + key_len_, &rid, sizeof(Rid));
+    num_entries_++;
+    if (buffer_.size() >= memory_limit_) {
+        spill();
+    }
+}
+
+void IxExternalSorter::sort_buffer() {
+    size_t n = buffer_.size() / entry_len_;
+    sorted_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        sorted_[i] = buffer_.data() + i * entry_len_;
+    }
+    std::sort(sorted_.begin(), sorted_.end(), [&](const char *a, const char *b) { return compare(a, b) < 0; });
+}
+
+void IxExternalSorter::spill() {
+    sort_buffer();
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+        throw UnixError();
+    }
+    runs_.push_back(Run{file, std::vector<char>(entry_len_)});
+    std::vector<char> out(RUN_IO_BUFFER_SIZE);
+    size_t used = 0;
+    for (const char *entry : sorted_) {
+        if (used + entry_len_ > out.size()) {
+            if (fwrite(out.data(), 1, used, file) != used) {
+                throw UnixError();
+            }
+            used = 0;
+        }
+        memcpy(out.data() + used, entry, entry_len_);
+        used += entry_len_;
+    }
+    if (fwrite(out.data(), 1, used, file) != used || fflush(file) != 0) {
+        throw UnixError();
+    }
+    buffer_.clear();
+    sorted_.clear();
+}
+
+bool IxExternalSorter::read_entry(Run &run) {
+    return fread(run.entry.data(), 1, entry_len_, run.file) == static_cast<size_t>(entry_len_);
+}
+
+void IxExternalSorter::finish() {
+    assert(!finished_);
+    finished_ = true;
+    if (runs_.empty()) {
+        // 数据全部在内存中，直接排序后按序返回
+        sort_buffer();
+        return;
+    }
+    if (!buffer_.empty()) {
+        spill();
+    }
+    buffer_.shrink_to_fit();
+    auto greater = [&](int a, int b) { return compare(runs_[a].entry.data(), runs_[b].entry.data()) > 0; };
+    for (int i = 0; i < static_cast<int>(runs_.size()); i++) {
+        rewind(runs_[i].file);
+        setvbuf(runs_[i].file, nullptr, _IOFBF, RUN_IO_BUFFER_SIZE);
+        if (read_entry(runs_[i])) {
+            heap_.push_back(i);
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+    }
+}
+
+bool IxExternalSorter::next(char *key, Rid *rid) {
+    assert(finished_);
+    if (runs_.empty()) {
+        if (next_sorted_ == sorted_.size()) {
+            return false;
+        }
+        const char *entry = sorted_[next_sorted_++];
+        memcpy(key, entry, key_len_);
+        memcpy(rid, entry + key_len_, sizeof(Rid));
+        return true;
+    }
+    if (heap_.empty()) {
+        return false;
+    }
+    auto greater = [&](int a, int b) { return compare(runs_[a].entry.data(), runs_[b].entry.data()) > 0; };
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    Run &run = runs_[heap_.back()];
+    memcpy(key, run.entry.data(), key_len_);
+    memcpy(rid, run.entry.data() + key_len_, sizeof(Rid));
+    if (read_entry(run)) {
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else {
+        heap_.pop_back();
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "ix_defs.h"
+
+/*
+IxExternalSorter对(key, Rid)对进行外部排序，供B+树自底向上批量建立使用。
+add()把键值对追加到内存缓冲区，缓冲区超过memory_limit时排序后写到临时文件成为一个有序run；
+finish()之后通过next()按(key, Rid)升序依次取出，有多个run时用小顶堆进行多路归并。
+临时文件由tmpfile()创建，关闭时自动删除
+*/
+class IxExternalSorter {
+   public:
+    IxExternalSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens,
+                     size_t memory_limit = IX_SORT_MEMORY_LIMIT);
+
+    ~IxExternalSorter();
+
+    IxExternalSorter(const IxExternalSorter &) = delete;
+    IxExternalSorter &operator=(const IxExternalSorter &) = delete;
+
+    /**
+     * @description: 添加一个键值对，必须在finish()之前调用
+     * @param {char*} key 索引键，长度为各字段长度之和
+     * @param {Rid&} rid 键对应的记录位置
+     */
+    void add(const char *key, const Rid &rid);
+
+    /**
+     * @description: 结束输入，排序内存中剩余的数据并准备归并
+     */
+    void finish();
+
+    /**
+     * @description: 按升序取出下一个键值对，必须在finish()之后调用
+     * @return {bool} 全部取完时返回false
+     * @param {char*} key 输出键，调用者保证空间不小于键长
+     * @param {Rid*} rid 输出记录位置
+     */
+    bool next(char *key, Rid *rid);
+
+    /* 添加的键值对总数 */
+    size_t size() const { return num_entries_; }
+
+    /* 溢出到磁盘的run个数，全部在内存中排序时为0 */
+    int num_runs() const { return static_cast<int>(runs_.size()); }
+
+   private:
+    struct Run {
+        FILE *file;
+        std::vector<char> entry;  // 当前位于归并前端的键值对
+    };
+
+    int compare(const char *a, const char *b) const;
+
+    void sort_buffer();
+
+    void spill();
+
+    bool read_entry(Run &run);
+
+    std::vector<ColType> col_types_;
+    std::vector<int> col_lens_;
+    int key_len_;
+    int entry_len_;                 // key_len_ + sizeof(Rid)
+    size_t memory_limit_;
+    size_t num_entries_ = 0;
+    bool finished_ = false;
+
+    std::vector<char> buffer_;      // 未排序的键值对，每个entry_len_字节
+    std::vector<const char *> sorted_;  // 排序后指向buffer_中各键值对的指针
+    size_t next_sorted_ = 0;        // 没有run时，下一个由next()返回的sorted_下标
+
+    std::vector<Run> runs_;
+    std::vector<int> heap_;         // 以run当前键值对为序的小顶堆，存run的下标
+};
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include <algorithm>
+
 #include "ix_scan.h"
 
 /**
@@ -19,25 +21,36 @@ See the Mulan PSL v2 for more details. */
  * @note 返回key index（同时也是rid index），作为slot no
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    int lo = 0, hi = page_hdr->num_key;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (ix_compare(get_key(mid), target, file_hdr->col_types_, file_hdr->col_lens_) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
 /**
  * @brief 在当前node中查找第一个>target的key_idx
  *
- * @return key_idx，范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
- * @note 注意此处的范围从1开始
+ * @return key_idx，内部结点的范围为[1,num_key)，叶子结点的范围为[0,num_key)，
+ * 如果返回的key_idx=num_key，则表示target大于等于最后一个key
+ * @note 内部结点的第0个key不参与比较，因此其范围从1开始
  */
 int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    int lo = page_hdr->is_leaf ? 0 : 1, hi = page_hdr->num_key;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (ix_compare(get_key(mid), target, file_hdr->col_types_, file_hdr->col_lens_) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
 /**
@@ -49,13 +62,12 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
-
-    return false;
+    int pos = lower_bound(key);
+    if (pos == get_size() || ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_) != 0) {
+        return false;
+    }
+    *value = get_rid(pos);
+    return true;
 }
 
 /**
@@ -64,12 +76,7 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
-
-    return -1;
+    return value_at(upper_bound(key) - 1);
 }
 
 /**
@@ -87,12 +94,14 @@ page_id_t IxNodeHandle::internal_lookup(const char *key) {
  *                      key           key_slot
  */
 void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos <= size && size + n <= get_max_size());
+    int key_len = file_hdr->col_tot_len_;
+    memmove(get_key(pos + n), get_key(pos), (size_t)(size - pos) * key_len);
+    memcpy(get_key(pos), key, (size_t)n * key_len);
+    memmove(get_rid(pos + n), get_rid(pos), (size_t)(size - pos) * sizeof(Rid));
+    memcpy(get_rid(pos), rid, (size_t)n * sizeof(Rid));
+    set_size(size + n);
 }
 
 /**
@@ -100,16 +109,15 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * 函数返回插入后的键值对数量
  *
  * @param (key, value) 要插入的键值对
- * @return int 键值对数量
+ * @return int 键值对数量，key已存在时不插入，返回值与插入前相同
  */
 int IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+        return get_size();
+    }
+    insert_pair(pos, key, value);
+    return get_size();
 }
 
 /**
@@ -118,11 +126,12 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos < size);
+    int key_len = file_hdr->col_tot_len_;
+    memmove(get_key(pos), get_key(pos + 1), (size_t)(size - pos - 1) * key_len);
+    memmove(get_rid(pos), get_rid(pos + 1), (size_t)(size - pos - 1) * sizeof(Rid));
+    set_size(size - 1);
 }
 
 /**
@@ -132,12 +141,11 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量
  */
 int IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+        erase_pair(pos);
+    }
+    return get_size();
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -155,23 +163,158 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     disk_manager_->set_fd2pageno(fd, now_page_no + 1);
 }
 
+/**
+ * @brief 判断对node执行operation之后是否不会影响其父结点，即node是否"安全"
+ * 插入时node不会分裂，删除时node不会下溢；并且node的第一个key不会改变，否则需要用maintain_parent更新父结点
+ * 根结点没有父结点，只需要保证根结点本身不会改变
+ *
+ * @param node 已加写latch的结点
+ * @param key 要插入或删除的key
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, Operation operation, const char *key) {
+    if (operation == Operation::FIND) {
+        return true;
+    }
+    bool is_root = node->is_root_page();
+    int first_key_cmp = node->get_size() == 0
+                            ? 1
+                            : ix_compare(key, node->get_key(0), file_hdr_->col_types_, file_hdr_->col_lens_);
+    if (operation == Operation::INSERT) {
+        return node->get_size() + 1 < node->get_max_size() && (is_root || first_key_cmp > 0);
+    }
+    if (is_root) {
+        // 内部根结点只剩一个孩子时需要由adjust_root更换根结点，叶子根结点为空时保留为空树
+        return node->is_leaf_page() || node->get_size() > 2;
+    }
+    return node->get_size() > node->get_min_size() && first_key_cmp != 0;
+}
+
+/**
+ * @brief 释放事务在当前写操作中持有的除最后一个结点之外的所有latch，以及根结点的latch
+ * 在latch crabbing中，当前结点安全时调用，此时祖先结点都没有被修改
+ */
+void IxIndexHandle::release_ancestors(Transaction *transaction, bool *root_is_latched) {
+    if (*root_is_latched) {
+        root_latch_.unlock();
+        *root_is_latched = false;
+    }
+    auto latched = transaction->get_index_latch_page_set();
+    while (latched->size() > 1) {
+        Page *page = latched->front();
+        latched->pop_front();
+        page->wunlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+}
+
+/**
+ * @brief 写操作结束时释放所有latch，然后删除操作过程中被合并掉的结点
+ * 被删除的页面一定也在latch集合中（或仍被固定），因此要先记下页号再unpin
+ */
+void IxIndexHandle::release_latches(Transaction *transaction, bool *root_is_latched) {
+    auto deleted = transaction->get_index_deleted_page_set();
+    std::vector<PageId> deleted_ids;
+    for (Page *page : *deleted) {
+        deleted_ids.push_back(page->get_page_id());
+    }
+    deleted->clear();
+
+    auto latched = transaction->get_index_latch_page_set();
+    for (Page *page : *latched) {
+        page->wunlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
+    latched->clear();
+    if (*root_is_latched) {
+        root_latch_.unlock();
+        *root_is_latched = false;
+    }
+    for (auto &page_id : deleted_ids) {
+        buffer_pool_manager_->delete_page(page_id);
+    }
+}
+
 /**
  * @brief 用于查找指定键所在的叶子结点
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
- * @param transaction 事务参数，如果不需要则默认传入nullptr
+ * @param transaction 事务参数，写操作必须传入，用于记录加了latch的结点
+ * @param find_first 为true时直接找到最左边的叶子结点
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * 查找时对路径上的结点依次加读latch，拿到孩子的latch之后立即释放父结点；
+ * 插入和删除时加写latch，并把结点加入事务的index_latch_page_set，孩子安全时才释放其所有祖先（latch crabbing）
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
                                                             Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+    if (operation == Operation::FIND) {
+        root_latch_.lock_shared();
+        IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+        node->page->rlatch();
+        root_latch_.unlock_shared();
+        while (!node->is_leaf_page()) {
+            IxNodeHandle *child = fetch_node(find_first ? node->value_at(0) : node->internal_lookup(key));
+            child->page->rlatch();
+            node->page->runlatch();
+            buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+            delete node;
+            node = child;
+        }
+        return std::make_pair(node, false);
+    }
+
+    bool root_is_latched = true;
+    root_latch_.lock();
+    auto latched = transaction->get_index_latch_page_set();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    node->page->wlatch();
+    latched->push_back(node->page);
+    if (is_safe(node, operation, key)) {
+        release_ancestors(transaction, &root_is_latched);
+    }
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(find_first ? node->value_at(0) : node->internal_lookup(key));
+        child->page->wlatch();
+        latched->push_back(child->page);
+        if (is_safe(child, operation, key)) {
+            release_ancestors(transaction, &root_is_latched);
+        }
+        delete node;
+        node = child;
+    }
+    return std::make_pair(node, root_is_latched);
+}
 
-    return std::make_pair(nullptr, false);
+/**
+ * @brief 乐观的写操作查找：像查找一样对内部结点加读latch，只对叶子结点加写latch
+ *
+ * @return 加了写latch的叶子结点，不持有其它latch；调用者判断叶子不安全时应释放它并改用find_leaf_page重试
+ * @note 根结点本身是叶子时也只加写latch，此时若需要分裂同样要重试
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_optimistic(const char *key) {
+    root_latch_.lock_shared();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    // 结点是否为叶子在其存在期间不会改变，持有父结点（或root_latch_）的latch时可以在加latch之前读取
+    if (node->is_leaf_page()) {
+        node->page->wlatch();
+    } else {
+        node->page->rlatch();
+    }
+    root_latch_.unlock_shared();
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(node->internal_lookup(key));
+        if (child->is_leaf_page()) {
+            child->page->wlatch();
+        } else {
+            child->page->rlatch();
+        }
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        node = child;
+    }
+    return node;
 }
 
 /**
@@ -183,13 +326,16 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-
-    return false;
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+    Rid *rid;
+    bool found = leaf->leaf_lookup(key, &rid);
+    if (found) {
+        result->push_back(*rid);
+    }
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return found;
 }
 
 /**
@@ -198,16 +344,44 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
  * @return 拆分得到的new_node
  * @note need to unpin the new node outside
  * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * new node在插入父结点之前其它线程无法访问，因此不需要加latch；
+ * 修改右边叶子的prev_leaf之前对其加写latch，叶子之间总是从左到右加latch，不会死锁
  */
 IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+    IxNodeHandle *new_node = create_node();
+    *new_node->page_hdr = {
+        .next_free_page_no = IX_NO_PAGE,
+        .parent = node->get_parent_page_no(),
+        .num_key = 0,
+        .is_leaf = node->is_leaf_page(),
+        .prev_leaf = IX_NO_PAGE,
+        .next_leaf = IX_NO_PAGE,
+    };
+    int pos = node->get_size() / 2;
+    int n = node->get_size() - pos;
+    new_node->insert_pairs(0, node->get_key(pos), node->get_rid(pos), n);
+    node->set_size(pos);
 
-    return nullptr;
+    if (new_node->is_leaf_page()) {
+        new_node->set_prev_leaf(node->get_page_no());
+        new_node->set_next_leaf(node->get_next_leaf());
+        IxNodeHandle *next = fetch_node(node->get_next_leaf());
+        next->page->wlatch();
+        next->set_prev_leaf(new_node->get_page_no());
+        next->page->wunlatch();
+        buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+        delete next;
+        node->set_next_leaf(new_node->get_page_no());
+        std::scoped_lock lock{file_hdr_latch_};
+        if (file_hdr_->last_leaf_ == node->get_page_no()) {
+            file_hdr_->last_leaf_ = new_node->get_page_no();
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            maintain_child(new_node, i);
+        }
+    }
+    return new_node;
 }
 
 /**
@@ -222,46 +396,141 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
  * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
  * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
+ * old_node不安全，因此其父结点（或根结点的root_latch_）仍由当前事务持有写latch
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                      Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
+    if (old_node->is_root_page()) {
+        IxNodeHandle *root = create_node();
+        *root->page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = false,
+            .prev_leaf = IX_NO_PAGE,
+            .next_leaf = IX_NO_PAGE,
+        };
+        Rid old_rid = {.page_no = old_node->get_page_no(), .slot_no = -1};
+        Rid new_rid = {.page_no = new_node->get_page_no(), .slot_no = -1};
+        root->insert_pair(0, old_node->get_key(0), old_rid);
+        root->insert_pair(1, key, new_rid);
+        old_node->set_parent_page_no(root->get_page_no());
+        new_node->set_parent_page_no(root->get_page_no());
+        update_root_page_no(root->get_page_no());
+        buffer_pool_manager_->unpin_page(root->get_page_id(), true);
+        delete root;
+        return;
+    }
+
+    IxNodeHandle *parent = fetch_node(old_node->get_parent_page_no());
+    int rank = parent->find_child(old_node);
+    parent->insert_pair(rank + 1, key, Rid{.page_no = new_node->get_page_no(), .slot_no = -1});
+    new_node->set_parent_page_no(parent->get_page_no());
+    if (parent->get_size() == parent->get_max_size()) {
+        IxNodeHandle *new_parent = split(parent);
+        insert_into_parent(parent, new_parent->get_key(0), new_parent, transaction);
+        buffer_pool_manager_->unpin_page(new_parent->get_page_id(), true);
+        delete new_parent;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
 }
 
 /**
  * @brief 将指定键值对插入到B+树中
  * @param (key, value) 要插入的键值对
- * @param transaction 事务指针
- * @return page_id_t 插入到的叶结点的page_no
+ * @param transaction 事务指针，为nullptr时使用临时的事务记录latch
+ * @return page_id_t 插入到的叶结点的page_no，key已存在时返回IX_NO_PAGE
+ * @note 乐观模式下先只对叶子加写latch，叶子安全时直接插入，否则改用latch crabbing重新查找
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
+    if (optimistic_) {
+        IxNodeHandle *leaf = find_leaf_optimistic(key);
+        int old_size = leaf->get_size();
+        bool safe = is_safe(leaf, Operation::INSERT, key);
+        if (safe) {
+            leaf->insert(key, value);
+        }
+        page_id_t page_no = leaf->get_size() == old_size ? IX_NO_PAGE : leaf->get_page_no();
+        leaf->page->wunlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), page_no != IX_NO_PAGE);
+        delete leaf;
+        if (safe) {
+            return page_no;
+        }
+    }
 
-    return -1;
+    std::unique_ptr<Transaction> local_txn;
+    if (transaction == nullptr) {
+        local_txn = std::make_unique<Transaction>(INVALID_TXN_ID);
+        transaction = local_txn.get();
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::INSERT, transaction);
+    int old_size = leaf->get_size();
+    page_id_t page_no = IX_NO_PAGE;
+    if (leaf->insert(key, value) != old_size) {
+        page_no = leaf->get_page_no();
+        if (leaf->lower_bound(key) == 0) {
+            // 只有第一个key变化时才需要更新祖先，此时叶子不安全，父结点仍持有latch
+            maintain_parent(leaf);
+        }
+        if (leaf->get_size() == leaf->get_max_size()) {
+            IxNodeHandle *new_leaf = split(leaf);
+            if (ix_compare(key, new_leaf->get_key(0), file_hdr_->col_types_, file_hdr_->col_lens_) >= 0) {
+                page_no = new_leaf->get_page_no();
+            }
+            insert_into_parent(leaf, new_leaf->get_key(0), new_leaf, transaction);
+            buffer_pool_manager_->unpin_page(new_leaf->get_page_id(), true);
+            delete new_leaf;
+        }
+    }
+    delete leaf;
+    release_latches(transaction, &root_is_latched);
+    return page_no;
 }
 
 /**
  * @brief 用于删除B+树中含有指定key的键值对
  * @param key 要删除的key值
- * @param transaction 事务指针
+ * @param transaction 事务指针，为nullptr时使用临时的事务记录latch
+ * @note 乐观模式下先只对叶子加写latch，叶子安全时直接删除，否则改用latch crabbing重新查找；
+ * 合并掉的结点记录在事务的index_deleted_page_set中，释放所有latch之后再从缓冲池删除
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
+    if (optimistic_) {
+        IxNodeHandle *leaf = find_leaf_optimistic(key);
+        int old_size = leaf->get_size();
+        bool safe = is_safe(leaf, Operation::DELETE, key);
+        if (safe) {
+            leaf->remove(key);
+        }
+        bool deleted = leaf->get_size() != old_size;
+        leaf->page->wunlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), deleted);
+        delete leaf;
+        if (safe) {
+            return deleted;
+        }
+    }
 
-    return false;
+    std::unique_ptr<Transaction> local_txn;
+    if (transaction == nullptr) {
+        local_txn = std::make_unique<Transaction>(INVALID_TXN_ID);
+        transaction = local_txn.get();
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::DELETE, transaction);
+    int old_size = leaf->get_size();
+    bool first_removed = leaf->lower_bound(key) == 0;
+    bool deleted = leaf->remove(key) != old_size;
+    if (deleted) {
+        if (first_removed && leaf->get_size() > 0) {
+            maintain_parent(leaf);
+        }
+        coalesce_or_redistribute(leaf, transaction, &root_is_latched);
+    }
+    delete leaf;
+    release_latches(transaction, &root_is_latched);
+    return deleted;
 }
 
 /**
@@ -270,23 +539,42 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * @param node 执行完删除操作的结点
  * @param transaction 事务指针
  * @param root_is_latched 传出参数：根节点是否上锁，用于并发操作
- * @return 是否需要删除结点
+ * @return 是否需要删除结点，需要删除的结点已加入事务的index_deleted_page_set
  * @note User needs to first find the sibling of input page.
  * If sibling's size + input page's size >= 2 * page's minsize, then redistribute.
  * Otherwise, merge(Coalesce).
+ * node不安全时其父结点仍在事务的latch集合中；兄弟结点加写latch后也放入latch集合，在操作结束时统一释放
  */
 bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
+    if (node->is_root_page()) {
+        bool root_deleted = adjust_root(node);
+        if (root_deleted) {
+            transaction->append_index_deleted_page(node->page);
+        }
+        return root_deleted;
+    }
+    if (node->get_size() >= node->get_min_size()) {
+        return false;
+    }
+
+    IxNodeHandle *parent = fetch_node(node->get_parent_page_no());
+    int index = parent->find_child(node);
+    IxNodeHandle *neighbor = fetch_node(parent->value_at(index == 0 ? 1 : index - 1));
+    neighbor->page->wlatch();
+    transaction->append_index_latch_page_set(neighbor->page);
 
-    return false;
+    bool node_deleted = false;
+    if (node->get_size() + neighbor->get_size() >= node->get_min_size() * 2) {
+        redistribute(neighbor, node, parent, index);
+    } else {
+        IxNodeHandle *left = neighbor, *right = node;
+        coalesce(&left, &right, &parent, index, transaction, root_is_latched);
+        node_deleted = index != 0;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
+    delete neighbor;
+    return node_deleted;
 }
 
 /**
@@ -294,14 +582,20 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @param old_root_node 原根节点
  * @return bool 根结点是否需要被删除
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
+ * 叶子根结点删空之后仍保留为空树的根，leaf_begin()和leaf_end()此时相等
  */
 bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
-    // Todo:
-    // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    // 3. 除了上述两种情况，不需要进行操作
-
-    return false;
+    if (old_root_node->is_leaf_page() || old_root_node->get_size() != 1) {
+        return false;
+    }
+    page_id_t child_page_no = old_root_node->remove_and_return_only_child();
+    IxNodeHandle *child = fetch_node(child_page_no);
+    child->set_parent_page_no(IX_NO_PAGE);
+    buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+    delete child;
+    update_root_page_no(child_page_no);
+    release_node_handle(*old_root_node);
+    return true;
 }
 
 /**
@@ -319,11 +613,18 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
  * 注意更新parent结点的相关kv对
  */
 void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩字结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
+    if (index == 0) {
+        node->insert_pair(node->get_size(), neighbor_node->get_key(0), *neighbor_node->get_rid(0));
+        neighbor_node->erase_pair(0);
+        parent->set_key(index + 1, neighbor_node->get_key(0));
+        maintain_child(node, node->get_size() - 1);
+    } else {
+        int last = neighbor_node->get_size() - 1;
+        node->insert_pair(0, neighbor_node->get_key(last), *neighbor_node->get_rid(last));
+        neighbor_node->erase_pair(last);
+        parent->set_key(index, node->get_key(0));
+        maintain_child(node, 0);
+    }
 }
 
 /**
@@ -342,13 +643,30 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  */
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                              Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
+    if (index == 0) {
+        std::swap(*neighbor_node, *node);
+    }
+    IxNodeHandle *left = *neighbor_node, *right = *node;
+    int left_size = left->get_size();
+    left->insert_pairs(left_size, right->get_key(0), right->get_rid(0), right->get_size());
+    for (int i = left_size; i < left->get_size(); i++) {
+        maintain_child(left, i);
+    }
+    if (right->is_leaf_page()) {
+        {
+            std::scoped_lock lock{file_hdr_latch_};
+            if (file_hdr_->last_leaf_ == right->get_page_no()) {
+                file_hdr_->last_leaf_ = left->get_page_no();
+            }
+        }
+        erase_leaf(right);
+    }
+    release_node_handle(*right);
+    transaction->append_index_deleted_page(right->page);
 
-    return false;
+    // 右结点在父结点中的位置不为0，删除之后父结点的第一个key不变
+    (*parent)->erase_pair((*parent)->find_child(right));
+    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
 }
 
 /**
@@ -362,11 +680,16 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
     IxNodeHandle *node = fetch_node(iid.page_no);
-    if (iid.slot_no >= node->get_size()) {
+    node->page->rlatch();
+    bool found = iid.slot_no < node->get_size();
+    Rid rid = found ? *node->get_rid(iid.slot_no) : Rid{-1, -1};
+    node->page->runlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    delete node;
+    if (!found) {
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    return rid;
 }
 
 /**
@@ -378,8 +701,12 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-
-    return Iid{-1, -1};
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    Iid iid = leaf_iid(leaf, leaf->lower_bound(key));
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -389,8 +716,22 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    return Iid{-1, -1};
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    Iid iid = leaf_iid(leaf, leaf->upper_bound(key));
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
+}
+
+/**
+ * @brief 把叶子结点中的位置转换为Iid，位置在叶子末尾且不是最后一个叶子时指向下一个叶子的第一个结点
+ */
+Iid IxIndexHandle::leaf_iid(IxNodeHandle *leaf, int slot_no) const {
+    if (slot_no == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        return Iid{.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    return Iid{.page_no = leaf->get_page_no(), .slot_no = slot_no};
 }
 
 /**
@@ -400,9 +741,17 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
+    page_id_t last_leaf;
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        last_leaf = file_hdr_->last_leaf_;
+    }
+    IxNodeHandle *node = fetch_node(last_leaf);
+    node->page->rlatch();
+    Iid iid = {.page_no = node->get_page_no(), .slot_no = node->get_size()};
+    node->page->runlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    delete node;
     return iid;
 }
 
@@ -443,7 +792,10 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
  */
 IxNodeHandle *IxIndexHandle::create_node() {
     IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        file_hdr_->num_pages_++;
+    }
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
@@ -459,20 +811,32 @@ IxNodeHandle *IxIndexHandle::create_node() {
  */
 void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
     IxNodeHandle *curr = node;
+    bool curr_dirty = false;
     while (curr->get_parent_page_no() != IX_NO_PAGE) {
         // Load its parent
         IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
         int rank = parent->find_child(curr);
         char *parent_key = parent->get_key(rank);
         char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
+        bool changed = memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) != 0;
+        if (changed) {
+            memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
+        }
+        // 上一轮取得的结点用完之后才unpin，node由调用者负责
+        if (curr != node) {
+            buffer_pool_manager_->unpin_page(curr->get_page_id(), curr_dirty);
+            delete curr;
         }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
         curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        curr_dirty = changed;
+        if (!changed || rank != 0) {
+            // parent的第一个key没有变化，不需要继续向上更新；更上层的结点也可能已经不在当前事务的latch集合中
+            break;
+        }
+    }
+    if (curr != node) {
+        buffer_pool_manager_->unpin_page(curr->get_page_id(), curr_dirty);
+        delete curr;
     }
 }
 
@@ -484,13 +848,19 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
 
+    // 前一个叶子是与leaf合并的左兄弟，调用者已持有其写latch
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
     buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
 
+    // 后一个叶子可能属于其它父结点，与split相同，从左到右对其加写latch
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
+    next->page->wlatch();
     next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
+    next->page->wunlatch();
     buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
 }
 
 /**
@@ -499,6 +869,7 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
+    std::scoped_lock lock{file_hdr_latch_};
     file_hdr_->num_pages_--;
 }
 
@@ -512,5 +883,163 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(node->get_page_no());
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 把n个键值对分配到若干个结点中，每个结点不超过fill个，且在结点多于一个时不少于min_size个
+ *
+ * @return 各结点的键值对数量，按从左到右的顺序
+ */
+static std::vector<int> plan_node_sizes(size_t n, int fill, int min_size) {
+    size_t num_nodes = (n + fill - 1) / fill;
+    // 均分之后结点过小时减少结点个数；此时n < min_size * (num_nodes + 1)，均分后仍不超过btree_order
+    while (num_nodes > 1 && n / num_nodes < static_cast<size_t>(min_size)) {
+        num_nodes--;
+    }
+    std::vector<int> sizes(num_nodes, static_cast<int>(n / num_nodes));
+    for (size_t i = 0; i < n % num_nodes; i++) {
+        sizes[i]++;
+    }
+    return sizes;
+}
+
+/**
+ * @brief 索引是否仍是刚创建时的空树，即根结点是初始的空叶子结点，只有这时才能bulk_load
+ */
+bool IxIndexHandle::is_empty() {
+    std::shared_lock lock{root_latch_};
+    return is_empty_root();
+}
+
+/**
+ * @note 调用者持有root_latch_
+ */
+bool IxIndexHandle::is_empty_root() const {
+    IxNodeHandle *root = fetch_node(file_hdr_->root_page_);
+    bool empty = root->get_page_no() == IX_INIT_ROOT_PAGE && root->is_leaf_page() && root->get_size() == 0;
+    buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+    return empty;
+}
+
+/**
+ * @brief 由排好序的键值对自底向上批量建立B+树，只能用于刚创建的空索引
+ *
+ * @param sorter 已调用finish()的外部排序器
+ * @param fill_factor 结点的填充率，每个结点最多存放btree_order * fill_factor个键值对
+ * @note 叶子结点按键的顺序从左到右依次分配页面，然后逐层用下一层各结点的第一个key和页号构造内部结点，
+ * 直到某一层只剩一个结点作为根结点。相比逐条insert_entry，不会发生结点分裂，结点填充率也由fill_factor决定
+ */
+void IxIndexHandle::bulk_load(IxExternalSorter *sorter, double fill_factor) {
+    std::scoped_lock lock{root_latch_};
+
+    if (!is_empty_root()) {
+        throw InternalError("IxIndexHandle::bulk_load: index is not empty");
+    }
+    if (sorter->size() == 0) {
+        return;
+    }
+
+    int key_len = file_hdr_->col_tot_len_;
+    int min_size = (file_hdr_->btree_order_ + 1) / 2;
+    int fill = std::clamp(static_cast<int>(file_hdr_->btree_order_ * fill_factor), min_size, file_hdr_->btree_order_);
+    auto init_node = [](IxNodeHandle *node, bool is_leaf) {
+        *node->page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = is_leaf,
+            .prev_leaf = IX_NO_PAGE,
+            .next_leaf = IX_NO_PAGE,
+        };
+    };
+
+    // 当前层各结点的第一个key和页号，用于构造上一层
+    std::vector<char> first_keys;
+    std::vector<page_id_t> page_nos;
+
+    // 叶子层：第一个叶子复用初始的根结点页面，之后的叶子依次新建，前一个叶子在下一个叶子建好后才unpin
+    std::vector<int> sizes = plan_node_sizes(sorter->size(), fill, min_size);
+    first_keys.resize(sizes.size() * key_len);
+    page_nos.resize(sizes.size());
+    std::vector<char> last_key(key_len);
+    IxNodeHandle *prev_leaf = nullptr;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        IxNodeHandle *leaf = i == 0 ? fetch_node(IX_INIT_ROOT_PAGE) : create_node();
+        init_node(leaf, true);
+        if (prev_leaf != nullptr) {
+            prev_leaf->set_next_leaf(leaf->get_page_no());
+            leaf->set_prev_leaf(prev_leaf->get_page_no());
+            buffer_pool_manager_->unpin_page(prev_leaf->get_page_id(), true);
+            delete prev_leaf;
+        } else {
+            leaf->set_prev_leaf(IX_LEAF_HEADER_PAGE);
+        }
+        prev_leaf = leaf;
+
+        for (int j = 0; j < sizes[i]; j++) {
+            Rid rid;
+            bool has_next = sorter->next(leaf->get_key(j), &rid);
+            assert(has_next);
+            // 排序后相同的key相邻，与前一个key比较即可发现重复
+            if ((i > 0 || j > 0) &&
+                ix_compare(last_key.data(), leaf->get_key(j), file_hdr_->col_types_, file_hdr_->col_lens_) == 0) {
+                buffer_pool_manager_->unpin_page(leaf->get_page_id(), true);
+                delete leaf;
+                // 叶子头结点和first_leaf/last_leaf还没有修改，把初始的根结点恢复为空叶子即回到空树，已新建的叶子不再可达
+                IxNodeHandle *root = fetch_node(IX_INIT_ROOT_PAGE);
+                init_node(root, true);
+                root->set_prev_leaf(IX_LEAF_HEADER_PAGE);
+                root->set_next_leaf(IX_LEAF_HEADER_PAGE);
+                buffer_pool_manager_->unpin_page(root->get_page_id(), true);
+                delete root;
+                throw IndexDuplicateKeyError();
+            }
+            memcpy(last_key.data(), leaf->get_key(j), key_len);
+            leaf->set_rid(j, rid);
+        }
+        leaf->set_size(sizes[i]);
+        memcpy(&first_keys[i * key_len], leaf->get_key(0), key_len);
+        page_nos[i] = leaf->get_page_no();
+    }
+    prev_leaf->set_next_leaf(IX_LEAF_HEADER_PAGE);
+    buffer_pool_manager_->unpin_page(prev_leaf->get_page_id(), true);
+    delete prev_leaf;
+
+    IxNodeHandle *leaf_header = fetch_node(IX_LEAF_HEADER_PAGE);
+    leaf_header->set_next_leaf(page_nos.front());
+    leaf_header->set_prev_leaf(page_nos.back());
+    buffer_pool_manager_->unpin_page(leaf_header->get_page_id(), true);
+    delete leaf_header;
+    file_hdr_->first_leaf_ = page_nos.front();
+    file_hdr_->last_leaf_ = page_nos.back();
+
+    // 内部结点层：第i个孩子对应的key为该孩子的第一个key
+    while (page_nos.size() > 1) {
+        sizes = plan_node_sizes(page_nos.size(), fill, min_size);
+        std::vector<char> parent_keys(sizes.size() * key_len);
+        std::vector<page_id_t> parent_page_nos(sizes.size());
+        size_t child = 0;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            IxNodeHandle *node = create_node();
+            init_node(node, false);
+            for (int j = 0; j < sizes[i]; j++, child++) {
+                node->set_key(j, &first_keys[child * key_len]);
+                node->set_rid(j, Rid{.page_no = page_nos[child], .slot_no = -1});
+            }
+            node->set_size(sizes[i]);
+            for (int j = 0; j < sizes[i]; j++) {
+                maintain_child(node, j);
+            }
+            memcpy(&parent_keys[i * key_len], node->get_key(0), key_len);
+            parent_page_nos[i] = node->get_page_no();
+            buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+            delete node;
+        }
+        first_keys.swap(parent_keys);
+        page_nos.swap(parent_page_nos);
+    }
+    update_root_page_no(page_nos.front());
+}
@@ -10,7 +10,11 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <shared_mutex>
+
 #include "ix_defs.h"
+#include "ix_external_sort.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
@@ -167,7 +171,9 @@ class IxIndexHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::shared_mutex root_latch_;              // 保护root_page，查找时共享持有，可能修改根结点的写操作独占持有
+    mutable std::mutex file_hdr_latch_;         // 保护file_hdr_中的num_pages和last_leaf
+    std::atomic<bool> optimistic_{IX_OPTIMISTIC_LATCHING};  // 写操作是否先乐观地只对叶子加写latch
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -197,6 +203,11 @@ class IxIndexHandle {
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
+    // for bulk load
+    void bulk_load(IxExternalSorter *sorter, double fill_factor = IX_BULK_FILL_FACTOR);
+
+    bool is_empty();
+
     Iid lower_bound(const char *key);
 
     Iid upper_bound(const char *key);
@@ -205,11 +216,13 @@ class IxIndexHandle {
 
     Iid leaf_begin() const;
 
+    void set_optimistic(bool optimistic) { optimistic_ = optimistic; }
+
    private:
     // 辅助函数
     void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
 
-    bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
+    bool is_empty_root() const;
 
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
@@ -225,6 +238,17 @@ class IxIndexHandle {
 
     void maintain_child(IxNodeHandle *node, int child_idx);
 
+    // for latch crabbing
+    bool is_safe(IxNodeHandle *node, Operation operation, const char *key);
+
+    IxNodeHandle *find_leaf_optimistic(const char *key);
+
+    void release_ancestors(Transaction *transaction, bool *root_is_latched);
+
+    void release_latches(Transaction *transaction, bool *root_is_latched);
+
+    Iid leaf_iid(IxNodeHandle *leaf, int slot_no) const;
+
     // for index test
     Rid get_rid(const Iid &iid) const;
 };
\ No newline at end of file
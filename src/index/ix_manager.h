@@ -54,10 +54,16 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    /**
+     * @description: 创建索引文件并写入文件头和初始的叶子结点
+     * @param {string&} filename 表名
+     * @param {vector<ColMeta>&} index_cols 索引包含的字段
+     * @param {bool} compressed 索引文件是否按extent压缩存放，通常与表文件一致
+     */
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool compressed = false) {
         std::string ix_name = get_index_name(filename, index_cols);
         // Create index file
-        disk_manager_->create_file(ix_name);
+        disk_manager_->create_file(ix_name, compressed);
         // Open index file
         int fd = disk_manager_->open_file(ix_name);
 
@@ -11,21 +11,24 @@ See the Mulan PSL v2 for more details. */
 #include "ix_scan.h"
 
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个键值对，读取叶子结点时加读latch
  */
 void IxScan::next() {
     assert(!is_end());
     IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
+    node->page->rlatch();
     assert(node->is_leaf_page());
     assert(iid_.slot_no < node->get_size());
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
+    if (node->get_next_leaf() != IX_LEAF_HEADER_PAGE && iid_.slot_no == node->get_size()) {
         // go to next leaf
         iid_.slot_no = 0;
         iid_.page_no = node->get_next_leaf();
     }
+    node->page->runlatch();
+    bpm_->unpin_page(node->get_page_id(), false);
+    delete node;
 }
 
 Rid IxScan::rid() const {
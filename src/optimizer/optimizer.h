@@ -38,6 +38,9 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowTables>(query->parse)) {
             // show tables;
             return std::make_shared<OtherPlan>(T_ShowTable, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowBufferPool>(query->parse)) {
+            // show bufferpool;
+            return std::make_shared<OtherPlan>(T_ShowBufferPool, std::string());
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
@@ -53,6 +56,12 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::TxnRollback>(query->parse)) {
             // rollback;
             return std::make_shared<OtherPlan>(T_Transaction_rollback, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::LoadData>(query->parse)) {
+            // load data 'file' into table;
+            return std::make_shared<LoadDataPlan>(x->tab_name, x->file_name, x->binary);
+        } else if (auto x = std::dynamic_pointer_cast<ast::SetVariable>(query->parse)) {
+            // set variable = value;
+            return std::make_shared<OtherPlan>(T_SetVariable, x->name, query->values[0]);
         } else {
             return planner_->do_planner(query, context);
         }
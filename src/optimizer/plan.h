@@ -36,6 +36,9 @@ typedef enum PlanTag{
     T_Transaction_commit,
     T_Transaction_abort,
     T_Transaction_rollback,
+    T_SetVariable,
+    T_ShowBufferPool,
+    T_LoadData,
     T_SeqScan,
     T_IndexScan,
     T_NestLoop,
@@ -170,9 +173,10 @@ class DDLPlan : public Plan
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        TableOptions table_options_;    // create table的建表选项
 };
 
-// help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
+// help; show tables; show bufferpool; desc tables; begin; abort; commit; rollback; set语句对应的plan
 class OtherPlan : public Plan
 {
     public:
@@ -181,8 +185,25 @@ class OtherPlan : public Plan
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);            
         }
+        // set语句：tab_name_为变量名，value_为新的值
+        OtherPlan(PlanTag tag, std::string tab_name, Value value) : OtherPlan(tag, std::move(tab_name))
+        {
+            value_ = std::move(value);
+        }
         ~OtherPlan(){}
         std::string tab_name_;
+        Value value_;
+};
+
+// load data语句：tab_name_为表名，file_name_为导入的文件
+class LoadDataPlan : public OtherPlan
+{
+    public:
+        LoadDataPlan(std::string tab_name, std::string file_name, bool binary)
+            : OtherPlan(T_LoadData, std::move(tab_name)), file_name_(std::move(file_name)), binary_(binary) {}
+        ~LoadDataPlan(){}
+        std::string file_name_;
+        bool binary_;
 };
 
 class plannerInfo{
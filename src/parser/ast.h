@@ -43,6 +43,9 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+struct ShowBufferPool : public TreeNode {
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -58,8 +61,9 @@ struct TxnRollback : public TreeNode {
 struct TypeLen : public TreeNode {
     SvType type;
     int len;
+    bool var_len;   // VARCHAR：只存放实际长度
 
-    TypeLen(SvType type_, int len_) : type(type_), len(len_) {}
+    TypeLen(SvType type_, int len_, bool var_len_ = false) : type(type_), len(len_), var_len(var_len_) {}
 };
 
 struct Field : public TreeNode {
@@ -73,12 +77,23 @@ struct ColDef : public Field {
             col_name(std::move(col_name_)), type_len(std::move(type_len_)) {}
 };
 
+// 建表选项name = value，名称和取值都已转为大写
+struct TableOption : public TreeNode {
+    std::string name;
+    std::string value;
+
+    TableOption(std::string name_, std::string value_) : name(std::move(name_)), value(std::move(value_)) {}
+};
+
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    bool pax;          // LAYOUT = PAX：按列存放
+    bool compressed;   // COMPRESSION = LZ：按extent压缩存放
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_, bool pax_ = false,
+                bool compressed_ = false) :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)), pax(pax_), compressed(compressed_) {}
 };
 
 struct DropTable : public TreeNode {
@@ -141,6 +156,25 @@ struct Col : public Expr {
             tab_name(std::move(tab_name_)), col_name(std::move(col_name_)) {}
 };
 
+// SET variable = value，修改系统变量
+struct SetVariable : public TreeNode {
+    std::string name;
+    std::shared_ptr<Value> val;
+
+    SetVariable(std::string name_, std::shared_ptr<Value> val_) :
+            name(std::move(name_)), val(std::move(val_)) {}
+};
+
+// LOAD DATA 'file' INTO table [FORMAT = CSV | BINARY]
+struct LoadData : public TreeNode {
+    std::string file_name;
+    std::string tab_name;
+    bool binary;    // FORMAT = BINARY：文件由定长记录组成
+
+    LoadData(std::string file_name_, std::string tab_name_, bool binary_ = false) :
+            file_name(std::move(file_name_)), tab_name(std::move(tab_name_)), binary(binary_) {}
+};
+
 struct SetClause : public TreeNode {
     std::string col_name;
     std::shared_ptr<Value> val;
@@ -168,10 +202,10 @@ struct OrderBy : public TreeNode
 
 struct InsertStmt : public TreeNode {
     std::string tab_name;
-    std::vector<std::shared_ptr<Value>> vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> rows;  // VALUES (...), (...)中的每一行
 
-    InsertStmt(std::string tab_name_, std::vector<std::shared_ptr<Value>> vals_) :
-            tab_name(std::move(tab_name_)), vals(std::move(vals_)) {}
+    InsertStmt(std::string tab_name_, std::vector<std::vector<std::shared_ptr<Value>>> rows_) :
+            tab_name(std::move(tab_name_)), rows(std::move(rows_)) {}
 };
 
 struct DeleteStmt : public TreeNode {
@@ -246,6 +280,7 @@ struct SemValue {
 
     std::shared_ptr<Value> sv_val;
     std::vector<std::shared_ptr<Value>> sv_vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> sv_val_rows;
 
     std::shared_ptr<Col> sv_col;
     std::vector<std::shared_ptr<Col>> sv_cols;
@@ -257,6 +292,9 @@ struct SemValue {
     std::vector<std::shared_ptr<BinaryExpr>> sv_conds;
 
     std::shared_ptr<OrderBy> sv_orderby;
+
+    std::shared_ptr<TableOption> sv_table_option;
+    std::vector<std::shared_ptr<TableOption>> sv_table_options;
 };
 
 extern std::shared_ptr<ast::TreeNode> parse_tree;
@@ -79,6 +79,12 @@ private:
             std::cout << "HELP\n";
         } else if (auto x = std::dynamic_pointer_cast<ShowTables>(node)) {
             std::cout << "SHOW_TABLES\n";
+        } else if (auto x = std::dynamic_pointer_cast<ShowBufferPool>(node)) {
+            std::cout << "SHOW_BUFFERPOOL\n";
+        } else if (auto x = std::dynamic_pointer_cast<SetVariable>(node)) {
+            std::cout << "SET_VARIABLE\n";
+            print_val(x->name, offset);
+            print_node(x->val, offset);
         } else if (auto x = std::dynamic_pointer_cast<CreateTable>(node)) {
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
@@ -134,7 +140,9 @@ private:
         } else if (auto x = std::dynamic_pointer_cast<InsertStmt>(node)) {
             std::cout << "INSERT\n";
             print_val(x->tab_name, offset);
-            print_node_list(x->vals, offset);
+            for (auto &row : x->rows) {
+                print_node_list(row, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DeleteStmt>(node)) {
             std::cout << "DELETE\n";
             print_val(x->tab_name, offset);
@@ -1,6 +1,7 @@
 %{
 #include "ast.h"
 #include "yacc.tab.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
@@ -40,7 +41,8 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_expr> expr
 %type <sv_val> value
 %type <sv_vals> valueList
-%type <sv_str> tbName colName
+%type <sv_val_rows> valueRowList
+%type <sv_str> tbName colName loadData
 %type <sv_strs> tableList colNameList
 %type <sv_col> col
 %type <sv_cols> colList selector
@@ -50,6 +52,8 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_conds> whereClause optWhereClause
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_table_option> tableOption
+%type <sv_table_options> tableOptionList
 
 %%
 start:
@@ -106,6 +110,21 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW IDENTIFIER
+    {
+        // BUFFERPOOL不是保留字，按标识符解析，避免占用一个常见的表名或列名
+        std::string target = $2;
+        std::transform(target.begin(), target.end(), target.begin(), ::toupper);
+        if (target != "BUFFERPOOL") {
+            yyerror(&@2, "syntax error, unexpected IDENTIFIER, expecting TABLES or BUFFERPOOL");
+            YYERROR;
+        }
+        $$ = std::make_shared<ShowBufferPool>();
+    }
+    |   SET IDENTIFIER '=' value
+    {
+        $$ = std::make_shared<SetVariable>($2, $4);
+    }
     ;
 
 ddl:
@@ -113,6 +132,19 @@ ddl:
     {
         $$ = std::make_shared<CreateTable>($3, $5);
     }
+    |   CREATE TABLE tbName '(' fieldList ')' tableOptionList
+    {
+        bool pax = false;
+        bool compressed = false;
+        for (auto &option : $7) {
+            if (option->name == "LAYOUT") {
+                pax = option->value == "PAX";
+            } else {
+                compressed = option->value == "LZ";
+            }
+        }
+        $$ = std::make_shared<CreateTable>($3, $5, pax, compressed);
+    }
     |   DROP TABLE tbName
     {
         $$ = std::make_shared<DropTable>($3);
@@ -132,9 +164,29 @@ ddl:
     ;
 
 dml:
-        INSERT INTO tbName VALUES '(' valueList ')'
+        INSERT INTO tbName VALUES valueRowList
+    {
+        $$ = std::make_shared<InsertStmt>($3, $5);
+    }
+    |   loadData VALUE_STRING INTO tbName
     {
-        $$ = std::make_shared<InsertStmt>($3, $6);
+        $$ = std::make_shared<LoadData>($2, $4);
+    }
+    |   loadData VALUE_STRING INTO tbName IDENTIFIER '=' IDENTIFIER
+    {
+        std::string option = $5;
+        std::string format = $7;
+        std::transform(option.begin(), option.end(), option.begin(), ::toupper);
+        std::transform(format.begin(), format.end(), format.begin(), ::toupper);
+        if (option != "FORMAT") {
+            yyerror(&@5, "syntax error, unexpected IDENTIFIER, expecting FORMAT");
+            YYERROR;
+        }
+        if (format != "CSV" && format != "BINARY") {
+            yyerror(&@7, "syntax error, unexpected IDENTIFIER, expecting CSV or BINARY");
+            YYERROR;
+        }
+        $$ = std::make_shared<LoadData>($2, $4, format == "BINARY");
     }
     |   DELETE FROM tbName optWhereClause
     {
@@ -150,6 +202,43 @@ dml:
     }
     ;
 
+tableOptionList:
+        tableOption
+    {
+        $$ = std::vector<std::shared_ptr<TableOption>>{$1};
+    }
+    |   tableOptionList tableOption
+    {
+        $$.push_back($2);
+    }
+    ;
+
+tableOption:
+        IDENTIFIER '=' IDENTIFIER
+    {
+        // 建表选项LAYOUT = ROW | PAX和COMPRESSION = NONE | LZ，选项名和取值都不是保留字
+        std::string option = $1;
+        std::string value = $3;
+        std::transform(option.begin(), option.end(), option.begin(), ::toupper);
+        std::transform(value.begin(), value.end(), value.begin(), ::toupper);
+        if (option == "LAYOUT") {
+            if (value != "ROW" && value != "PAX") {
+                yyerror(&@3, "syntax error, unexpected IDENTIFIER, expecting ROW or PAX");
+                YYERROR;
+            }
+        } else if (option == "COMPRESSION") {
+            if (value != "NONE" && value != "LZ") {
+                yyerror(&@3, "syntax error, unexpected IDENTIFIER, expecting NONE or LZ");
+                YYERROR;
+            }
+        } else {
+            yyerror(&@1, "syntax error, unexpected IDENTIFIER, expecting LAYOUT or COMPRESSION");
+            YYERROR;
+        }
+        $$ = std::make_shared<TableOption>(option, value);
+    }
+    ;
+
 fieldList:
         field
     {
@@ -192,6 +281,17 @@ type:
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
     }
+    |   IDENTIFIER '(' VALUE_INT ')'
+    {
+        // VARCHAR不是保留字，按标识符解析
+        std::string type_name = $1;
+        std::transform(type_name.begin(), type_name.end(), type_name.begin(), ::toupper);
+        if (type_name != "VARCHAR") {
+            yyerror(&@1, "syntax error, unexpected IDENTIFIER, expecting INT, CHAR, FLOAT or VARCHAR");
+            YYERROR;
+        }
+        $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3, true);
+    }
     ;
 
 valueList:
@@ -205,6 +305,37 @@ valueList:
     }
     ;
 
+loadData:
+        IDENTIFIER IDENTIFIER
+    {
+        // LOAD和DATA不是保留字，按标识符解析
+        std::string load = $1;
+        std::string data = $2;
+        std::transform(load.begin(), load.end(), load.begin(), ::toupper);
+        std::transform(data.begin(), data.end(), data.begin(), ::toupper);
+        if (load != "LOAD") {
+            yyerror(&@1, "syntax error, unexpected IDENTIFIER");
+            YYERROR;
+        }
+        if (data != "DATA") {
+            yyerror(&@2, "syntax error, unexpected IDENTIFIER, expecting DATA");
+            YYERROR;
+        }
+        $$ = load;
+    }
+    ;
+
+valueRowList:
+        '(' valueList ')'
+    {
+        $$ = std::vector<std::vector<std::shared_ptr<Value>>>{$2};
+    }
+    |   valueRowList ',' '(' valueList ')'
+    {
+        $$.push_back($4);
+    }
+    ;
+
 value:
         VALUE_INT
     {
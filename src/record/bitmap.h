@@ -13,6 +13,11 @@ See the Mulan PSL v2 for more details. */
 #include <cinttypes>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITMAP_HAS_AVX2_PATH 1
+#endif
+
 static constexpr int BITMAP_WIDTH = 8;
 static constexpr unsigned BITMAP_HIGHEST_BIT = 0x80u;  // 128 (2^7)
 
@@ -37,19 +42,57 @@ class Bitmap {
      * @param max_n 要找的从起始地址开始的偏移为[curr+1,max_n)
      * @param curr 要找的从起始地址开始的偏移为[curr+1,max_n)
      * @return 找到了就返回偏移位置，没找到就返回max_n
+     * @note 每次取64位：位图在页面中按字节高位在前存放，按大端序读入后第i位就是字的第63-i位，
+     * 用clz得到第一个目标位；位图较长时先用AVX2跳过整段不含目标位的32字节
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
+        int pos = curr + 1;
+        if (pos >= max_n) {
+            return max_n;
+        }
+        const int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        // 找0时对读入的字取反，超出max_n的尾部字节按0读入，取反后可能命中，由最后的比较排除
+        const uint64_t flip = bit ? 0 : ~0ULL;
+        int byte = pos / 64 * 8;
+        uint64_t word = (load_word(bm, byte, num_bytes) ^ flip) & (~0ULL >> (pos % 64));
+        while (word == 0) {
+            byte += 8;
+            if (byte >= num_bytes) {
+                return max_n;
+            }
+#ifdef BITMAP_HAS_AVX2_PATH
+            if (num_bytes - byte >= AVX2_MIN_BYTES && has_avx2()) {
+                byte = skip_avx2(bm, byte, num_bytes, bit);
+                if (byte >= num_bytes) {
+                    return max_n;
+                }
             }
+#endif
+            word = load_word(bm, byte, num_bytes) ^ flip;
         }
-        return max_n;
+        int i = byte * BITMAP_WIDTH + __builtin_clzll(word);
+        return i < max_n ? i : max_n;
     }
 
     // 找第一个为0 or 1的位
     static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
 
+    // 统计[0,max_n)中为1的位数
+    static int count(const char *bm, int max_n) {
+        const int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        int result = 0;
+        int byte = 0;
+        for (; (byte + 8) * BITMAP_WIDTH <= max_n; byte += 8) {
+            result += __builtin_popcountll(load_word(bm, byte, num_bytes));
+        }
+        if (byte * BITMAP_WIDTH < max_n) {
+            // 只保留max_n之前的位，位图中max_n之后的填充位不计入
+            int tail_bits = max_n - byte * BITMAP_WIDTH;
+            result += __builtin_popcountll(load_word(bm, byte, num_bytes) & ~(~0ULL >> tail_bits));
+        }
+        return result;
+    }
+
     // for example:
     // rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page,
     // rid_.slot_no); int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
@@ -58,4 +101,43 @@ class Bitmap {
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
+
+    // 按大端序读入从第byte个字节开始的8个字节，不读num_bytes之后的字节，缺少的部分补0
+    static uint64_t load_word(const char *bm, int byte, int num_bytes) {
+        uint64_t word = 0;
+        if (byte + 8 <= num_bytes) {
+            memcpy(&word, bm + byte, sizeof(word));
+            return __builtin_bswap64(word);
+        }
+        for (int i = 0; byte + i < num_bytes; i++) {
+            word |= static_cast<uint64_t>(static_cast<unsigned char>(bm[byte + i])) << (56 - 8 * i);
+        }
+        return word;
+    }
+
+#ifdef BITMAP_HAS_AVX2_PATH
+    static constexpr int AVX2_MIN_BYTES = 64;  // 剩余部分至少两个32字节块时才使用AVX2
+
+    static bool has_avx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    /**
+     * @return 从第byte个字节开始，跳过所有位都不等于bit的32字节块后的字节位置，
+     * 不跨过num_bytes之前最后一个完整的32字节块
+     */
+    __attribute__((target("avx2"))) static int skip_avx2(const char *bm, int byte, int num_bytes, bool bit) {
+        const __m256i ones = _mm256_set1_epi8(-1);
+        for (; byte + 32 <= num_bytes; byte += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bm + byte));
+            // 找1时跳过全0的块，找0时跳过全1的块
+            bool uniform = bit ? _mm256_testz_si256(v, v) : _mm256_testc_si256(v, ones);
+            if (!uniform) {
+                break;
+            }
+        }
+        return byte;
+    }
+#endif
 };
@@ -10,63 +10,96 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/arena.h"
 #include "defs.h"
 #include "storage/buffer_pool_manager.h"
+#include "storage/page_guard.h"
 
 constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_MAX_SLOTTED_RECORD_SIZE = 32768;  // slotted格式的表中记录的最大长度（各字段按声明的最大长度计算）
+constexpr int RM_MAX_FIELDS = 64;
+constexpr int RM_PAGE_LATCH_STRIPES = 64;  // 修改记录时按页号取模使用的页面latch个数
+
+/* 表数据文件的页面格式，建表时选定 */
+enum RmPageFormat {
+    RM_PAGE_FORMAT_FIXED = 0,   // 定长slot + bitmap，旧版本创建的表文件都是这种格式
+    RM_PAGE_FORMAT_SLOTTED = 1, // slot数组 + 从页尾向前增长的变长记录，变长字段只存放实际长度
+    RM_PAGE_FORMAT_PAX = 2      // 定长slot + bitmap，但每个页面中同一列的值连续存放（minipage）
+};
+
+/* 记录中的一个字段，即record_size中从offset开始的len字节 */
+struct RmField {
+    int offset;
+    int len;
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
-    int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
+    int record_size;            // 表中每条记录的大小（变长字段按最大长度计算），初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
     int num_records_per_page;   // 每个页面最多能存储的元组个数
-    int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
-    int bitmap_size;            // 每个页面bitmap大小
+    int first_free_page_no;     // 已不再使用，空闲页面由RmFreeSpaceMap记录；保留该字段以兼容已有的表文件，始终为-1
+    int bitmap_size;            // 每个页面bitmap大小，slotted格式中为0
+    // 以下字段在加入slotted格式时新增，旧版本的表文件中没有这些字段，读入时为0（即RM_PAGE_FORMAT_FIXED）
+    int page_format;            // RmPageFormat
+    int num_fields;             // fields的个数
+    // 按offset递增排列。slotted格式中为变长字段，值以'\0'结束或填满；PAX格式中为覆盖整条记录的所有列
+    RmField fields[RM_MAX_FIELDS];
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
 struct RmPageHdr {
-    int next_free_page_no;  // 当前页面满了之后，下一个包含空闲空间的页面号（初始化为-1）
+    int next_free_page_no;  // 已不再使用，保留该字段以兼容已有的表文件，始终为-1
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
-/* 表中的记录 */
+/* 表中的记录。不超过RM_RECORD_INLINE_SIZE的记录直接存放在对象内部，更大的记录在堆上分配，
+   也可以由调用者提供的Arena分配，此时内存随Arena一起释放 */
 struct RmRecord {
-    char* data;  // 记录的数据
-    int size;    // 记录的大小
-    bool allocated_ = false;    // 是否已经为数据分配空间
+    char* data = nullptr;  // 记录的数据
+    int size = 0;          // 记录的大小
+    bool allocated_ = false;    // data是否由new[]分配，需要由RmRecord释放
 
     RmRecord() = default;
 
-    RmRecord(const RmRecord& other) {
-        size = other.size;
-        data = new char[size];
-        memcpy(data, other.data, size);
-        allocated_ = true;
-    };
+    RmRecord(const RmRecord& other) { assign(other.data, other.size); }
+
+    RmRecord(RmRecord&& other) noexcept { take(other); }
 
     RmRecord &operator=(const RmRecord& other) {
-        size = other.size;
-        data = new char[size];
-        memcpy(data, other.data, size);
-        allocated_ = true;
+        if (this != &other) {
+            assign(other.data, other.size);
+        }
         return *this;
-    };
+    }
 
-    RmRecord(int size_) {
-        size = size_;
-        data = new char[size_];
-        allocated_ = true;
+    RmRecord &operator=(RmRecord&& other) noexcept {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
     }
 
-    RmRecord(int size_, char* data_) {
-        size = size_;
-        data = new char[size_];
-        memcpy(data, data_, size_);
-        allocated_ = true;
+    RmRecord(int size_) { reserve(size_); }
+
+    RmRecord(int size_, const char* data_) { assign(data_, size_); }
+
+    /**
+     * @description: 在arena中为记录分配空间，记录本身不释放该空间；记录足够小时仍存放在对象内部
+     * @param {int} size_ 记录的大小
+     * @param {Arena*} arena 分配记录数据的arena，为nullptr时在堆上分配
+     */
+    RmRecord(int size_, Arena* arena) {
+        if (arena == nullptr || size_ <= RM_RECORD_INLINE_SIZE) {
+            reserve(size_);
+        } else {
+            data = arena->allocate(size_);
+            size = size_;
+        }
     }
 
     void SetData(char* data_) {
@@ -74,19 +107,99 @@ struct RmRecord {
     }
 
     void Deserialize(const char* data_) {
-        size = *reinterpret_cast<const int*>(data_);
-        if(allocated_) {
-            delete[] data;
-        }
-        data = new char[size];
-        memcpy(data, data_ + sizeof(int), size);
+        assign(data_ + sizeof(int), *reinterpret_cast<const int*>(data_));
     }
 
-    ~RmRecord() {
-        if(allocated_) {
+    ~RmRecord() { release(); }
+
+   private:
+    alignas(8) char inline_data_[RM_RECORD_INLINE_SIZE];
+
+    bool is_inline() const { return data == inline_data_; }
+
+    void release() {
+        if (allocated_) {
             delete[] data;
         }
         allocated_ = false;
         data = nullptr;
+        size = 0;
+    }
+
+    // 准备size_字节的空间，已有的空间是自己持有且大小相同时直接复用
+    void reserve(int size_) {
+        if (data != nullptr && size == size_ && (allocated_ || is_inline())) {
+            return;
+        }
+        release();
+        size = size_;
+        if (size_ <= RM_RECORD_INLINE_SIZE) {
+            data = inline_data_;
+        } else {
+            data = new char[size_];
+            allocated_ = true;
+        }
+    }
+
+    void assign(const char* data_, int size_) {
+        reserve(size_);
+        if (size_ > 0) {
+            memcpy(data, data_, size_);
+        }
     }
+
+    // 接管other的数据，内部存放的数据只能复制；调用前自己不能持有数据
+    void take(RmRecord& other) {
+        size = other.size;
+        allocated_ = other.allocated_;
+        if (other.is_inline()) {
+            memcpy(inline_data_, other.inline_data_, other.size);
+            data = inline_data_;
+        } else {
+            data = other.data;
+        }
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated_ = false;
+    }
+};
+
+/**
+ * @description: 记录的只读视图，不复制记录的数据。
+ * data指向缓冲池中的页面时由视图持有该页面的pin，视图析构后页面才能被换出；
+ * 也可以持有一个物化的RmRecord，供不能直接指向页面的算子（如连接）返回结果
+ */
+class RecordView {
+   public:
+    RecordView() = default;
+
+    RecordView(const char *data, int size, PageGuard page_guard)
+        : data_(data), size_(size), page_guard_(std::move(page_guard)) {}
+
+    explicit RecordView(std::unique_ptr<RmRecord> record) : record_(std::move(record)) {
+        if (record_ != nullptr) {
+            data_ = record_->data;
+            size_ = record_->size;
+        }
+    }
+
+    const char *data() const { return data_; }
+
+    int size() const { return size_; }
+
+    explicit operator bool() const { return data_ != nullptr; }
+
+    // 复制出一条记录，用于结果离开算子树或需要在视图失效后继续使用的场合
+    std::unique_ptr<RmRecord> to_record() const {
+        if (data_ == nullptr) {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(size_, data_);
+    }
+
+   private:
+    const char *data_ = nullptr;
+    int size_ = 0;
+    PageGuard page_guard_;
+    std::unique_ptr<RmRecord> record_;
 };
@@ -10,31 +10,46 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
  * @param {Context*} context
- * @return {unique_ptr<RmRecord>} rid对应的记录对象指针
+ * @return {unique_ptr<RmRecord>} rid对应的记录对象指针，记录不存在时返回nullptr
  */
 std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* context) const {
-    // Todo:
-    // 1. 获取指定记录所在的page handle
-    // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
+    return get_record_view(rid, context).to_record();
+}
+
+/**
+ * @description: 获取当前表中记录号为rid的记录的只读视图，不复制记录
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {Context*} context
+ * @return {RecordView} 指向页面中记录的视图，持有页面的pin；记录不存在时返回空视图
+ */
+RecordView RmFileHandle::get_record_view(const Rid& rid, Context* context) const {
+    if (is_slotted()) {
+        return get_slotted_record_view(rid);
+    }
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-    
-    // Check if the slot is valid
+    PageGuard page_guard(buffer_pool_manager_, page_handle.page);
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        return nullptr;
+        return RecordView();
     }
-    
-    // Calculate the offset of the record in the page
-    char* record_pos = page_handle.get_slot(rid.slot_no);
-    
-    // Create a new RmRecord and copy the data
-    char* data = new char[file_hdr_.record_size];
-    memcpy(data, record_pos, file_hdr_.record_size);
-    
-    return std::make_unique<RmRecord>(file_hdr_.record_size, data);
+    if (is_pax()) {
+        // PAX格式中记录的各列不连续，只能拼出一份副本
+        auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+        page_handle.read_record(rid.slot_no, record->data);
+        return RecordView(std::move(record));
+    }
+    return RecordView(page_handle.get_slot(rid.slot_no), file_hdr_.record_size, std::move(page_guard));
 }
 
 /**
@@ -44,34 +59,164 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
  * @return {Rid} 插入的记录的记录号（位置）
  */
 Rid RmFileHandle::insert_record(char* buf, Context* context) {
-    // Todo:
-    // 1. 获取当前未满的page handle
-    // 2. 在page handle中找到空闲slot位置
-    // 3. 将buf复制到空闲slot位置
-    // 4. 更新page_handle.page_hdr中的数据结构
-    // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
-    RmPageHandle page_handle = create_page_handle();
-    
-    // Find the first free slot in the page
+    // 每个线程从自己上次在本表中插入的页面开始查找未满的页面，第一次插入时按线程号散开，
+    // 使并发的插入者落在不同的页面上；页面latch被占用时换下一个未满的页面，都被占用时创建新页面
+    static thread_local std::unordered_map<int, int> hint_page_nos;  // 以表文件的fd为键
+    int &hint_page_no = hint_page_nos.try_emplace(fd_, -1).first->second;
+    if (hint_page_no < 0) {
+        hint_page_no = static_cast<int>(std::hash<std::thread::id>()(std::this_thread::get_id()) % INT_MAX);
+    }
+    int page_no = fsm_->find_free_page(hint_page_no % std::max(file_hdr_.num_pages, 1));
+    int first_busy_page_no = RM_NO_PAGE;
+    while (true) {
+        std::unique_lock<std::mutex> lock;
+        Page* page;
+        bool is_new_page = page_no == RM_NO_PAGE || page_no == first_busy_page_no;
+        if (is_new_page) {
+            page = create_new_page_handle().page;
+            page_no = page->get_page_id().page_no;
+            lock = std::unique_lock<std::mutex>(page_latch(page_no));
+        } else {
+            lock = std::unique_lock<std::mutex>(page_latch(page_no), std::try_to_lock);
+            if (!lock.owns_lock()) {
+                if (first_busy_page_no == RM_NO_PAGE) {
+                    first_busy_page_no = page_no;
+                }
+                page_no = fsm_->find_free_page(page_no + 1);
+                continue;
+            }
+            page = fetch_page_handle(page_no).page;
+        }
+
+        int slot_no = is_slotted() ? insert_into_slotted_page(page, buf) : insert_into_page(page, buf);
+        if (slot_no < 0) {
+            // FSM中的标记过时（例如崩溃前未写回），改正后继续查找
+            fsm_->set_free(page_no, false);
+            buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+            page_no = fsm_->find_free_page(page_no + 1);
+            continue;
+        }
+
+        if (!page_has_free_space(page)) {
+            fsm_->set_free(page_no, false);
+        } else if (is_new_page) {
+            fsm_->set_free(page_no, true);
+        }
+        hint_page_no = page_no;
+
+        Rid rid{page_no, slot_no};
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+        return rid;
+    }
+}
+
+/**
+ * @description: 批量插入记录，一次填满一个页面：每个页面只获取一次latch和pin、只更新一次FSM，
+ * 页面中的空闲slot从上一条记录的位置继续查找。先填充FSM中未满的页面，再顺序填充新页面
+ * @param {char* const*} bufs 要插入的记录
+ * @param {int} num_records 记录条数
+ * @param {Rid*} rids 存放每条记录的记录号，与bufs一一对应
+ * @param {Context*} context
+ */
+void RmFileHandle::insert_records(char* const* bufs, int num_records, Rid* rids, Context* context) {
+    int done = 0;
+    int page_no = num_records > 0 ? fsm_->find_free_page(0) : RM_NO_PAGE;
+    while (done < num_records) {
+        std::unique_lock<std::mutex> lock;
+        Page* page;
+        bool is_new_page = page_no == RM_NO_PAGE;
+        if (is_new_page) {
+            page = create_new_page_handle().page;
+            page_no = page->get_page_id().page_no;
+            lock = std::unique_lock<std::mutex>(page_latch(page_no));
+        } else {
+            lock = std::unique_lock<std::mutex>(page_latch(page_no));
+            page = fetch_page_handle(page_no).page;
+        }
+
+        int filled = fill_page(page, bufs + done, num_records - done, rids + done);
+        done += filled;
+        // 没有放下任何记录说明FSM中的标记过时，同样标为已满
+        bool has_free = filled > 0 && page_has_free_space(page);
+        if (!has_free) {
+            fsm_->set_free(page_no, false);
+        } else if (is_new_page) {
+            fsm_->set_free(page_no, true);
+        }
+        buffer_pool_manager_->unpin_page(page->get_page_id(), filled > 0);
+        lock.unlock();
+        if (done < num_records) {
+            page_no = fsm_->find_free_page(page_no + 1);
+        }
+    }
+}
+
+/**
+ * @description: 把从bufs开始的记录依次放入页面，直到页面放满或记录用完，调用者持有页面的latch
+ * @return {int} 放入的记录条数
+ */
+int RmFileHandle::fill_page(Page* page, char* const* bufs, int num_records, Rid* rids) {
+    int page_no = page->get_page_id().page_no;
+    int filled = 0;
+    if (is_slotted()) {
+        while (filled < num_records) {
+            int slot_no = insert_into_slotted_page(page, bufs[filled]);
+            if (slot_no < 0) {
+                break;
+            }
+            rids[filled++] = Rid{page_no, slot_no};
+        }
+        return filled;
+    }
+    RmPageHandle page_handle(&file_hdr_, page);
+    int slot_no = -1;
+    while (filled < num_records) {
+        slot_no = Bitmap::next_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page, slot_no);
+        if (slot_no >= file_hdr_.num_records_per_page) {
+            break;
+        }
+        page_handle.write_record(slot_no, bufs[filled]);
+        Bitmap::set(page_handle.bitmap, slot_no);
+        rids[filled++] = Rid{page_no, slot_no};
+    }
+    page_handle.page_hdr->num_records += filled;
+    return filled;
+}
+
+/**
+ * @description: 把记录放入定长格式或PAX格式页面的空闲slot中，调用者持有页面的latch
+ * @return {int} 记录的slot_no，页面已满时返回-1
+ */
+int RmFileHandle::insert_into_page(Page* page, const char* buf) {
+    RmPageHandle page_handle(&file_hdr_, page);
     int free_slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
-    if (free_slot_no == -1) {
-        throw InternalError("No free slot found in page");
+    if (free_slot_no >= file_hdr_.num_records_per_page) {
+        return -1;
     }
-    
-    // Copy the record to the free slot
-    char* slot = page_handle.get_slot(free_slot_no);
-    memcpy(slot, buf, file_hdr_.record_size);
-    
-    // Set the bitmap to indicate the slot is now used
+    page_handle.write_record(free_slot_no, buf);
     Bitmap::set(page_handle.bitmap, free_slot_no);
     page_handle.page_hdr->num_records++;
-    
-    // If page becomes full after insertion, update the free page list
-    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+    return free_slot_no;
+}
+
+/**
+ * @description: 编码记录并放入slotted格式的数据页，过长的记录先写入溢出页，页内只存放RmOverflowRef。
+ * 调用者持有页面的latch
+ * @return {int} 记录的slot_no，页面空间不足时返回-1
+ */
+int RmFileHandle::insert_into_slotted_page(Page* page, const char* buf) {
+    RmSlottedPage slotted_page(page);
+    char* encoded = encode_buffer();
+    int len = encode_record(buf, encoded);
+    if (len <= RmSlottedPage::MAX_INLINE_LEN) {
+        return slotted_page.insert(encoded, len, false);
     }
-    
-    return Rid{page_handle.page->get_page_id().page_no, free_slot_no};
+    // 确认页面放得下引用之后再写溢出页，避免写出无人引用的溢出页
+    if (!slotted_page.can_insert(sizeof(RmOverflowRef))) {
+        return -1;
+    }
+    RmOverflowRef ref{len, write_overflow(encoded, len)};
+    return slotted_page.insert(reinterpret_cast<const char*>(&ref), sizeof(ref), true);
 }
 
 /**
@@ -92,11 +237,18 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新page_handle.page_hdr中的数据结构
-    // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
+    // 注意考虑删除一条记录后页面未满的情况，需要在FSM中把页面标为未满
+    if (is_slotted()) {
+        // 溢出页在释放数据页的latch之后回收，同一时刻只持有一个页面latch
+        free_overflow(delete_slotted_record(rid));
+        return;
+    }
+    std::scoped_lock lock(page_latch(rid.page_no));
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
     
     // Check if the slot is valid
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
     
@@ -104,10 +256,11 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     Bitmap::reset(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records--;
     
-    // If this was a full page before deletion, it needs to be added to free page list
+    // If this was a full page before deletion, mark it as having free space
     if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page - 1) {
-        release_page_handle(page_handle);
+        fsm_->set_free(rid.page_no, true);
     }
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
 
@@ -121,16 +274,22 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新记录
+    if (is_slotted()) {
+        free_overflow(update_slotted_record(rid, buf));
+        return;
+    }
+    std::scoped_lock lock(page_latch(rid.page_no));
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
     
     // Check if the slot is valid
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
     
     // Update the record data
-    char* slot = page_handle.get_slot(rid.slot_no);
-    memcpy(slot, buf, file_hdr_.record_size);
+    page_handle.write_record(rid.slot_no, buf);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
 /**
@@ -158,7 +317,7 @@ RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
 }
 
 /**
- * @description: 创建一个新的page handle
+ * @description: 创建一个新的page handle，新页面不链入任何空闲链表，由调用者决定是否在FSM中标为未满
  * @return {RmPageHandle} 新的PageHandle
  */
 RmPageHandle RmFileHandle::create_new_page_handle() {
@@ -166,58 +325,276 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
     // 1.使用缓冲池来创建一个新page
     // 2.更新page handle中的相关信息
     // 3.更新file_hdr_
+    return RmPageHandle(&file_hdr_, new_page(RmSlottedPage::DATA_PAGE));
+}
+
+/**
+ * @description: 分配并初始化一个新页面，页面初始化完成后才计入file_hdr_.num_pages
+ * @param {int} slotted_page_type slotted格式中新页面的类型，定长格式忽略该参数
+ * @return {Page*} 新页面，由调用者unpin
+ */
+Page* RmFileHandle::new_page(int slotted_page_type) {
+    std::scoped_lock lock(new_page_latch_);
     PageId new_page_id = {fd_, file_hdr_.num_pages};
     Page* page = buffer_pool_manager_->new_page(&new_page_id);
     if (page == nullptr) {
         throw InternalError("Failed to create new page");
     }
-    
-    // Initialize the page header and bitmap
-    RmPageHandle page_handle(&file_hdr_, page);
-    page_handle.page_hdr->num_records = 0;
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    memset(page_handle.bitmap, 0, file_hdr_.bitmap_size);
-    
+
+    if (is_slotted()) {
+        RmSlottedPage(page).init(slotted_page_type);
+    } else {
+        // Initialize the page header and bitmap
+        RmPageHandle page_handle(&file_hdr_, page);
+        page_handle.page_hdr->num_records = 0;
+        page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+        memset(page_handle.bitmap, 0, file_hdr_.bitmap_size);
+    }
+
     // Update file header
-    file_hdr_.first_free_page_no = file_hdr_.num_pages;
     file_hdr_.num_pages++;
-    
-    return page_handle;
+
+    return page;
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
- *
- * @return RmPageHandle 返回生成的空闲page handle
- * @note pin the page, remember to unpin it outside!
+ * @description: 判断页面能否再插入记录，决定页面在FSM中的标记。
+ * slotted格式的数据页要能放下最长的页内记录，溢出页总是标为已满
  */
-RmPageHandle RmFileHandle::create_page_handle() {
-    // Todo:
-    // 1. 判断file_hdr_中是否还有空闲页
-    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
-    //     1.2 有空闲页：直接获取第一个空闲页
-    // 2. 生成page handle并返回给上层
-    if (file_hdr_.first_free_page_no == -1) {
-        // No free pages available, create a new one
-        return create_new_page_handle();
+bool RmFileHandle::page_has_free_space(Page* page) const {
+    if (is_slotted()) {
+        RmSlottedPage slotted_page(page);
+        return slotted_page.is_data_page() && slotted_page.free_space() >= slotted_free_threshold_;
     }
-    
-    // Get the first free page
-    return fetch_page_handle(file_hdr_.first_free_page_no);
+    RmPageHandle page_handle(&file_hdr_, page);
+    return page_handle.page_hdr->num_records < file_hdr_.num_records_per_page;
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: FSM文件丢失时（例如旧版本创建的表），扫描表文件中的每个页面，重新标记未满的页面
  */
-void RmFileHandle::release_page_handle(RmPageHandle& page_handle) {
-    // Todo:
-    // 当page从已满变成未满，考虑如何更新：
-    // 1. page_handle.page_hdr->next_free_page_no
-    // 2. file_hdr_.first_free_page_no
-    
-    // Update the page's next free page pointer to current first free page
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    
-    // Update the file header's first free page to this page
-    file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
+void RmFileHandle::rebuild_free_space_map() {
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+        RmPageHandle page_handle = fetch_page_handle(page_no);
+        fsm_->set_free(page_no, page_has_free_space(page_handle.page));
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    }
+}
+
+/**
+ * @description: 读取slotted格式页面中的记录，解码为定长的记录
+ * @return {RecordView} 持有解码后记录的视图；记录不存在时返回空视图
+ */
+RecordView RmFileHandle::get_slotted_record_view(const Rid& rid) const {
+    std::scoped_lock lock(page_latch(rid.page_no));
+    PageGuard page_guard(buffer_pool_manager_, fetch_page_handle(rid.page_no).page);
+    RmSlottedPage slotted_page(page_guard.get());
+    if (!slotted_page.is_data_page() || !slotted_page.is_used(rid.slot_no)) {
+        return RecordView();
+    }
+    auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+    int len;
+    const char* stored = slotted_page.get(rid.slot_no, &len);
+    if (slotted_page.is_overflow(rid.slot_no)) {
+        char* encoded = encode_buffer();
+        read_overflow(*reinterpret_cast<const RmOverflowRef*>(stored), encoded);
+        stored = encoded;
+    }
+    decode_record(stored, record->data);
+    return RecordView(std::move(record));
+}
+
+/**
+ * @description: 删除slotted格式页面中的记录，页面数据区随即压缩
+ * @return {int} 记录原来使用的第一个溢出页，没有时返回RM_NO_PAGE，由调用者在释放latch后回收
+ */
+int RmFileHandle::delete_slotted_record(const Rid& rid) {
+    std::scoped_lock lock(page_latch(rid.page_no));
+    PageGuard page_guard(buffer_pool_manager_, fetch_page_handle(rid.page_no).page);
+    RmSlottedPage slotted_page(page_guard.get());
+    if (!slotted_page.is_data_page() || !slotted_page.is_used(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    int overflow_page_no = RM_NO_PAGE;
+    if (slotted_page.is_overflow(rid.slot_no)) {
+        int len;
+        overflow_page_no = reinterpret_cast<const RmOverflowRef*>(slotted_page.get(rid.slot_no, &len))->first_page_no;
+    }
+    bool had_free_space = page_has_free_space(page_guard.get());
+    slotted_page.erase(rid.slot_no);
+    page_guard.mark_dirty();
+    if (!had_free_space && page_has_free_space(page_guard.get())) {
+        fsm_->set_free(rid.page_no, true);
+    }
+    return overflow_page_no;
+}
+
+/**
+ * @description: 更新slotted格式页面中的记录，slot_no保持不变。
+ * 新记录在页内放不下时改存到溢出页中，页内只保留引用，因此更新总能在原位置完成
+ * @return {int} 旧记录使用的第一个溢出页，没有时返回RM_NO_PAGE，由调用者在释放latch后回收
+ */
+int RmFileHandle::update_slotted_record(const Rid& rid, const char* buf) {
+    std::scoped_lock lock(page_latch(rid.page_no));
+    PageGuard page_guard(buffer_pool_manager_, fetch_page_handle(rid.page_no).page);
+    RmSlottedPage slotted_page(page_guard.get());
+    if (!slotted_page.is_data_page() || !slotted_page.is_used(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    int old_overflow_page_no = RM_NO_PAGE;
+    if (slotted_page.is_overflow(rid.slot_no)) {
+        int old_len;
+        const char* stored = slotted_page.get(rid.slot_no, &old_len);
+        old_overflow_page_no = reinterpret_cast<const RmOverflowRef*>(stored)->first_page_no;
+    }
+    bool had_free_space = page_has_free_space(page_guard.get());
+
+    char* encoded = encode_buffer();
+    int len = encode_record(buf, encoded);
+    if (len > RmSlottedPage::MAX_INLINE_LEN || !slotted_page.update(rid.slot_no, encoded, len, false)) {
+        // 页内记录至少有MIN_RECORD_LEN字节，换成引用一定放得下
+        RmOverflowRef ref{len, write_overflow(encoded, len)};
+        bool updated = slotted_page.update(rid.slot_no, reinterpret_cast<const char*>(&ref), sizeof(ref), true);
+        assert(updated);
+        (void)updated;
+    }
+    page_guard.mark_dirty();
+
+    bool has_free_space = page_has_free_space(page_guard.get());
+    if (has_free_space != had_free_space) {
+        fsm_->set_free(rid.page_no, has_free_space);
+    }
+    return old_overflow_page_no;
+}
+
+/**
+ * @description: 当前线程用于编码记录的缓冲区，长度不小于max_encoded_len_
+ */
+char* RmFileHandle::encode_buffer() const {
+    static thread_local std::vector<char> buffer;
+    if ((int)buffer.size() < max_encoded_len_) {
+        buffer.resize(max_encoded_len_);
+    }
+    return buffer.data();
+}
+
+/**
+ * @description: 把定长记录编码为slotted格式页面中存放的形式：先是去掉变长字段后的定长部分，
+ * 然后依次是每个变长字段的实际长度（2字节）和内容，内容截止到第一个'\0'。不足MIN_RECORD_LEN时补0
+ * @return {int} 编码后的长度
+ * @param {char*} buf 定长记录，长度为record_size
+ * @param {char*} out 编码结果，长度至少为max_encoded_len_
+ */
+int RmFileHandle::encode_record(const char* buf, char* out) const {
+    char* dst = out;
+    int pos = 0;
+    for (int i = 0; i < file_hdr_.num_fields; i++) {
+        const RmField& field = file_hdr_.fields[i];
+        memcpy(dst, buf + pos, field.offset - pos);
+        dst += field.offset - pos;
+        pos = field.offset + field.len;
+    }
+    memcpy(dst, buf + pos, file_hdr_.record_size - pos);
+    dst += file_hdr_.record_size - pos;
+    for (int i = 0; i < file_hdr_.num_fields; i++) {
+        const RmField& field = file_hdr_.fields[i];
+        uint16_t len = static_cast<uint16_t>(strnlen(buf + field.offset, field.len));
+        memcpy(dst, &len, sizeof(len));
+        memcpy(dst + sizeof(len), buf + field.offset, len);
+        dst += sizeof(len) + len;
+    }
+    int encoded_len = static_cast<int>(dst - out);
+    if (encoded_len < RmSlottedPage::MIN_RECORD_LEN) {
+        memset(dst, 0, RmSlottedPage::MIN_RECORD_LEN - encoded_len);
+        encoded_len = RmSlottedPage::MIN_RECORD_LEN;
+    }
+    return encoded_len;
+}
+
+/**
+ * @description: encode_record的逆过程，变长字段超出实际长度的部分填0
+ * @param {char*} stored 编码后的记录
+ * @param {char*} out 解码结果，长度为record_size
+ */
+void RmFileHandle::decode_record(const char* stored, char* out) const {
+    const char* src = stored;
+    int pos = 0;
+    for (int i = 0; i < file_hdr_.num_fields; i++) {
+        const RmField& field = file_hdr_.fields[i];
+        memcpy(out + pos, src, field.offset - pos);
+        src += field.offset - pos;
+        pos = field.offset + field.len;
+    }
+    memcpy(out + pos, src, file_hdr_.record_size - pos);
+    src += file_hdr_.record_size - pos;
+    for (int i = 0; i < file_hdr_.num_fields; i++) {
+        const RmField& field = file_hdr_.fields[i];
+        uint16_t len;
+        memcpy(&len, src, sizeof(len));
+        memcpy(out + field.offset, src + sizeof(len), len);
+        memset(out + field.offset + len, 0, field.len - len);
+        src += sizeof(len) + len;
+    }
+}
+
+/**
+ * @description: 把编码后的记录写入新分配的一串溢出页。溢出页不在FSM中标为未满，
+ * 扫描时被跳过，只能经由引用它的记录访问
+ * @return {int} 第一个溢出页的页号
+ */
+int RmFileHandle::write_overflow(const char* data, int len) {
+    int first_page_no = RM_NO_PAGE;
+    Page* prev = nullptr;
+    for (int written = 0; written < len; written += RmSlottedPage::OVERFLOW_CAPACITY) {
+        Page* page = new_page(RmSlottedPage::OVERFLOW_PAGE);
+        RmSlottedPage overflow_page(page);
+        int chunk = std::min(len - written, RmSlottedPage::OVERFLOW_CAPACITY);
+        memcpy(overflow_page.overflow_data(), data + written, chunk);
+        overflow_page.hdr()->overflow_len = chunk;
+        if (prev == nullptr) {
+            first_page_no = page->get_page_id().page_no;
+        } else {
+            RmSlottedPage(prev).hdr()->next_overflow_page_no = page->get_page_id().page_no;
+            buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+        }
+        prev = page;
+    }
+    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    return first_page_no;
+}
+
+/**
+ * @description: 读出溢出记录的全部内容，调用者持有引用它的数据页的latch
+ * @param {RmOverflowRef&} ref 数据页中存放的引用
+ * @param {char*} out 存放结果，长度至少为ref.total_len
+ */
+void RmFileHandle::read_overflow(const RmOverflowRef& ref, char* out) const {
+    int page_no = ref.first_page_no;
+    for (int read = 0; read < ref.total_len;) {
+        PageGuard page_guard(buffer_pool_manager_, fetch_page_handle(page_no).page);
+        RmSlottedPage overflow_page(page_guard.get());
+        memcpy(out + read, overflow_page.overflow_data(), overflow_page.hdr()->overflow_len);
+        read += overflow_page.hdr()->overflow_len;
+        page_no = overflow_page.hdr()->next_overflow_page_no;
+    }
+}
+
+/**
+ * @description: 回收一串溢出页，把它们改为空的数据页并在FSM中标为未满。
+ * 引用它们的记录已被删除或替换，调用时不能持有其他页面的latch
+ * @param {int} first_page_no 第一个溢出页，为RM_NO_PAGE时什么也不做
+ */
+void RmFileHandle::free_overflow(int first_page_no) {
+    int page_no = first_page_no;
+    while (page_no != RM_NO_PAGE) {
+        std::unique_lock<std::mutex> lock(page_latch(page_no));
+        PageGuard page_guard(buffer_pool_manager_, fetch_page_handle(page_no).page);
+        RmSlottedPage overflow_page(page_guard.get());
+        int next_page_no = overflow_page.hdr()->next_overflow_page_no;
+        overflow_page.init(RmSlottedPage::DATA_PAGE);
+        page_guard.mark_dirty();
+        lock.unlock();
+        fsm_->set_free(page_no, true);
+        page_no = next_page_no;
+    }
 }
\ No newline at end of file
@@ -12,11 +12,15 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_free_space_map.h"
+#include "rm_slotted_page.h"
 
 class RmManager;
 
@@ -38,6 +42,69 @@ struct RmPageHandle {
     char* get_slot(int slot_no) const {
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // PAX格式：第col_no列的minipage首地址，第slot_no条记录的该列值位于其后slot_no * 列宽处
+    char* get_column(int col_no) const {
+        return slots + file_hdr->num_records_per_page * file_hdr->fields[col_no].offset;
+    }
+
+    // 把slot_no中的记录复制到out，PAX格式中从各列的minipage中拼出记录
+    void read_record(int slot_no, char *out) const {
+        if (file_hdr->page_format != RM_PAGE_FORMAT_PAX) {
+            memcpy(out, get_slot(slot_no), file_hdr->record_size);
+            return;
+        }
+        for (int i = 0; i < file_hdr->num_fields; i++) {
+            const RmField &col = file_hdr->fields[i];
+            memcpy(out + col.offset, get_column(i) + slot_no * col.len, col.len);
+        }
+    }
+
+    // 把buf中的记录写入slot_no，PAX格式中拆分到各列的minipage
+    void write_record(int slot_no, const char *buf) const {
+        if (file_hdr->page_format != RM_PAGE_FORMAT_PAX) {
+            memcpy(get_slot(slot_no), buf, file_hdr->record_size);
+            return;
+        }
+        for (int i = 0; i < file_hdr->num_fields; i++) {
+            const RmField &col = file_hdr->fields[i];
+            memcpy(get_column(i) + slot_no * col.len, buf + col.offset, col.len);
+        }
+    }
+};
+
+/**
+ * @description: PAX格式页面的列式只读访问，持有页面的pin。
+ * 扫描按页取得该对象，只读取谓词涉及的列的列向量，满足条件的记录再用read_record拼出整条记录
+ */
+class RmColumnPage {
+   public:
+    RmColumnPage() = default;
+
+    RmColumnPage(const RmFileHdr *file_hdr, PageGuard page_guard)
+        : file_hdr_(file_hdr), page_guard_(std::move(page_guard)) {}
+
+    explicit operator bool() const { return static_cast<bool>(page_guard_); }
+
+    int page_no() const { return page_guard_.get()->get_page_id().page_no; }
+
+    int num_slots() const { return file_hdr_->num_records_per_page; }
+
+    /** @return slot_no之后第一个存放了记录的slot，没有时返回num_slots() */
+    int next_used(int slot_no) const { return Bitmap::next_bit(true, handle().bitmap, num_slots(), slot_no); }
+
+    /** @return 第col_no列的列向量，第slot_no条记录的值位于返回地址 + slot_no * column_width(col_no) */
+    const char *column(int col_no) const { return handle().get_column(col_no); }
+
+    int column_width(int col_no) const { return file_hdr_->fields[col_no].len; }
+
+    void read_record(int slot_no, char *out) const { handle().read_record(slot_no, out); }
+
+   private:
+    RmPageHandle handle() const { return RmPageHandle(file_hdr_, page_guard_.get()); }
+
+    const RmFileHdr *file_hdr_ = nullptr;
+    PageGuard page_guard_;
 };
 
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
@@ -50,31 +117,89 @@ class RmFileHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    std::unique_ptr<RmFreeSpaceMap> fsm_;   // 记录哪些页面还有空闲slot
+    // 插入、删除、更新记录时持有所在页面对应的latch；slotted格式的页面在删除时会移动数据，读取时也要持有。
+    // 溢出页由指向它的记录所在的数据页的latch保护
+    mutable std::mutex page_latches_[RM_PAGE_LATCH_STRIPES];
+    std::mutex new_page_latch_;     // 串行化新页面的创建和file_hdr_.num_pages的更新
+    int max_encoded_len_ = 0;       // slotted格式：记录编码后的最大长度
+    int slotted_free_threshold_ = 0;    // slotted格式：连续空闲空间不小于该值的数据页在FSM中标为未满
 
    public:
-    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    /**
+     * @param {int} fd 表文件的文件句柄
+     * @param {int} fsm_fd FSM文件的文件句柄
+     * @param {int} fsm_num_pages FSM文件的页面数
+     */
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, int fsm_fd,
+                 int fsm_num_pages)
         : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
         // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
         // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
         // init file_hdr_
-        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+        // 旧版本的文件头较短，没有slotted格式的字段，未读到的部分保持为0
+        file_hdr_ = RmFileHdr{};
+        int hdr_bytes = std::min<int>(sizeof(file_hdr_), disk_manager_->get_file_size(disk_manager_->get_file_name(fd)));
+        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, hdr_bytes);
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        fsm_ = std::make_unique<RmFreeSpaceMap>(buffer_pool_manager_, fsm_fd, fsm_num_pages);
+        if (is_slotted()) {
+            max_encoded_len_ = file_hdr_.record_size + file_hdr_.num_fields * (int)sizeof(uint16_t);
+            max_encoded_len_ = std::max(max_encoded_len_, RmSlottedPage::MIN_RECORD_LEN);
+            slotted_free_threshold_ =
+                std::min(max_encoded_len_, RmSlottedPage::MAX_INLINE_LEN) + (int)sizeof(RmSlot);
+        }
     }
 
-    RmFileHdr get_file_hdr() { return file_hdr_; }
+    const RmFileHdr &get_file_hdr() const { return file_hdr_; }
     int GetFd() { return fd_; }
 
-    /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
+    bool is_slotted() const { return file_hdr_.page_format == RM_PAGE_FORMAT_SLOTTED; }
+
+    bool is_pax() const { return file_hdr_.page_format == RM_PAGE_FORMAT_PAX; }
+
+    /**
+     * @description: 按列读取PAX格式的页面
+     * @param {int} page_no 页面号
+     * @return {RmColumnPage} 持有页面pin的列式访问对象
+     */
+    RmColumnPage get_column_page(int page_no) const {
+        return RmColumnPage(&file_hdr_, PageGuard(buffer_pool_manager_, fetch_page_handle(page_no).page));
+    }
+
+    /** @return PAX格式中从记录的offset处开始的列号，不是列的起始位置时返回-1 */
+    int column_of(int offset) const {
+        for (int i = 0; i < file_hdr_.num_fields; i++) {
+            if (file_hdr_.fields[i].offset == offset) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /* 判断指定位置上是否已经存在一条记录，通过Bitmap（slotted格式中为slot数组）来判断 */
     bool is_record(const Rid &rid) const {
+        if (is_slotted()) {
+            std::scoped_lock lock(page_latch(rid.page_no));
+            PageGuard page_guard(buffer_pool_manager_, fetch_page_handle(rid.page_no).page);
+            RmSlottedPage slotted_page(page_guard.get());
+            return slotted_page.is_data_page() && slotted_page.is_used(rid.slot_no);
+        }
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        bool exist = Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        return exist;
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    RecordView get_record_view(const Rid &rid, Context *context) const;
+
     Rid insert_record(char *buf, Context *context);
 
+    void insert_records(char *const *bufs, int num_records, Rid *rids, Context *context);
+
     void insert_record(const Rid &rid, char *buf);
 
     void delete_record(const Rid &rid, Context *context);
@@ -85,8 +210,36 @@ class RmFileHandle {
 
     RmPageHandle fetch_page_handle(int page_no) const;
 
+    void rebuild_free_space_map();
+
    private:
-    RmPageHandle create_page_handle();
+    std::mutex &page_latch(int page_no) const { return page_latches_[page_no % RM_PAGE_LATCH_STRIPES]; }
+
+    Page *new_page(int slotted_page_type);
+
+    bool page_has_free_space(Page *page) const;
+
+    int insert_into_page(Page *page, const char *buf);
+
+    int insert_into_slotted_page(Page *page, const char *buf);
+
+    int fill_page(Page *page, char *const *bufs, int num_records, Rid *rids);
+
+    RecordView get_slotted_record_view(const Rid &rid) const;
+
+    int delete_slotted_record(const Rid &rid);
+
+    int update_slotted_record(const Rid &rid, const char *buf);
+
+    char *encode_buffer() const;
+
+    int encode_record(const char *buf, char *out) const;
+
+    void decode_record(const char *stored, char *out) const;
+
+    int write_overflow(const char *data, int len);
+
+    void read_overflow(const RmOverflowRef &ref, char *out) const;
 
-    void release_page_handle(RmPageHandle &page_handle);
+    void free_overflow(int first_page_no);
 };
\ No newline at end of file
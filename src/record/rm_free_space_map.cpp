@@ -0,0 +1,130 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_free_space_map.h"
+
+#include <algorithm>
+
+RmFreeSpaceMap::RmFreeSpaceMap(BufferPoolManager *buffer_pool_manager, int fd, int num_pages)
+    : buffer_pool_manager_(buffer_pool_manager), fd_(fd), free_counts_(num_pages, 0) {
+    for (int i = 0; i < num_pages; i++) {
+        Page *page = fetch(i);
+        free_counts_[i] = *num_free(page);
+        total_free_ += free_counts_[i];
+        unpin(i, false);
+    }
+}
+
+Page *RmFreeSpaceMap::fetch(int fsm_page_no) {
+    Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, fsm_page_no});
+    if (page == nullptr) {
+        throw InternalError("RmFreeSpaceMap: failed to fetch page " + std::to_string(fsm_page_no));
+    }
+    return page;
+}
+
+/**
+ * @description: 在一个FSM页面的[begin_bit, end_bit)内查找第一个置1的位，按64位字查找，调用者需持有latch_
+ * @return {int} 位的下标，没有时返回-1
+ */
+int RmFreeSpaceMap::find_in_page(int fsm_page_no, int begin_bit, int end_bit) {
+    Page *page = fetch(fsm_page_no);
+    const uint64_t *bitmap = words(page);
+    int result = -1;
+    for (int i = begin_bit / 64; i * 64 < end_bit; i++) {
+        uint64_t word = bitmap[i];
+        if (i == begin_bit / 64) {
+            word &= ~0ULL << (begin_bit % 64);
+        }
+        if (word != 0) {
+            int bit = i * 64 + __builtin_ctzll(word);
+            result = bit < end_bit ? bit : -1;
+            break;
+        }
+    }
+    unpin(fsm_page_no, false);
+    return result;
+}
+
+int RmFreeSpaceMap::find_free_page(int start_page_no) {
+    std::scoped_lock lock(latch_);
+    if (total_free_ == 0) {
+        return RM_NO_PAGE;
+    }
+    int n = static_cast<int>(free_counts_.size());
+    int start = std::max(start_page_no, 0);
+    if (start / BITS_PER_PAGE >= n) {
+        start = 0;
+    }
+    int first = start / BITS_PER_PAGE;
+    int start_bit = start % BITS_PER_PAGE;
+    // 第二层汇总为0的FSM页面直接跳过；最后一轮回到起始的FSM页面，查找起始位之前的部分
+    for (int i = 0; i <= n; i++) {
+        int fsm_page_no = (first + i) % n;
+        int begin = i == 0 ? start_bit : 0;
+        int end = i == n ? start_bit : BITS_PER_PAGE;
+        if (free_counts_[fsm_page_no] == 0 || begin >= end) {
+            continue;
+        }
+        int bit = find_in_page(fsm_page_no, begin, end);
+        if (bit >= 0) {
+            return fsm_page_no * BITS_PER_PAGE + bit;
+        }
+    }
+    return RM_NO_PAGE;
+}
+
+/**
+ * 表文件增长到当前FSM页面覆盖不到的位置时，在FSM文件末尾追加清零的页面
+ */
+void RmFreeSpaceMap::set_free(int page_no, bool has_free) {
+    std::scoped_lock lock(latch_);
+    int fsm_page_no = page_no / BITS_PER_PAGE;
+    int bit = page_no % BITS_PER_PAGE;
+    if (fsm_page_no >= static_cast<int>(free_counts_.size())) {
+        if (!has_free) {
+            return;
+        }
+        while (fsm_page_no >= static_cast<int>(free_counts_.size())) {
+            PageId page_id{fd_, INVALID_PAGE_ID};
+            if (buffer_pool_manager_->new_page(&page_id) == nullptr) {
+                throw InternalError("RmFreeSpaceMap: failed to create page");
+            }
+            assert(page_id.page_no == static_cast<int>(free_counts_.size()));
+            buffer_pool_manager_->unpin_page(page_id, true);
+            free_counts_.push_back(0);
+        }
+    }
+    Page *page = fetch(fsm_page_no);
+    uint64_t &word = words(page)[bit / 64];
+    uint64_t mask = 1ULL << (bit % 64);
+    bool changed = ((word & mask) != 0) != has_free;
+    if (changed) {
+        word ^= mask;
+        int delta = has_free ? 1 : -1;
+        *num_free(page) += delta;
+        free_counts_[fsm_page_no] += delta;
+        total_free_ += delta;
+    }
+    unpin(fsm_page_no, changed);
+}
+
+bool RmFreeSpaceMap::is_free(int page_no) {
+    std::scoped_lock lock(latch_);
+    int fsm_page_no = page_no / BITS_PER_PAGE;
+    int bit = page_no % BITS_PER_PAGE;
+    if (fsm_page_no >= static_cast<int>(free_counts_.size()) || free_counts_[fsm_page_no] == 0) {
+        return false;
+    }
+    Page *page = fetch(fsm_page_no);
+    bool result = (words(page)[bit / 64] >> (bit % 64)) & 1;
+    unpin(fsm_page_no, false);
+    return result;
+}
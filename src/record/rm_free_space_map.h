@@ -0,0 +1,84 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rm_defs.h"
+
+/*
+RmFreeSpaceMap记录表数据文件中哪些页面还有空闲的slot，存放在单独的"<表名>.fsm"文件中，经缓冲池读写。
+FSM文件的每个页面是一段位图，第k个页面的第i位对应表文件的第k*BITS_PER_PAGE+i个页面，置1表示该页面未满；
+页头记录该页面中置1的位数，作为第二层的汇总，打开时读入内存，查找时跳过没有空闲页面的整段位图。
+FSM只是提示：它可能把已满的页面标为未满（插入者发现后改正），崩溃后也可能漏掉未满的页面（只浪费空间），
+不影响记录的正确性。FSM文件不存在时（例如旧版本创建的表）由RmFileHandle扫描表文件重建
+*/
+class RmFreeSpaceMap {
+   public:
+    static constexpr int OFFSET_NUM_FREE = Page::OFFSET_PAGE_HDR;   // 页头：本页面中置1的位数
+    static constexpr int OFFSET_BITMAP = 8;                         // 位图按8字节对齐，以64位字为单位查找
+    static constexpr int WORDS_PER_PAGE = (PAGE_SIZE - OFFSET_BITMAP) / 8;
+    static constexpr int BITS_PER_PAGE = WORDS_PER_PAGE * 64;      // 每个FSM页面覆盖的表文件页面数
+
+    /**
+     * @description: 打开FSM，读入每个FSM页面的汇总
+     * @param {BufferPoolManager*} buffer_pool_manager
+     * @param {int} fd 已打开的FSM文件句柄，disk_manager中该文件已分配的页面数需已设置
+     * @param {int} num_pages FSM文件的页面数
+     */
+    RmFreeSpaceMap(BufferPoolManager *buffer_pool_manager, int fd, int num_pages);
+
+    /** @return 表文件对应的FSM文件名 */
+    static std::string file_name(const std::string &table_file_name) { return table_file_name + ".fsm"; }
+
+    int get_fd() const { return fd_; }
+
+    /**
+     * @description: 从start_page_no开始（到文件末尾后回绕）查找第一个未满的页面
+     * @return {int} 找到的页面号，没有未满的页面时返回RM_NO_PAGE
+     * @param {int} start_page_no 查找的起始页面号，不同的插入者从不同的位置开始，分散到不同的页面上
+     */
+    int find_free_page(int start_page_no);
+
+    /**
+     * @description: 设置页面是否未满
+     * @param {int} page_no 表文件中的页面号
+     * @param {bool} has_free 页面是否还有空闲slot
+     */
+    void set_free(int page_no, bool has_free);
+
+    bool is_free(int page_no);
+
+    /** @return 当前标为未满的页面数 */
+    int get_num_free() {
+        std::scoped_lock lock(latch_);
+        return total_free_;
+    }
+
+   private:
+    static uint64_t *words(Page *page) { return reinterpret_cast<uint64_t *>(page->get_data() + OFFSET_BITMAP); }
+
+    static int *num_free(Page *page) { return reinterpret_cast<int *>(page->get_data() + OFFSET_NUM_FREE); }
+
+    Page *fetch(int fsm_page_no);
+
+    void unpin(int fsm_page_no, bool is_dirty) { buffer_pool_manager_->unpin_page(PageId{fd_, fsm_page_no}, is_dirty); }
+
+    int find_in_page(int fsm_page_no, int begin_bit, int end_bit);
+
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    std::mutex latch_;              // 保护free_counts_、total_free_和FSM页面的内容，只在位运算期间持有
+    std::vector<int> free_counts_;  // 第二层汇总：每个FSM页面中置1的位数
+    int total_free_ = 0;
+};
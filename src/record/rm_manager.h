@@ -12,6 +12,10 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
 #include "bitmap.h"
 #include "rm_defs.h"
 #include "rm_file_handle.h"
@@ -29,13 +33,32 @@ class RmManager {
     /**
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
-     * @param {int} record_size 表中记录的大小
+     * @param {int} record_size 表中记录的大小，变长字段按最大长度计算
+     * @param {RmPageFormat} page_format 页面格式，含变长字段的表使用RM_PAGE_FORMAT_SLOTTED
+     * @param {vector<RmField>&} fields slotted格式中为只存放实际长度的变长字段，PAX格式中为按顺序覆盖整条记录的所有列
+     * @param {bool} compressed 表文件是否按extent压缩存放，FSM文件不压缩
      */ 
-    void create_file(const std::string& filename, int record_size) {
-        if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
+    void create_file(const std::string& filename, int record_size, RmPageFormat page_format = RM_PAGE_FORMAT_FIXED,
+                     const std::vector<RmField>& fields = {}, bool compressed = false) {
+        int max_record_size = page_format == RM_PAGE_FORMAT_SLOTTED ? RM_MAX_SLOTTED_RECORD_SIZE : RM_MAX_RECORD_SIZE;
+        if (record_size < 1 || record_size > max_record_size) {
             throw InvalidRecordSizeError(record_size);
         }
-        disk_manager_->create_file(filename);
+        if (fields.size() > (size_t)RM_MAX_FIELDS) {
+            throw InternalError("RmManager::create_file: too many fields");
+        }
+        int prev_end = 0;
+        for (auto& field : fields) {
+            bool contiguous = page_format != RM_PAGE_FORMAT_PAX || field.offset == prev_end;
+            if (!contiguous || field.offset < prev_end || field.len < 1 || field.offset + field.len > record_size) {
+                throw InternalError("RmManager::create_file: invalid field layout");
+            }
+            prev_end = field.offset + field.len;
+        }
+        if (page_format == RM_PAGE_FORMAT_PAX && prev_end != record_size) {
+            throw InternalError("RmManager::create_file: PAX columns must cover the whole record");
+        }
+        disk_manager_->create_file(filename, compressed);
         int fd = disk_manager_->open_file(filename);
 
         // 初始化file header
@@ -43,32 +66,70 @@ class RmManager {
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
-        file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.page_format = page_format;
+        if (page_format == RM_PAGE_FORMAT_SLOTTED) {
+            // slotted格式的页面没有bitmap，每页的记录数取决于记录的实际长度
+            file_hdr.num_records_per_page = 0;
+            file_hdr.bitmap_size = 0;
+        } else {
+            // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+            // hdr按文件头中page_format之前的字段计算，与加入slotted格式之前每页的记录数相同；
+            // PAX格式的页面只是把n条记录的同一列放在一起，容量与定长格式相同
+            int hdr_size = (int)offsetof(RmFileHdr, page_format);
+            file_hdr.num_records_per_page =
+                (BITMAP_WIDTH * (PAGE_SIZE - 1 - hdr_size) + 1) / (1 + record_size * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        }
+        file_hdr.num_fields = (int)fields.size();
+        std::copy(fields.begin(), fields.end(), file_hdr.fields);
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
         disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
         disk_manager_->close_file(fd);
+
+        // 空表没有页面，FSM文件也为空；可能残留同名表的FSM文件，先删除
+        std::string fsm_name = RmFreeSpaceMap::file_name(filename);
+        if (disk_manager_->is_file(fsm_name)) {
+            disk_manager_->destroy_file(fsm_name);
+        }
+        disk_manager_->create_file(fsm_name);
     }
 
     /**
-     * @description: 删除表的数据文件
+     * @description: 删除表的数据文件及其FSM文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        std::string fsm_name = RmFreeSpaceMap::file_name(filename);
+        if (disk_manager_->is_file(fsm_name)) {
+            disk_manager_->destroy_file(fsm_name);
+        }
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
-     * @description: 打开表的数据文件，并返回文件句柄
+     * @description: 打开表的数据文件，并返回文件句柄；FSM文件不存在时扫描表文件重建
      * @param {string&} filename 要打开的文件名称
      * @return {unique_ptr<RmFileHandle>} 文件句柄的指针
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        std::string fsm_name = RmFreeSpaceMap::file_name(filename);
+        bool rebuild = !disk_manager_->is_file(fsm_name);
+        if (rebuild) {
+            disk_manager_->create_file(fsm_name);
+        }
+        int fsm_fd = disk_manager_->open_file(fsm_name);
+        int fsm_num_pages = disk_manager_->get_file_size(fsm_name) / PAGE_SIZE;
+        disk_manager_->set_fd2pageno(fsm_fd, fsm_num_pages);
+        auto file_handle =
+            std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd, fsm_fd, fsm_num_pages);
+        if (rebuild) {
+            file_handle->rebuild_free_space_map();
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
@@ -80,5 +141,7 @@ class RmManager {
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
         disk_manager_->close_file(file_handle->fd_);
+        buffer_pool_manager_->flush_all_pages(file_handle->fsm_->get_fd());
+        disk_manager_->close_file(file_handle->fsm_->get_fd());
     }
 };
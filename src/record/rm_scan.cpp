@@ -9,13 +9,17 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "rm_scan.h"
+
+#include <algorithm>
+
 #include "rm_file_handle.h"
 
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @param read_ahead 是否开启顺序预读
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, bool read_ahead) : file_handle_(file_handle), read_ahead_(read_ahead) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
     rid_.page_no = RM_FIRST_RECORD_PAGE;  // Start from the first data page
@@ -30,16 +34,34 @@ void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
     while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
-        RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
-        
-        // Try to find next used slot in current page
-        rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, 
-                                      file_handle_->file_hdr_.num_records_per_page,
-                                      rid_.slot_no);
-        
-        if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
-            // Found a valid record in current page
-            return;
+        if (rid_.slot_no == -1) {
+            read_ahead(rid_.page_no);
+        }
+        if (file_handle_->is_slotted()) {
+            // slotted格式：跳过溢出页，在slot数组中查找下一个非空slot
+            std::scoped_lock lock(file_handle_->page_latch(rid_.page_no));
+            PageGuard page_guard(file_handle_->buffer_pool_manager_,
+                                 file_handle_->fetch_page_handle(rid_.page_no).page);
+            RmSlottedPage slotted_page(page_guard.get());
+            if (slotted_page.is_data_page()) {
+                rid_.slot_no = slotted_page.next_used(rid_.slot_no);
+                if (rid_.slot_no < slotted_page.num_slots()) {
+                    return;
+                }
+            }
+        } else {
+            RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
+
+            // Try to find next used slot in current page
+            rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap,
+                                          file_handle_->file_hdr_.num_records_per_page,
+                                          rid_.slot_no);
+            file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+
+            if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
+                // Found a valid record in current page
+                return;
+            }
         }
         
         // No more records in current page, move to next page
@@ -48,6 +70,18 @@ void RmScan::next() {
     }
 }
 
+/**
+ * @brief 跳过当前页面中剩余的记录，移动到后面页面中的第一条记录，供按页处理记录的扫描使用
+ */
+void RmScan::next_page() {
+    if (is_end()) {
+        return;
+    }
+    rid_.page_no++;
+    rid_.slot_no = -1;
+    next();
+}
+
 /**
  * @brief ​ 判断是否到达文件末尾
  */
@@ -61,4 +95,47 @@ bool RmScan::is_end() const {
  */
 Rid RmScan::rid() const {
     return rid_;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 进入新页面时检查是否为顺序访问，若是则提前把后续页面预读到缓冲池中
+ * 预读窗口从READ_AHEAD_MIN_PAGES开始，每消耗完一半窗口就发起下一批预读并把窗口加倍，
+ * 上限为READ_AHEAD_MAX_PAGES和缓冲池大小的1/READ_AHEAD_POOL_FRACTION中的较小者；
+ * 如果期间有预读页面未被访问就被淘汰，说明缓冲池压力较大，窗口减半
+ * @param page_no 即将访问的页号
+ */
+void RmScan::read_ahead(page_id_t page_no) {
+    if (!read_ahead_) {
+        return;
+    }
+    bool sequential = page_no == last_page_ + 1;
+    last_page_ = page_no;
+    if (!sequential) {
+        ra_window_ = 0;
+        ra_next_ = page_no + 1;
+        return;
+    }
+    if (ra_window_ > 0 && ra_next_ - page_no > ra_window_ / 2) {
+        return;  // 已预读的页面还足够多，暂不发起新的预读
+    }
+
+    BufferPoolManager *bpm = file_handle_->buffer_pool_manager_;
+    int max_window = std::max(1, std::min(READ_AHEAD_MAX_PAGES, (int)bpm->get_pool_size() / READ_AHEAD_POOL_FRACTION));
+    size_t wasted = bpm->get_prefetch_wasted();
+    if (ra_window_ == 0) {
+        ra_window_ = READ_AHEAD_MIN_PAGES;
+    } else if (wasted > ra_wasted_seen_) {
+        ra_window_ = std::max(1, ra_window_ / 2);
+    } else {
+        ra_window_ *= 2;
+    }
+    ra_window_ = std::min(ra_window_, max_window);
+    ra_wasted_seen_ = wasted;
+
+    page_id_t start = std::max(ra_next_, page_no + 1);
+    page_id_t end = std::min(page_no + 1 + ra_window_, file_handle_->file_hdr_.num_pages);
+    if (start < end) {
+        bpm->prefetch_pages(file_handle_->fd_, start, end - start);
+        ra_next_ = end;
+    }
+}
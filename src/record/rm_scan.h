@@ -17,12 +17,24 @@ class RmFileHandle;
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+
+    // 顺序预读的状态
+    bool read_ahead_;                 // 是否开启顺序预读
+    int ra_window_ = 0;               // 当前预读窗口大小（页数），随顺序访问自适应增长
+    page_id_t ra_next_ = 0;           // 下一个尚未预读的页号
+    page_id_t last_page_ = RM_FIRST_RECORD_PAGE - 1;  // 上一次访问的页号，用于识别顺序访问
+    size_t ra_wasted_seen_ = 0;       // 上次调整窗口时缓冲池中被浪费的预读页面数
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, bool read_ahead = true);
 
     void next() override;
 
+    void next_page();
+
     bool is_end() const override;
 
     Rid rid() const override;
+
+private:
+    void read_ahead(page_id_t page_no);
 };
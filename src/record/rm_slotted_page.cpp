@@ -0,0 +1,108 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_slotted_page.h"
+
+#include <cassert>
+#include <cstring>
+
+void RmSlottedPage::init(int page_type) {
+    RmSlottedPageHdr *page_hdr = hdr();
+    page_hdr->next_free_page_no = RM_NO_PAGE;
+    page_hdr->num_records = 0;
+    page_hdr->page_type = page_type;
+    page_hdr->num_slots = 0;
+    page_hdr->free_end = PAGE_SIZE;
+    page_hdr->next_overflow_page_no = RM_NO_PAGE;
+    page_hdr->overflow_len = 0;
+}
+
+int RmSlottedPage::next_used(int slot_no) const {
+    for (int i = slot_no + 1; i < num_slots(); i++) {
+        if (slot(i)->offset != 0) {
+            return i;
+        }
+    }
+    return num_slots();
+}
+
+bool RmSlottedPage::can_insert(int len) const {
+    // 有空slot时复用，否则还需要一个新slot的空间
+    bool has_empty_slot = hdr()->num_records < num_slots();
+    return free_space() >= len + (has_empty_slot ? 0 : static_cast<int>(sizeof(RmSlot)));
+}
+
+int RmSlottedPage::insert(const char *buf, int len, bool overflow) {
+    if (!can_insert(len)) {
+        return -1;
+    }
+    int slot_no = 0;
+    while (slot_no < num_slots() && slot(slot_no)->offset != 0) {
+        slot_no++;
+    }
+    if (slot_no == num_slots()) {
+        hdr()->num_slots++;
+    }
+    place(slot_no, buf, len, overflow);
+    hdr()->num_records++;
+    return slot_no;
+}
+
+bool RmSlottedPage::update(int slot_no, const char *buf, int len, bool overflow) {
+    int old_len = slot(slot_no)->len & ~OVERFLOW_FLAG;
+    if (len == old_len) {
+        // 长度不变时原地覆盖，不移动数据
+        memcpy(data_ + slot(slot_no)->offset, buf, len);
+        slot(slot_no)->len = static_cast<uint16_t>(len | (overflow ? OVERFLOW_FLAG : 0));
+        return true;
+    }
+    if (free_space() + old_len < len) {
+        return false;
+    }
+    remove_data(slot_no);
+    place(slot_no, buf, len, overflow);
+    return true;
+}
+
+void RmSlottedPage::erase(int slot_no) {
+    remove_data(slot_no);
+    hdr()->num_records--;
+    // 回收尾部的空slot，其余slot_no不变
+    while (num_slots() > 0 && slot(num_slots() - 1)->offset == 0) {
+        hdr()->num_slots--;
+    }
+}
+
+void RmSlottedPage::remove_data(int slot_no) {
+    RmSlot *target = slot(slot_no);
+    int offset = target->offset;
+    int len = target->len & ~OVERFLOW_FLAG;
+    assert(offset != 0);
+    int free_end = hdr()->free_end;
+    // 数据区中位于被删记录前面（地址更小）的记录整体后移len字节
+    memmove(data_ + free_end + len, data_ + free_end, offset - free_end);
+    for (int i = 0; i < num_slots(); i++) {
+        RmSlot *s = slot(i);
+        if (s->offset != 0 && s->offset < offset) {
+            s->offset = static_cast<uint16_t>(s->offset + len);
+        }
+    }
+    hdr()->free_end = free_end + len;
+    target->offset = 0;
+    target->len = 0;
+}
+
+void RmSlottedPage::place(int slot_no, const char *buf, int len, bool overflow) {
+    int offset = hdr()->free_end - len;
+    memcpy(data_ + offset, buf, len);
+    hdr()->free_end = offset;
+    slot(slot_no)->offset = static_cast<uint16_t>(offset);
+    slot(slot_no)->len = static_cast<uint16_t>(len | (overflow ? OVERFLOW_FLAG : 0));
+}
@@ -0,0 +1,132 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "rm_defs.h"
+
+/* slotted格式页面的页头，位于Page::OFFSET_PAGE_HDR之后，前两个字段与RmPageHdr相同 */
+struct RmSlottedPageHdr {
+    int next_free_page_no;      // 不使用，始终为-1
+    int num_records;            // 页面中的记录个数
+    int page_type;              // RmSlottedPage::DATA_PAGE或RmSlottedPage::OVERFLOW_PAGE
+    int num_slots;              // slot数组的长度，包括空slot
+    int free_end;               // 记录数据区的起始位置（页内偏移），数据区从页尾向前增长
+    int next_overflow_page_no;  // 溢出页：下一个溢出页的页号，最后一页为RM_NO_PAGE
+    int overflow_len;           // 溢出页：本页存放的数据长度
+};
+
+/* slot数组的元素。offset为0表示空slot；len的最高位置1表示页内存放的是RmOverflowRef */
+struct RmSlot {
+    uint16_t offset;
+    uint16_t len;
+};
+
+/* 存放在溢出页中的记录在页内只保存该结构 */
+struct RmOverflowRef {
+    int total_len;          // 记录编码后的总长度
+    int first_page_no;      // 第一个溢出页的页号
+};
+
+static_assert(PAGE_SIZE <= 0x8000, "slot offsets and lengths are stored in 15 bits");
+
+/*
+RmSlottedPage封装slotted格式的页面：页头之后是slot数组，记录从页尾向前存放，两者之间是空闲空间。
+删除和缩短记录时立即把数据区压缩为连续的一段，空闲空间总是连续的，插入时不需要再整理页面；
+删除记录只清空slot而不移动slot数组，其余记录的slot_no（即Rid）保持不变，尾部的空slot被回收。
+溢出页也使用相同的页头，数据区从OFFSET_SLOTS开始，不含slot数组。
+调用者需持有页面的pin和所在页面的latch
+*/
+class RmSlottedPage {
+   public:
+    static constexpr int DATA_PAGE = 0;
+    static constexpr int OVERFLOW_PAGE = 1;
+    static constexpr uint16_t OVERFLOW_FLAG = 0x8000;
+    static constexpr int OFFSET_SLOTS = Page::OFFSET_PAGE_HDR + sizeof(RmSlottedPageHdr);
+    static constexpr int OVERFLOW_CAPACITY = PAGE_SIZE - OFFSET_SLOTS;  // 每个溢出页可以存放的数据长度
+    static constexpr int MAX_INLINE_LEN = PAGE_SIZE / 4;   // 编码后超过该长度的记录存放到溢出页中
+    static constexpr int MIN_RECORD_LEN = sizeof(RmOverflowRef);  // 页内记录的最小长度，保证原地改为溢出记录时放得下
+
+    explicit RmSlottedPage(Page *page) : data_(page->get_data()) {}
+
+    /**
+     * @description: 把页面初始化为空的数据页或溢出页
+     * @param {int} page_type DATA_PAGE或OVERFLOW_PAGE
+     */
+    void init(int page_type);
+
+    RmSlottedPageHdr *hdr() const { return reinterpret_cast<RmSlottedPageHdr *>(data_ + Page::OFFSET_PAGE_HDR); }
+
+    bool is_data_page() const { return hdr()->page_type == DATA_PAGE; }
+
+    int num_slots() const { return hdr()->num_slots; }
+
+    bool is_used(int slot_no) const { return slot_no >= 0 && slot_no < num_slots() && slot(slot_no)->offset != 0; }
+
+    bool is_overflow(int slot_no) const { return (slot(slot_no)->len & OVERFLOW_FLAG) != 0; }
+
+    /**
+     * @description: 获取页内存放的记录
+     * @return {const char*} 记录在页内的首地址，溢出记录为其RmOverflowRef
+     * @param {int} slot_no 非空的slot
+     * @param {int*} len 存储页内数据的长度
+     */
+    const char *get(int slot_no, int *len) const {
+        *len = slot(slot_no)->len & ~OVERFLOW_FLAG;
+        return data_ + slot(slot_no)->offset;
+    }
+
+    /** @return 从slot_no之后开始的第一个非空slot，没有时返回num_slots() */
+    int next_used(int slot_no) const;
+
+    /** @return slot数组与数据区之间的连续空闲空间 */
+    int free_space() const {
+        return hdr()->free_end - OFFSET_SLOTS - num_slots() * static_cast<int>(sizeof(RmSlot));
+    }
+
+    /** @return 页面能否再放下一条页内长度为len的记录（包括可能需要的新slot） */
+    bool can_insert(int len) const;
+
+    /**
+     * @description: 插入一条记录，优先复用空slot
+     * @return {int} 记录的slot_no，空间不足时返回-1
+     * @param {char*} buf 页内存放的数据
+     * @param {int} len 数据长度
+     * @param {bool} overflow buf是否为RmOverflowRef
+     */
+    int insert(const char *buf, int len, bool overflow);
+
+    /**
+     * @description: 替换slot_no中的记录，slot_no不变
+     * @return {bool} 成功返回true，空间不足时返回false且页面不变
+     */
+    bool update(int slot_no, const char *buf, int len, bool overflow);
+
+    /**
+     * @description: 删除slot_no中的记录并压缩数据区
+     */
+    void erase(int slot_no);
+
+    /** @return 溢出页的数据区 */
+    char *overflow_data() const { return data_ + OFFSET_SLOTS; }
+
+   private:
+    RmSlot *slot(int slot_no) const { return reinterpret_cast<RmSlot *>(data_ + OFFSET_SLOTS) + slot_no; }
+
+    // 删除slot_no的数据，把数据区中位于其前面的记录向后移动填补空洞，slot本身保留
+    void remove_data(int slot_no);
+
+    // 在数据区头部为slot_no放置数据，调用者已确认空间足够
+    void place(int slot_no, const char *buf, int len, bool overflow);
+
+    char *data_;
+};
@@ -0,0 +1,98 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "clock_replacer.h"
+
+#include <thread>
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_frames_(num_pages), state_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+    for (size_t i = 0; i < num_frames_; i++) {
+        state_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * @description: 使用CLOCK策略删除一个victim frame，并返回该frame的id
+ * 时钟指针扫过可淘汰的frame时，若访问位为1则清零并跳过，否则用CAS将其状态清零，成功即选中该frame。
+ * 与pin并发时CAS失败，继续向后扫描；每扫过一整圈检查一次是否还有可淘汰的frame。
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t *frame_id) {
+    size_t steps = 0;
+    while (size_.load(std::memory_order_acquire) > 0) {
+        size_t pos = hand_.fetch_add(1, std::memory_order_relaxed) % num_frames_;
+        uint8_t state = state_[pos].load(std::memory_order_acquire);
+        if (state & EVICTABLE) {
+            if (state & REFERENCED) {
+                state_[pos].compare_exchange_strong(state, state & ~REFERENCED, std::memory_order_acq_rel);
+            } else if (state_[pos].compare_exchange_strong(state, 0, std::memory_order_acq_rel)) {
+                size_.fetch_sub(1, std::memory_order_release);
+                *frame_id = static_cast<frame_id_t>(pos);
+                return true;
+            }
+        }
+        // 多扫描两圈仍未找到时交出CPU，等待并发的unpin/pin稳定下来
+        if (++steps % (2 * num_frames_) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，同时置访问位
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+    uint8_t old = state_[frame_id].exchange(REFERENCED, std::memory_order_acq_rel);
+    if (old & EVICTABLE) {
+        size_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰；frame已经可淘汰时不产生影响
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    uint8_t old = state_[frame_id].fetch_or(EVICTABLE | REFERENCED, std::memory_order_acq_rel);
+    if (!(old & EVICTABLE)) {
+        size_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() { return size_.load(std::memory_order_acquire); }
+
+/**
+ * @description: 从时钟指针处开始列出可淘汰的frame，访问位未置位的frame会先被淘汰，因此排在前面
+ * 只读取各frame的状态，得到的是并发修改下的近似结果
+ * @param {size_t} max_frames 最多列出的frame数量
+ * @param {vector<frame_id_t>*} frames 列出的frame追加到frames中
+ */
+void ClockReplacer::cold_frames(size_t max_frames, std::vector<frame_id_t> *frames) {
+    size_t start = hand_.load(std::memory_order_relaxed);
+    size_t listed = 0;
+    for (uint8_t wanted : {EVICTABLE, static_cast<uint8_t>(EVICTABLE | REFERENCED)}) {
+        for (size_t i = 0; i < num_frames_ && listed < max_frames; i++) {
+            size_t pos = (start + i) % num_frames_;
+            if (state_[pos].load(std::memory_order_relaxed) == wanted) {
+                frames->push_back(static_cast<frame_id_t>(pos));
+                listed++;
+            }
+        }
+    }
+}
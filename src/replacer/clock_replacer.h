@@ -0,0 +1,55 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK（二次机会）替换策略，不使用互斥锁：
+每个frame对应一个原子状态字节，包含“可淘汰”和“访问位”两个标志；
+pin/unpin只对该字节做一次原子操作，不分配内存；
+victim通过原子递增的时钟指针扫描，清除访问位或用CAS抢占可淘汰的frame。
+每个访问位最多被清除一次，因此victim的均摊代价为O(1)。
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+    void cold_frames(size_t max_frames, std::vector<frame_id_t> *frames);
+
+   private:
+    static constexpr uint8_t EVICTABLE = 0x1;  // frame当前可以被淘汰
+    static constexpr uint8_t REFERENCED = 0x2;  // 访问位，时钟指针扫过时若置位则清零并给予第二次机会
+
+    size_t num_frames_;
+    std::unique_ptr<std::atomic<uint8_t>[]> state_;  // 每个frame的状态
+    std::atomic<size_t> hand_{0};                      // 时钟指针，取模后为当前检查的frame
+    std::atomic<size_t> size_{0};                      // 可以被淘汰的frame个数
+};
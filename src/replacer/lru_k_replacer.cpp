@@ -0,0 +1,111 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k), history_(num_pages * k, 0), access_count_(num_pages, 0), evictable_(num_pages, false) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 记录frame的一次访问
+ * @param {frame_id_t} frame_id 被访问的frame的id
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+    size_t count = access_count_[frame_id]++;
+    history_[frame_id * k_ + count % k_] = ++current_ts_;
+}
+
+/**
+ * @description: 计算frame在cold_或hot_中的排序键
+ * 访问不足K次时为最早的访问时间，否则为倒数第K次访问的时间
+ */
+LRUKReplacer::Entry LRUKReplacer::make_entry(frame_id_t frame_id) const {
+    size_t count = access_count_[frame_id];
+    if (count < k_) {
+        return {history_[frame_id * k_], frame_id};
+    }
+    // 环形数组中下一个将被覆盖的位置就是倒数第K次访问
+    return {history_[frame_id * k_ + count % k_], frame_id};
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock(latch_);
+    std::set<Entry> &from = cold_.empty() ? hot_ : cold_;
+    if (from.empty()) {
+        return false;
+    }
+    *frame_id = from.begin()->second;
+    from.erase(from.begin());
+    evictable_[*frame_id] = false;
+    // frame将装入新的页面，之前的访问历史不再有意义
+    access_count_[*frame_id] = 0;
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，同时记录一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock(latch_);
+    if (evictable_[frame_id]) {
+        Entry entry = make_entry(frame_id);
+        (access_count_[frame_id] < k_ ? cold_ : hot_).erase(entry);
+        evictable_[frame_id] = false;
+    }
+    record_access(frame_id);
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * 未经pin直接加入的frame（如预读载入的页面）以加入时间作为第一次访问
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock(latch_);
+    if (evictable_[frame_id]) {
+        return;
+    }
+    if (access_count_[frame_id] == 0) {
+        record_access(frame_id);
+    }
+    evictable_[frame_id] = true;
+    Entry entry = make_entry(frame_id);
+    (access_count_[frame_id] < k_ ? cold_ : hot_).insert(entry);
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock(latch_);
+    return cold_.size() + hot_.size();
+}
+
+/**
+ * @description: 按淘汰顺序列出可淘汰的frame：先是访问不足K次的frame，再是按倒数第K次访问时间排序的frame
+ * @param {size_t} max_frames 最多列出的frame数量
+ * @param {vector<frame_id_t>*} frames 列出的frame追加到frames中
+ */
+void LRUKReplacer::cold_frames(size_t max_frames, std::vector<frame_id_t> *frames) {
+    std::scoped_lock lock(latch_);
+    for (const std::set<Entry> *from : {&cold_, &hot_}) {
+        for (auto it = from->begin(); it != from->end() && max_frames > 0; ++it, --max_frames) {
+            frames->push_back(it->second);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略：
+每次pin视为一次访问，淘汰时选择后向K距离（当前时间与倒数第K次访问时间之差）最大的frame；
+访问次数不足K次的frame后向K距离视为无穷大，优先淘汰，其中按最早访问时间先进先出。
+只被顺序扫描访问过一次的页面因此总是先于热点页面被淘汰。
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量
+     * @param {size_t} k 参考的历史访问次数
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = LRU_K);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+    void cold_frames(size_t max_frames, std::vector<frame_id_t> *frames);
+
+   private:
+    using Entry = std::pair<uint64_t, frame_id_t>;  // <排序键，frame id>
+
+    void record_access(frame_id_t frame_id);
+
+    Entry make_entry(frame_id_t frame_id) const;
+
+    std::mutex latch_;                      // 互斥锁
+    size_t k_;
+    uint64_t current_ts_ = 0;               // 逻辑时钟，每次访问加一
+    std::vector<uint64_t> history_;         // 每个frame最近K次访问的时间戳，环形存放，第i个frame占[i*k, (i+1)*k)
+    std::vector<size_t> access_count_;      // 每个frame的累计访问次数
+    std::vector<bool> evictable_;           // 每个frame当前是否可以被淘汰
+    std::set<Entry> cold_;                  // 访问不足K次的可淘汰frame，按最早访问时间排序
+    std::set<Entry> hot_;                   // 访问达到K次的可淘汰frame，按倒数第K次访问时间排序
+};
@@ -85,3 +85,15 @@ void LRUReplacer::unpin(frame_id_t frame_id) {
  * @description: 获取当前replacer中可以被淘汰的页面数量
  */
 size_t LRUReplacer::Size() { return LRUlist_.size(); }
+
+/**
+ * @description: 从链表尾部（最久未被访问的一端）开始列出可淘汰的frame，不改变replacer的状态
+ * @param {size_t} max_frames 最多列出的frame数量
+ * @param {vector<frame_id_t>*} frames 列出的frame追加到frames中
+ */
+void LRUReplacer::cold_frames(size_t max_frames, std::vector<frame_id_t> *frames) {
+    std::scoped_lock lock(latch_);
+    for (auto it = LRUlist_.rbegin(); it != LRUlist_.rend() && max_frames > 0; ++it, --max_frames) {
+        frames->push_back(*it);
+    }
+}
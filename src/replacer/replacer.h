@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 /**
@@ -41,4 +43,13 @@ class Replacer {
 
     /** @return the number of elements in the replacer that can be victimized */
     virtual size_t Size() = 0;
+
+    /**
+     * Lists victimizable frames, coldest first, roughly in the order victim() would remove them.
+     * Nothing is removed and no access is recorded; the background page cleaner uses this to
+     * write back dirty pages before they are chosen as victims.
+     * @param max_frames the maximum number of frames to list
+     * @param[out] frames the listed frames are appended here
+     */
+    virtual void cold_frames(size_t max_frames, std::vector<frame_id_t> *frames) = 0;
 };
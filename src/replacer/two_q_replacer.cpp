@@ -0,0 +1,129 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "two_q_replacer.h"
+
+#include <algorithm>
+
+TwoQReplacer::TwoQReplacer(size_t num_pages)
+    : a1_max_size_(std::max<size_t>(1, num_pages / TWO_Q_A1_FRACTION)),
+      prev_(num_pages, INVALID_FRAME_ID),
+      next_(num_pages, INVALID_FRAME_ID),
+      queue_(num_pages, QUEUE_NONE),
+      access_count_(num_pages, 0) {}
+
+TwoQReplacer::~TwoQReplacer() = default;
+
+void TwoQReplacer::push_front(Queue &queue, frame_id_t frame_id) {
+    prev_[frame_id] = INVALID_FRAME_ID;
+    next_[frame_id] = queue.head;
+    if (queue.head != INVALID_FRAME_ID) {
+        prev_[queue.head] = frame_id;
+    } else {
+        queue.tail = frame_id;
+    }
+    queue.head = frame_id;
+    queue.size++;
+}
+
+void TwoQReplacer::remove(Queue &queue, frame_id_t frame_id) {
+    if (prev_[frame_id] != INVALID_FRAME_ID) {
+        next_[prev_[frame_id]] = next_[frame_id];
+    } else {
+        queue.head = next_[frame_id];
+    }
+    if (next_[frame_id] != INVALID_FRAME_ID) {
+        prev_[next_[frame_id]] = prev_[frame_id];
+    } else {
+        queue.tail = prev_[frame_id];
+    }
+    prev_[frame_id] = next_[frame_id] = INVALID_FRAME_ID;
+    queue.size--;
+}
+
+/**
+ * @description: 使用2Q策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool TwoQReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock(latch_);
+    Queue *from;
+    if (a1_.size > 0 && (a1_.size > a1_max_size_ || am_.size == 0)) {
+        from = &a1_;
+    } else if (am_.size > 0) {
+        from = &am_;
+    } else {
+        return false;
+    }
+    *frame_id = from->tail;
+    remove(*from, *frame_id);
+    queue_[*frame_id] = QUEUE_NONE;
+    access_count_[*frame_id] = 0;
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，同时记录一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void TwoQReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock(latch_);
+    if (queue_[frame_id] != QUEUE_NONE) {
+        remove(queue_of(queue_[frame_id]), frame_id);
+        queue_[frame_id] = QUEUE_NONE;
+    }
+    access_count_[frame_id] = std::min(access_count_[frame_id] + 1, 2);
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * 只被访问过一次（或从未被访问，如预读载入）的frame加入A1，否则加入Am
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void TwoQReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock(latch_);
+    if (queue_[frame_id] != QUEUE_NONE) {
+        return;
+    }
+    QueueType type = access_count_[frame_id] >= 2 ? QUEUE_AM : QUEUE_A1;
+    push_front(queue_of(type), frame_id);
+    queue_[frame_id] = type;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t TwoQReplacer::Size() {
+    std::scoped_lock lock(latch_);
+    return a1_.size + am_.size;
+}
+
+/**
+ * @description: 近似按淘汰顺序列出可淘汰的frame：先是A1中超出容量的部分，再是Am，最后是A1中剩余的frame，
+ * 每个队列都从最早加入的一端开始
+ * @param {size_t} max_frames 最多列出的frame数量
+ * @param {vector<frame_id_t>*} frames 列出的frame追加到frames中
+ */
+void TwoQReplacer::cold_frames(size_t max_frames, std::vector<frame_id_t> *frames) {
+    std::scoped_lock lock(latch_);
+    size_t a1_excess = a1_.size > a1_max_size_ ? a1_.size - a1_max_size_ : 0;
+    frame_id_t a1_pos = a1_.tail;
+    for (; a1_excess > 0 && a1_pos != INVALID_FRAME_ID && max_frames > 0; a1_excess--, max_frames--) {
+        frames->push_back(a1_pos);
+        a1_pos = prev_[a1_pos];
+    }
+    for (frame_id_t pos = am_.tail; pos != INVALID_FRAME_ID && max_frames > 0; pos = prev_[pos], max_frames--) {
+        frames->push_back(pos);
+    }
+    for (; a1_pos != INVALID_FRAME_ID && max_frames > 0; a1_pos = prev_[a1_pos], max_frames--) {
+        frames->push_back(a1_pos);
+    }
+}
@@ -0,0 +1,69 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+TwoQReplacer实现了简化的2Q替换策略：
+只被访问过一次的frame进入先进先出的A1队列，再次被访问的frame进入按LRU管理的Am队列；
+A1中的frame数超过容量的1/TWO_Q_A1_FRACTION（或Am为空）时从A1淘汰，否则从Am淘汰。
+顺序扫描读入的页面只会在A1中轮转，不会把Am中的热点页面挤出缓冲池。
+两个队列均用frame id下标组成的侵入式双向链表实现，pin/unpin不需要分配内存。
+*/
+class TwoQReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的TwoQReplacer
+     * @param {size_t} num_pages TwoQReplacer最多需要存储的page数量
+     */
+    explicit TwoQReplacer(size_t num_pages);
+
+    ~TwoQReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+    void cold_frames(size_t max_frames, std::vector<frame_id_t> *frames);
+
+   private:
+    enum QueueType { QUEUE_NONE, QUEUE_A1, QUEUE_AM };
+
+    struct Queue {
+        frame_id_t head = INVALID_FRAME_ID;  // 最新加入的frame
+        frame_id_t tail = INVALID_FRAME_ID;  // 最早加入的frame，即下一个被淘汰的frame
+        size_t size = 0;
+    };
+
+    void push_front(Queue &queue, frame_id_t frame_id);
+
+    void remove(Queue &queue, frame_id_t frame_id);
+
+    Queue &queue_of(QueueType type) { return type == QUEUE_A1 ? a1_ : am_; }
+
+    std::mutex latch_;                  // 互斥锁
+    size_t a1_max_size_;                // A1队列的容量
+    std::vector<frame_id_t> prev_;      // 链表中每个frame的前驱（更新的一端）
+    std::vector<frame_id_t> next_;      // 链表中每个frame的后继（更旧的一端）
+    std::vector<QueueType> queue_;      // 每个frame当前所在的队列，QUEUE_NONE表示不可淘汰
+    std::vector<int> access_count_;     // 每个frame装入当前页面以来的访问次数（只区分1次和多次）
+    Queue a1_;
+    Queue am_;
+};
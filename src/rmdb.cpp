@@ -29,24 +29,51 @@ See the Mulan PSL v2 for more details. */
 
 static bool should_exit = false;
 
-// 构建全局所需的管理器对象
-auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
-auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
-auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
-auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
-auto lock_manager = std::make_unique<LockManager>();
-auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
-auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
-auto log_manager = std::make_unique<LogManager>(disk_manager.get());
-auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
-auto planner = std::make_unique<Planner>(sm_manager.get());
-auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
-auto analyze = std::make_unique<Analyze>(sm_manager.get());
+// 全局所需的管理器对象，在main中解析完启动参数后构建
+std::unique_ptr<DiskManager> disk_manager;
+std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+std::unique_ptr<RmManager> rm_manager;
+std::unique_ptr<IxManager> ix_manager;
+std::unique_ptr<SmManager> sm_manager;
+std::unique_ptr<LockManager> lock_manager;
+std::unique_ptr<TransactionManager> txn_manager;
+std::unique_ptr<QlManager> ql_manager;
+std::unique_ptr<LogManager> log_manager;
+std::unique_ptr<RecoveryManager> recovery;
+std::unique_ptr<Planner> planner;
+std::unique_ptr<Optimizer> optimizer;
+std::unique_ptr<Portal> portal;
+std::unique_ptr<Analyze> analyze;
 pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
 
+/**
+ * @description: 构建全局所需的管理器对象
+ * @param {size_t} pool_size 缓冲池中帧的个数，运行期间可通过SET buffer_pool_size调整，上限为BUFFER_POOL_MAX_SIZE
+ * @param {string} &replacer_type 缓冲池的置换策略
+ * @param {size_t} num_partitions 缓冲池的分区个数
+ */
+void init_managers(size_t pool_size, const std::string &replacer_type, size_t num_partitions) {
+    disk_manager = std::make_unique<DiskManager>();
+    buffer_pool_manager = std::make_unique<BufferPoolManager>(
+        pool_size, disk_manager.get(), replacer_type, num_partitions,
+        std::max(pool_size, static_cast<size_t>(BUFFER_POOL_MAX_SIZE)));
+    buffer_pool_manager->start_page_cleaner();
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(),
+                                             ix_manager.get());
+    lock_manager = std::make_unique<LockManager>();
+    txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+    ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
+    log_manager = std::make_unique<LogManager>(disk_manager.get());
+    recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
+    planner = std::make_unique<Planner>(sm_manager.get());
+    optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
+    portal = std::make_unique<Portal>(sm_manager.get());
+    analyze = std::make_unique<Analyze>(sm_manager.get());
+}
+
 static jmp_buf jmpbuf;
 void sigint_handler(int signo) {
     should_exit = true;
@@ -137,7 +164,7 @@ void *client_handler(void *sock_fd) {
                     // portal
                     std::shared_ptr<PortalStmt> portalStmt = portal->start(plan, context);
                     portal->run(portalStmt, ql_manager.get(), &txn_id, context);
-                    portal->drop();
+                    portal->drop(portalStmt, context);
                 } catch (TransactionAbortException &e) {
                     // 事务需要回滚，需要把abort信息返回给客户端并写入output.txt文件中
                     std::string str = "abort\n";
@@ -177,6 +204,7 @@ void *client_handler(void *sock_fd) {
         // future TODO: 格式化 sql_handler.result, 传给客户端
         // send result with fixed format, use protobuf in the future
         if (write(fd, data_send, offset + 1) == -1) {
+            delete context;
             break;
         }
         // 如果是单条语句，需要按照一个完整的事务来执行，所以执行完当前语句后，自动提交事务
@@ -184,6 +212,8 @@ void *client_handler(void *sock_fd) {
         // {
         //     txn_manager->commit(context->txn_, context->log_mgr_);
         // }
+        // 出错时没有执行portal->drop，arena随context一起释放
+        delete context;
     }
 
     // Clear
@@ -263,11 +293,42 @@ void start_server() {
     std::cout << "Server shuts down." << std::endl;
 }
 
+static void usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [-b frames] [-r LRU|CLOCK|LRU-K|2Q] [-p partitions] [-d] [-a] <database>" << std::endl;
+    exit(1);
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    size_t pool_size = BUFFER_POOL_SIZE;
+    std::string replacer_type = REPLACER_TYPE;
+    size_t num_partitions = BUFFER_POOL_PARTITIONS;
+    bool direct_io = USE_DIRECT_IO;
+    bool async_io = USE_ASYNC_IO;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:r:p:da")) != -1) {
+        switch (opt) {
+            case 'b':
+                pool_size = strtoul(optarg, nullptr, 10);
+                break;
+            case 'r':
+                replacer_type = optarg;
+                break;
+            case 'p':
+                num_partitions = strtoul(optarg, nullptr, 10);
+                break;
+            case 'd':
+                direct_io = true;
+                break;
+            case 'a':
+                async_io = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) {
         // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
-        exit(1);
+        usage(argv[0]);
     }
 
     signal(SIGINT, sigint_handler);
@@ -283,14 +344,27 @@ int main(int argc, char **argv) {
                      "Welcome to RMDB!\n"
                      "Type 'help;' for help.\n"
                      "\n";
+        init_managers(pool_size, replacer_type, num_partitions);
+        disk_manager->set_direct_io(direct_io);
+        if (async_io) {
+            // 缓冲池未命中时的读和脏页写回交给io_uring（不可用时为线程池）完成
+            disk_manager->enable_async_io();
+        }
+        std::cout << "Buffer pool: " << pool_size << " frames in " << num_partitions << " partitions, replacer "
+                  << replacer_type << (direct_io ? ", direct I/O" : "") << ", " << disk_manager->async_io_backend()
+                  << " I/O" << std::endl;
         // Database name is passed by args
-        std::string db_name = argv[1];
+        std::string db_name = argv[optind];
         if (!sm_manager->is_dir(db_name)) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
         }
         // Open database
         sm_manager->open_db(db_name);
+        // 定期把缓冲池的统计信息追加到数据库目录下的文件中，也可以用show bufferpool查看
+        if (BUFFER_POOL_STATS_INTERVAL_SEC > 0) {
+            buffer_pool_manager->start_stats_dump(BUFFER_POOL_STATS_FILE_NAME);
+        }
 
         // recovery database
         recovery->analyze();
@@ -0,0 +1,298 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/async_io.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "errors.h"
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+int sys_io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+/**
+ * @description: 以pread/pwrite同步执行一次请求，不足的部分继续读写，直到完成、出错或读到文件末尾
+ * @return {ssize_t} 实际读写的字节数，出错时为-errno
+ */
+ssize_t do_sync_io(const AsyncIoRequest &req) {
+    size_t done = 0;
+    while (done < req.len) {
+        ssize_t n = req.op == IO_OP_READ ? pread(req.fd, req.buf + done, req.len - done, req.offset + done)
+                                         : pwrite(req.fd, req.buf + done, req.len - done, req.offset + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        if (n == 0) break;
+        done += n;
+    }
+    return (ssize_t)done;
+}
+
+}  // namespace
+
+std::unique_ptr<AsyncIoEngine> AsyncIoEngine::create(IoBackendType backend, int queue_depth, int num_threads) {
+    if (backend != IO_BACKEND_THREAD_POOL) {
+        try {
+            return std::make_unique<IoUringEngine>(queue_depth);
+        } catch (UnixError &e) {
+            if (backend == IO_BACKEND_URING) {
+                throw;
+            }
+        }
+    }
+    return std::make_unique<ThreadPoolIoEngine>(num_threads);
+}
+
+/* ---------------------------------------- 线程池后端 ---------------------------------------- */
+
+ThreadPoolIoEngine::ThreadPoolIoEngine(int num_threads) {
+    for (int i = 0; i < num_threads; i++) {
+        workers_.emplace_back(&ThreadPoolIoEngine::worker_loop, this);
+    }
+}
+
+ThreadPoolIoEngine::~ThreadPoolIoEngine() {
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPoolIoEngine::submit(AsyncIoRequest request) {
+    {
+        std::scoped_lock lock(mutex_);
+        queue_.push_back(std::move(request));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPoolIoEngine::worker_loop() {
+    while (true) {
+        AsyncIoRequest req;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            // 退出前先处理完队列中剩余的请求，保证每个提交者都能被唤醒
+            if (queue_.empty()) return;
+            req = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        req.handle->complete(do_sync_io(req));
+    }
+}
+
+/* ---------------------------------------- io_uring后端 ---------------------------------------- */
+
+/**
+ * @description: io_uring在用户态映射的SQ/CQ环形队列
+ */
+struct IoUringEngine::Ring {
+    int fd = -1;
+    void *sq_ptr = MAP_FAILED;
+    size_t sq_map_size = 0;
+    void *cq_ptr = MAP_FAILED;
+    size_t cq_map_size = 0;
+    struct io_uring_sqe *sqes = static_cast<struct io_uring_sqe *>(MAP_FAILED);
+    size_t sqes_map_size = 0;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    unsigned cq_entries;
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_map_size);
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_map_size);
+        if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_map_size);
+        if (fd >= 0) close(fd);
+    }
+};
+
+// user_data为0的NOP请求用于通知收割线程退出
+static constexpr uint64_t URING_SHUTDOWN_TAG = 0;
+
+IoUringEngine::IoUringEngine(int queue_depth) : ring_(std::make_unique<Ring>()) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_->fd = sys_io_uring_setup(queue_depth, &params);
+    if (ring_->fd < 0) {
+        throw UnixError();
+    }
+
+    ring_->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring_->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        ring_->sq_map_size = ring_->cq_map_size = std::max(ring_->sq_map_size, ring_->cq_map_size);
+    }
+    ring_->sq_ptr = mmap(nullptr, ring_->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_->fd,
+                         IORING_OFF_SQ_RING);
+    if (ring_->sq_ptr == MAP_FAILED) {
+        throw UnixError();
+    }
+    if (single_mmap) {
+        ring_->cq_ptr = ring_->sq_ptr;
+    } else {
+        ring_->cq_ptr = mmap(nullptr, ring_->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ring_->fd, IORING_OFF_CQ_RING);
+        if (ring_->cq_ptr == MAP_FAILED) {
+            throw UnixError();
+        }
+    }
+    ring_->sqes_map_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, ring_->sqes_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_->fd,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        throw UnixError();
+    }
+    ring_->sqes = static_cast<struct io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(ring_->sq_ptr);
+    ring_->sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    ring_->sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    ring_->sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    ring_->sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    ring_->sq_entries = params.sq_entries;
+    char *cq = static_cast<char *>(ring_->cq_ptr);
+    ring_->cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    ring_->cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    ring_->cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    ring_->cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    ring_->cq_entries = params.cq_entries;
+
+    // 在途请求数不超过SQ大小（CQ至少是SQ的两倍），收割线程的关闭请求也总有位置
+    max_inflight_ = params.sq_entries - 1;
+    reaper_ = std::thread(&IoUringEngine::reap_loop, this);
+}
+
+IoUringEngine::~IoUringEngine() {
+    {
+        std::unique_lock<std::mutex> lock(submit_mutex_);
+        // 等待所有在途请求完成后再通知收割线程退出
+        inflight_cv_.wait(lock, [this] { return inflight_ == 0; });
+        push_sqe(IORING_OP_NOP, -1, nullptr, 0, 0, URING_SHUTDOWN_TAG);
+    }
+    reaper_.join();
+}
+
+/**
+ * @description: 向SQ中写入一个请求并通知内核，调用者需持有submit_mutex_
+ */
+void IoUringEngine::push_sqe(uint8_t opcode, int fd, char *buf, size_t len, off_t offset, uint64_t user_data) {
+    unsigned tail = *ring_->sq_tail;
+    unsigned index = tail & *ring_->sq_mask;
+    struct io_uring_sqe *sqe = &ring_->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = (uint32_t)len;
+    sqe->off = (uint64_t)offset;
+    sqe->user_data = user_data;
+    ring_->sq_array[index] = index;
+    __atomic_store_n(ring_->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    // 没有使用SQPOLL，每次提交都由io_uring_enter把SQE交给内核，因此SQ不会被填满
+    int ret;
+    do {
+        ret = sys_io_uring_enter(ring_->fd, 1, 0, 0);
+    } while (ret < 0 && (errno == EINTR || errno == EAGAIN));
+    if (ret < 0) {
+        throw UnixError();
+    }
+}
+
+void IoUringEngine::submit(AsyncIoRequest request) {
+    auto *req = new AsyncIoRequest(std::move(request));
+    std::unique_lock<std::mutex> lock(submit_mutex_);
+    inflight_cv_.wait(lock, [this] { return inflight_ < max_inflight_; });
+    inflight_++;
+    try {
+        push_sqe(req->op == IO_OP_READ ? IORING_OP_READ : IORING_OP_WRITE, req->fd, req->buf, req->len,
+                 req->offset, reinterpret_cast<uint64_t>(req));
+    } catch (UnixError &e) {
+        inflight_--;
+        lock.unlock();
+        inflight_cv_.notify_all();
+        delete req;
+        throw;
+    }
+}
+
+void IoUringEngine::reap_loop() {
+    while (true) {
+        int ret = sys_io_uring_enter(ring_->fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR && errno != EAGAIN) {
+            // 收割线程无法继续工作，只能终止进程，否则等待者会永远阻塞
+            perror("io_uring_enter");
+            std::terminate();
+        }
+        unsigned head = *ring_->cq_head;
+        unsigned tail = __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE);
+        bool shutdown = false;
+        unsigned completed = 0;
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &ring_->cqes[head & *ring_->cq_mask];
+            if (cqe->user_data == URING_SHUTDOWN_TAG) {
+                shutdown = true;
+                continue;
+            }
+            auto *req = reinterpret_cast<AsyncIoRequest *>(cqe->user_data);
+            ssize_t result = cqe->res;
+            // io_uring对普通文件也可能返回短读写，剩余部分同步补齐，保证语义与pread/pwrite一致
+            if (result >= 0 && (size_t)result < req->len && !(req->op == IO_OP_READ && result == 0)) {
+                AsyncIoRequest rest = *req;
+                rest.buf += result;
+                rest.len -= result;
+                rest.offset += result;
+                ssize_t more = do_sync_io(rest);
+                result = more < 0 ? more : result + more;
+            }
+            req->handle->complete(result);
+            delete req;
+            completed++;
+        }
+        __atomic_store_n(ring_->cq_head, head, __ATOMIC_RELEASE);
+        if (completed > 0) {
+            {
+                std::scoped_lock lock(submit_mutex_);
+                inflight_ -= completed;
+            }
+            inflight_cv_.notify_all();
+        }
+        if (shutdown) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,169 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @description: 异步I/O的后端类型
+ * IO_BACKEND_AUTO会优先尝试io_uring，内核不支持（或被禁用）时退回线程池
+ */
+enum IoBackendType { IO_BACKEND_AUTO, IO_BACKEND_URING, IO_BACKEND_THREAD_POOL };
+
+enum IoOpType { IO_OP_READ, IO_OP_WRITE };
+
+/**
+ * @description: 一次异步I/O请求的完成状态，由提交者持有
+ * I/O完成时在完成线程中先调用callback，再唤醒所有等待者；
+ * callback中不允许抛出异常，也不能再提交新的I/O（完成线程被阻塞时会造成死锁）
+ */
+class AsyncIoHandle {
+   public:
+    using Callback = std::function<void(ssize_t)>;
+
+    explicit AsyncIoHandle(Callback callback = nullptr) : callback_(std::move(callback)) {}
+
+    /**
+     * @description: 阻塞等待I/O完成
+     * @return {ssize_t} 实际读写的字节数，出错时为-errno
+     */
+    ssize_t wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return done_; });
+        return result_;
+    }
+
+    bool is_done() {
+        std::scoped_lock lock(mutex_);
+        return done_;
+    }
+
+    /**
+     * @description: 由I/O引擎在请求完成时调用
+     * @param {ssize_t} result 实际读写的字节数，出错时为-errno
+     */
+    void complete(ssize_t result) {
+        if (callback_) {
+            callback_(result);
+        }
+        {
+            std::scoped_lock lock(mutex_);
+            result_ = result;
+            done_ = true;
+        }
+        cv_.notify_all();
+    }
+
+   private:
+    Callback callback_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_ = false;
+    ssize_t result_ = 0;
+};
+
+/**
+ * @description: 一次异步读写请求，buf在请求完成前必须保持有效
+ */
+struct AsyncIoRequest {
+    IoOpType op;
+    int fd;
+    char *buf;
+    size_t len;
+    off_t offset;
+    std::shared_ptr<AsyncIoHandle> handle;
+};
+
+/**
+ * @description: 异步I/O引擎的抽象接口，submit立即返回，完成结果通过AsyncIoHandle通知
+ */
+class AsyncIoEngine {
+   public:
+    virtual ~AsyncIoEngine() = default;
+
+    virtual void submit(AsyncIoRequest request) = 0;
+
+    virtual const char *name() const = 0;
+
+    /**
+     * @description: 创建异步I/O引擎
+     * @return {unique_ptr<AsyncIoEngine>} 创建的引擎，io_uring不可用时按backend决定是否退回线程池
+     * @param {IoBackendType} backend 期望使用的后端
+     * @param {int} queue_depth io_uring队列深度，即同时在途请求数的上限
+     * @param {int} num_threads 线程池后端的工作线程数
+     */
+    static std::unique_ptr<AsyncIoEngine> create(IoBackendType backend, int queue_depth, int num_threads);
+};
+
+/**
+ * @description: 线程池后端，工作线程以pread/pwrite同步完成请求
+ */
+class ThreadPoolIoEngine : public AsyncIoEngine {
+   public:
+    explicit ThreadPoolIoEngine(int num_threads);
+
+    ~ThreadPoolIoEngine() override;
+
+    void submit(AsyncIoRequest request) override;
+
+    const char *name() const override { return "thread_pool"; }
+
+   private:
+    void worker_loop();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<AsyncIoRequest> queue_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+};
+
+/**
+ * @description: io_uring后端，直接使用io_uring_setup/io_uring_enter系统调用，不依赖liburing
+ * 提交线程写SQ，单独的收割线程阻塞在io_uring_enter上等待CQ中的完成事件
+ */
+class IoUringEngine : public AsyncIoEngine {
+   public:
+    /**
+     * @description: 初始化io_uring，失败时抛出UnixError（如内核不支持或被seccomp禁用）
+     * @param {int} queue_depth 提交队列大小
+     */
+    explicit IoUringEngine(int queue_depth);
+
+    ~IoUringEngine() override;
+
+    void submit(AsyncIoRequest request) override;
+
+    const char *name() const override { return "io_uring"; }
+
+   private:
+    struct Ring;
+
+    void push_sqe(uint8_t opcode, int fd, char *buf, size_t len, off_t offset, uint64_t user_data);
+
+    void reap_loop();
+
+    std::unique_ptr<Ring> ring_;
+    std::mutex submit_mutex_;                // 保护SQ的生产端和在途请求计数
+    std::condition_variable inflight_cv_;    // 在途请求达到上限时提交者在此等待，避免CQ溢出
+    unsigned inflight_ = 0;
+    unsigned max_inflight_ = 0;
+    std::thread reaper_;
+};
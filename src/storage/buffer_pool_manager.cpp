@@ -10,85 +10,52 @@ See the Mulan PSL v2 for more details. */
 
 #include "buffer_pool_manager.h"
 
+#include <algorithm>
+
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
- * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
- * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ * @description: 计算页面所属的分区
+ * PageIdHash对fd和page_no做了充分混合，按其低位取模即可使同一文件的连续页面均匀地分布到各个分区；
+ * 分区内的PageTable使用哈希值的高位，不受分区选择的影响
+ * @return {size_t} 分区下标
+ * @param {PageId} page_id 页面
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
-    // Todo:
-    // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
-    // 1.1 未满获得frame
-    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
-    if (!free_list_.empty()) {
-    //    std::scoped_lock lock(latch_);
-       *frame_id = free_list_.front();
-        free_list_.pop_front();
-        return true;
-    }
-
-    return replacer_->victim(frame_id);
+size_t BufferPoolManager::partition_index(PageId page_id) const {
+    if (partitions_.size() == 1) {
+        return 0;
+    }
+    return PageIdHash()(page_id) % partitions_.size();
 }
 
-/**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
- * @param {PageId} new_page_id 新的page_id
- * @param {frame_id_t} new_frame_id 新的帧frame_id
- */
-// void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    // Todo:
-    // 1 如果是脏页，写回磁盘，并且把dirty置为false
-    // 2 更新page table
-    // 3 重置page的data，更新page id
+size_t BufferPoolManager::get_prefetch_issued() const {
+    size_t total = 0;
+    for (auto &partition : partitions_) {
+        total += partition->prefetch_issued_;
+    }
+    return total;
+}
+
+size_t BufferPoolManager::get_prefetch_hits() const {
+    size_t total = 0;
+    for (auto &partition : partitions_) {
+        total += partition->prefetch_hits_;
+    }
+    return total;
+}
 
-// }
+size_t BufferPoolManager::get_prefetch_wasted() const {
+    size_t total = 0;
+    for (auto &partition : partitions_) {
+        total += partition->prefetch_wasted_;
+    }
+    return total;
+}
 
 /**
- * @description: 从buffer pool获取需要的页。
- *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
- *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ * @description: 从buffer pool获取需要的页，只需持有目标页所在分区的latch
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
-    std::scoped_lock lock(latch_);
-    //Todo:
-    // 1.     从page_table_中搜寻目标页
-    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
-    // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    // 2.     若获得的可用frame存储的为dirty page，则须调用write_page将page写回到磁盘
-    // 3.     调用disk_manager_的read_page读取目标页到frame
-    // 4.     固定目标页，更新pin_count_
-    // 5.     返回目标页
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
-        Page *page = &pages_[it->second];
-        page->pin_count_++;
-        replacer_->pin(it->second);
-        return page;
-    }
-
-    frame_id_t victim_frame;
-    if (!find_victim_page(&victim_frame)) {
-        return nullptr;
-    }
-    Page *victim_page = &pages_[victim_frame];
-    if (victim_page->is_dirty_) {
-        disk_manager_->write_page(victim_page->id_.fd, victim_page->id_.page_no, victim_page->data_, PAGE_SIZE);
-        victim_page->is_dirty_ = false;
-    }
-
-    page_table_.erase(victim_page->id_);
-    disk_manager_->read_page(page_id.fd, page_id.page_no, victim_page->data_, PAGE_SIZE);
-    
-    victim_page->pin_count_ = 1;
-    victim_page->is_dirty_ = false;
-    victim_page->id_ = page_id;
-    page_table_[page_id] = victim_frame;
-    replacer_->pin(victim_frame);
-    return victim_page;
-}
+Page* BufferPoolManager::fetch_page(PageId page_id) { return partition_of(page_id)->fetch_page(page_id); }
 
 /**
  * @description: 取消固定pin_count>0的在缓冲池中的page
@@ -97,32 +64,7 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
  * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
  */
 bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    // Todo:
-    // 0. lock latch
-    // 1. 尝试在page_table_中搜寻page_id对应的页P
-    // 1.1 P在页表中不存在 return false
-    // 1.2 P在页表中存在，获取其pin_count_
-    // 2.1 若pin_count_已经等于0，则返回false
-    // 2.2 若pin_count_大于0，则pin_count_自减一
-    // 2.2.1 若自减后等于0，则调用replacer_的Unpin
-    // 3 根据参数is_dirty，更改P的is_dirty_
-    std::scoped_lock lock(latch_); 
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return false; // Page not found
-    }
-    Page *page = &pages_[it->second];
-    if (page->pin_count_ <= 0) {
-        return false; // Page already unpinned
-    }
-    page->pin_count_--;
-    if (page->pin_count_ == 0) {
-        replacer_->unpin(it->second);
-    }
-    
-    page->is_dirty_ |= is_dirty;
-
-    return true;
+    return partition_of(page_id)->unpin_page(page_id, is_dirty);
 }
 
 /**
@@ -130,104 +72,271 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
  * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
  * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
  */
-bool BufferPoolManager::flush_page(PageId page_id) {
-    // Todo:
-    // 0. lock latch
-    // 1. 查找页表,尝试获取目标页P
-    // 1.1 目标页P没有被page_table_记录 ，返回false
-    // 2. 无论P是否为脏都将其写回磁盘。
-    // 3. 更新P的is_dirty_
-    std::scoped_lock lock(latch_); 
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return false; // Page not found
-    }
-    Page *page = &pages_[it->second];
-    
-    disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-    page->is_dirty_ = false; // Reset dirty flag
-    return true;
-}
+bool BufferPoolManager::flush_page(PageId page_id) { return partition_of(page_id)->flush_page(page_id); }
+
+/**
+ * @description: 从buffer_pool删除目标页
+ * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolManager::delete_page(PageId page_id) { return partition_of(page_id)->delete_page(page_id); }
 
 /**
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
+ * 先由DiskManager原子地分配页号，再交给页号所属的分区获取帧，不同文件、不同分区的new_page互不阻塞；
+ * 分区没有可用的帧或写回淘汰页失败时，把页号还给DiskManager
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
  */
 Page* BufferPoolManager::new_page(PageId* page_id) {
-    std::scoped_lock lock(latch_);
-    // 1.   获得一个可用的frame，若无法获得则返回nullptr
-    // 2.   在fd对应的文件分配一个新的page_id
-    // 3.   将frame的数据写回磁盘
-    // 4.   固定frame，更新pin_count_
-    // 5.   返回获得的page
+    page_id->page_no = disk_manager_->allocate_page(page_id->fd);
+    Page *page;
+    try {
+        page = partition_of(*page_id)->new_page(*page_id);
+    } catch (RMDBError &e) {
+        disk_manager_->release_page(page_id->fd, page_id->page_no);
+        throw;
+    }
+    if (page == nullptr) {
+        disk_manager_->release_page(page_id->fd, page_id->page_no);
+    }
+    return page;
+}
 
+/**
+ * @description: 将文件中[start_page_no, start_page_no + num_pages)内尚未缓存的页面预读到缓冲池中
+ * 预读的页面不被固定，直接交给replacer管理；连续缺失的页面合并为一次preadv读取。
+ * 这些页面分散在多个分区中：逐个页面只持有其所在分区的latch，为它占用一个帧并置为io_pending，
+ * 然后在不持有latch时写回被淘汰的脏页、读入数据，最后逐个分区完成这些帧。
+ * claim_frame可能在释放latch后等待后台清理线程，因此不能同时持有多个分区的latch，否则会与清理线程死锁
+ * @return {int} 实际载入的页面数，可用帧不足时会提前结束
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 起始页号
+ * @param {int} num_pages 预读的页面数
+ */
+int BufferPoolManager::prefetch_pages(int fd, page_id_t start_page_no, int num_pages) {
+    struct Reservation {
+        BufferPoolPartition *partition;
+        frame_id_t frame_id;
+        PageId page_id;
+        PageId victim_id;   // 被淘汰的页面
+        bool write_back;    // 被淘汰的页面是否需要写回
+    };
+    std::vector<std::vector<Reservation>> runs(1);  // 连续缺失的页面组成一段
 
-    frame_id_t frame_id;
-    if (!find_victim_page(&frame_id)) {
-        return nullptr;
+    for (page_id_t page_no = start_page_no; page_no < start_page_no + num_pages; page_no++) {
+        PageId page_id{fd, page_no};
+        BufferPoolPartition *partition = partition_of(page_id);
+        std::unique_lock<TimedMutex> lock(partition->latch_);
+        if (partition->page_table_.contains(page_id)) {
+            if (!runs.back().empty()) {
+                runs.emplace_back();
+            }
+            continue;
+        }
+        frame_id_t frame_id;
+        if (!partition->claim_frame(lock, &frame_id)) {
+            break;
+        }
+        if (partition->page_table_.contains(page_id)) {
+            // 占用帧时释放过该分区的latch_，其间目标页已被其他线程载入
+            partition->unclaim_frame(frame_id);
+            if (!runs.back().empty()) {
+                runs.emplace_back();
+            }
+            continue;
+        }
+        partition->page_table_.insert(page_id, frame_id);
+        Page *page = &partition->pages_[frame_id];
+        runs.back().push_back({partition, frame_id, page_id, page->id_, page->is_dirty_});
     }
-    page_id->page_no = disk_manager_->allocate_page(page_id->fd);
 
-    Page *page = &pages_[frame_id];
-    if (page->is_dirty_) {
-        disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
+    int loaded = 0;
+    for (auto &run : runs) {
+        if (run.empty()) continue;
+        std::vector<char *> bufs;
+        std::vector<bool> written(run.size(), true);
+        bool ok = true;
+        for (size_t i = 0; i < run.size(); i++) {
+            Page *page = &run[i].partition->pages_[run[i].frame_id];
+            bufs.push_back(page->data_);
+            if (!run[i].write_back) continue;
+            try {
+                run[i].partition->write_frame(run[i].victim_id, page->data_);
+            } catch (RMDBError &e) {
+                written[i] = false;
+                ok = false;  // 该帧中仍是未写回的旧页面，不能再读入数据覆盖它
+            }
+        }
+        if (ok) {
+            try {
+                uint64_t start = stats_now_ns();
+                disk_manager_->read_pages(fd, run[0].page_id.page_no, bufs.data(), (int)run.size());
+                counters_.read_latency.record(stats_now_ns() - start);
+            } catch (InternalError &e) {
+                ok = false;
+            }
+        }
+        for (size_t i = 0; i < run.size(); i++) {
+            std::scoped_lock lock(run[i].partition->latch_);
+            if (run[i].write_back && written[i]) {
+                run[i].partition->file_stats(run[i].victim_id.fd).writebacks++;
+            }
+            run[i].partition->complete_frame(run[i].frame_id, run[i].page_id, written[i], ok, true);
+        }
+        if (ok) {
+            loaded += (int)run.size();
+        }
+    }
+    return loaded;
+}
+
+/**
+ * @description: 将buffer_pool中属于指定文件的所有页写回到磁盘，并将它们移出缓冲池
+ * 按页号排序后把连续的页面合并为一次pwritev，O_DIRECT文件最后只做一次fdatasync；期间按下标顺序持有所有分区的latch。
+ * 若有分区存在进行中的I/O，先释放全部latch单独等待该分区，避免与逐个分区完成预读的线程互相等待
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolManager::flush_all_pages(int fd) {
+    std::vector<std::unique_lock<TimedMutex>> locks;
+    while (true) {
+        for (auto &partition : partitions_) {
+            locks.emplace_back(partition->latch_);
+        }
+        auto busy = std::find_if(partitions_.begin(), partitions_.end(),
+                                 [](const std::unique_ptr<BufferPoolPartition> &p) { return p->num_pending_io_ > 0; });
+        if (busy == partitions_.end()) {
+            break;
+        }
+        locks.clear();
+        std::unique_lock<TimedMutex> lock((*busy)->latch_);
+        (*busy)->wait_for_io(lock);
+    }
+    std::vector<Page *> pages;
+    for (auto &partition : partitions_) {
+        partition->collect_file_pages(fd, pages);
+    }
+    std::sort(pages.begin(), pages.end(),
+              [](const Page *a, const Page *b) { return a->id_.page_no < b->id_.page_no; });
+
+    std::vector<char *> bufs;
+    bufs.reserve(pages.size());
+    size_t run_start = 0;
+    for (size_t i = 0; i < pages.size(); i++) {
+        bufs.push_back(pages[i]->data_);
+        bool run_ends = i + 1 == pages.size() || pages[i + 1]->id_.page_no != pages[i]->id_.page_no + 1;
+        if (run_ends) {
+            uint64_t start = stats_now_ns();
+            disk_manager_->write_pages(fd, pages[run_start]->id_.page_no, bufs.data() + run_start,
+                                       (int)(i + 1 - run_start));
+            counters_.write_latency.record(stats_now_ns() - start);
+            counters_.writebacks.fetch_add(i + 1 - run_start, std::memory_order_relaxed);
+            run_start = i + 1;
+        }
     }
-    page_table_.erase(page->id_);
-    page_table_[*page_id] = frame_id;
 
-    page->reset_memory();
-    page->pin_count_ = 1;
-    page->is_dirty_ = false;
-    page->id_ = *page_id;
+    disk_manager_->sync_file(fd);
 
-    replacer_->pin(frame_id);
-    return page;
+    for (auto &partition : partitions_) {
+        partition->drop_file_pages(fd);
+    }
 }
 
 /**
- * @description: 从buffer_pool删除目标页
- * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
- * @param {PageId} page_id 目标页
+ * @description: 在线调整缓冲池的帧数，新的帧数平均分给各个分区，由各分区依次完成扩大或缩小。
+ * 缩小时需要等待被回收的帧上的页面解除固定，调用者不能持有缓冲池中任何页面的pin；
+ * 某个分区写回脏页失败时抛出异常，已经完成调整的分区保持新的帧数
+ * @param {size_t} new_pool_size 新的帧数，不能小于分区个数，也不能超过max_pool_size
+ */
+void BufferPoolManager::resize(size_t new_pool_size) {
+    std::scoped_lock lock(resize_latch_);
+    if (new_pool_size < partitions_.size() || new_pool_size > max_pool_size_) {
+        throw InternalError("BufferPoolManager: pool size must be between " + std::to_string(partitions_.size()) +
+                            " and " + std::to_string(max_pool_size_));
+    }
+    try {
+        for (size_t i = 0; i < partitions_.size(); i++) {
+            partitions_[i]->resize(partition_share(new_pool_size, partitions_.size(), i));
+        }
+    } catch (RMDBError &e) {
+        size_t total = 0;
+        for (auto &partition : partitions_) {
+            total += partition->get_pool_size();
+        }
+        pool_size_ = total;
+        throw;
+    }
+    pool_size_ = new_pool_size;
+}
+
+/**
+ * @description: 汇总各分区的统计信息，各分区分别加锁，因此不是一个严格一致的快照
+ * @return {BufferPoolStats} 统计信息
  */
-bool BufferPoolManager::delete_page(PageId page_id) {
-    std::scoped_lock lock(latch_);
-    // 1.   在page_table_中查找目标页，若不存在返回true
-    // 2.   若目标页的pin_count不为0，则返回false
-    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
-
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return true; // Page not found, already deleted
-    }
-    Page *page = &pages_[it->second];
-    if (page->pin_count_ != 0) {
-        return false; // Page is pinned, cannot delete
-    }
-    if (page->is_dirty_) {
-        disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-    }
-    page_table_.erase(it);
-    free_list_.push_back(it->second);
-    page->reset_memory();
-    disk_manager_->deallocate_page(page->id_.page_no);    
-    return true;
+BufferPoolStats BufferPoolManager::get_stats() const {
+    BufferPoolStats stats;
+    stats.pool_size = pool_size_;
+    stats.num_partitions = partitions_.size();
+    for (auto &partition : partitions_) {
+        partition->collect_stats(&stats);
+    }
+    stats.writebacks += counters_.writebacks.load(std::memory_order_relaxed);
+    LatencySnapshot latency;
+    counters_.read_latency.snapshot(&latency);
+    stats.read_latency.merge(latency);
+    counters_.write_latency.snapshot(&latency);
+    stats.write_latency.merge(latency);
+    return stats;
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
- * @param {int} fd 文件句柄
+ * @description: 启动定期输出统计信息的线程，已启动时先停止原来的线程
+ * @param {string&} path 输出文件的路径
+ * @param {int} interval_sec 输出的间隔，单位秒
  */
-void BufferPoolManager::flush_all_pages(int fd) {
-    // 将缓冲池中属于指定⽂件的所有⻚⾯都刷写到磁盘。参数和返回值的含义参考代码注释。
-    for (auto it = page_table_.begin(); it != page_table_.end();) {
-        Page *page = &pages_[it->second];
-        if (page->id_.fd == fd) {
-            disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-            page->is_dirty_ = false;
-            it = page_table_.erase(it);
-        } else {
-            ++it;
+void BufferPoolManager::start_stats_dump(const std::string &path, int interval_sec) {
+    stop_stats_dump();
+    stats_dumper_ = std::make_unique<StatsDumper>(
+        [this]() {
+            return get_stats().to_string([this](int fd) {
+                try {
+                    return disk_manager_->get_file_name(fd);
+                } catch (RMDBError &e) {
+                    return std::to_string(fd);
+                }
+            });
+        },
+        path, interval_sec);
+}
+
+size_t BufferPoolManager::get_dirty_page_count() const {
+    size_t total = 0;
+    for (auto &partition : partitions_) {
+        total += partition->count_dirty_pages();
+    }
+    return total;
+}
+
+/**
+ * @description: 执行一轮后台清理：脏页比例超过dirty_ratio的分区从replacer的冷端写回脏页，直到降到目标值
+ * 各轮从不同的分区开始，避免配额总是被前面的分区用完
+ * @return {size_t} 本轮写回的页面数
+ * @param {double} dirty_ratio 每个分区脏页比例的目标值
+ * @param {size_t} max_pages 本轮最多写回的页面数
+ */
+size_t BufferPoolManager::clean_pages(double dirty_ratio, size_t max_pages) {
+    bool check_lsn = static_cast<bool>(persist_lsn_fn_);
+    lsn_t persist_lsn = check_lsn ? persist_lsn_fn_() : INVALID_LSN;
+    size_t written = 0;
+    size_t start = next_clean_partition_++;
+    for (size_t i = 0; i < partitions_.size() && written < max_pages; i++) {
+        BufferPoolPartition *partition = partitions_[(start + i) % partitions_.size()].get();
+        size_t target = static_cast<size_t>(dirty_ratio * partition->get_pool_size());
+        size_t num_dirty = partition->count_dirty_pages();
+        if (num_dirty <= target) {
+            continue;
         }
+        written += partition->clean_pages(std::min(num_dirty - target, max_pages - written), check_lsn, persist_lsn);
     }
-}
\ No newline at end of file
+    return written;
+}
@@ -12,49 +12,69 @@ See the Mulan PSL v2 for more details. */
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <list>
-#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "buffer_pool_partition.h"
+#include "buffer_pool_stats.h"
 #include "disk_manager.h"
 #include "errors.h"
 #include "page.h"
-#include "replacer/lru_replacer.h"
-#include "replacer/replacer.h"
+#include "page_cleaner.h"
 
+/**
+ * @description: 缓冲池，由若干个互相独立的BufferPoolPartition组成
+ * 每个PageId经哈希后落到唯一的分区，fetch_page/unpin_page等操作只需持有该分区的latch，
+ * 因此不同分区上的访问可以并行；只有按文件批量读写的操作需要同时持有多个分区的latch
+ */
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    std::atomic<size_t> pool_size_;     // buffer_pool中可容纳页面的个数，即所有分区帧的个数之和
+    size_t max_pool_size_;              // resize可扩展到的最大帧数
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::vector<std::unique_ptr<BufferPoolPartition>> partitions_;
+    std::mutex resize_latch_;       // 串行化resize
+    std::function<lsn_t()> persist_lsn_fn_;     // 返回已持久化的最大日志号，启用WAL后由日志管理器设置
+    std::atomic<size_t> next_clean_partition_{0};    // 下一轮清理从该分区开始，使各分区轮流获得写回配额
+    std::unique_ptr<PageCleaner> page_cleaner_;
+    BufferPoolCounters counters_;       // 跨分区的批量读写（预读、按文件刷盘）的I/O统计
+    std::unique_ptr<StatsDumper> stats_dumper_;
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
+    /**
+     * @description: 创建缓冲池
+     * @param {size_t} pool_size 缓冲池中帧的个数
+     * @param {DiskManager*} disk_manager
+     * @param {string} &replacer_type 置换策略，可选"LRU"、"CLOCK"、"LRU-K"、"2Q"
+     * @param {size_t} num_partitions 分区个数，各分区的帧数至多相差1
+     * @param {size_t} max_pool_size resize可扩展到的最大帧数，0表示等于pool_size。
+     * 帧数据的地址空间按该值预留，但只有实际使用过的帧占用物理内存
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, const std::string &replacer_type = REPLACER_TYPE,
+                      size_t num_partitions = 1, size_t max_pool_size = 0)
+        : pool_size_(pool_size), max_pool_size_(std::max(pool_size, max_pool_size)), disk_manager_(disk_manager) {
+        if (num_partitions == 0 || num_partitions > pool_size) {
+            throw InternalError("BufferPoolManager: invalid number of partitions");
         }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        // 机器有多个NUMA节点时，各分区的帧数据轮流绑定到不同的节点上
+        std::vector<int> numa_nodes = FrameArena::online_numa_nodes();
+        bool bind_numa = BUFFER_POOL_NUMA_AWARE && numa_nodes.size() > 1;
+        for (size_t i = 0; i < num_partitions; ++i) {
+            int numa_node = bind_numa ? numa_nodes[i % numa_nodes.size()] : -1;
+            partitions_.emplace_back(std::make_unique<BufferPoolPartition>(
+                partition_share(pool_size, num_partitions, i), disk_manager, replacer_type, numa_node,
+                partition_share(max_pool_size_, num_partitions, i)));
         }
     }
 
     ~BufferPoolManager() {
-        delete[] pages_;
-        delete replacer_;
+        stop_stats_dump();
+        stop_page_cleaner();
     }
 
     /**
@@ -63,9 +83,55 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_max_pool_size() const { return max_pool_size_; }
+
+    size_t get_num_partitions() const { return partitions_.size(); }
+
+    const BufferPoolPartition *get_partition(size_t index) const { return partitions_[index].get(); }
+
+    size_t get_prefetch_issued() const;
+
+    size_t get_prefetch_hits() const;
+
+    size_t get_prefetch_wasted() const;
+
+    size_t get_dirty_page_count() const;
+
+    /**
+     * @description: 启动后台页面清理线程，已启动时先停止原来的线程
+     * @param {double} dirty_ratio 脏页比例的目标值
+     * @param {size_t} max_pages_per_sec 每秒最多写回的页面数
+     */
+    void start_page_cleaner(double dirty_ratio = PAGE_CLEANER_DIRTY_RATIO,
+                            size_t max_pages_per_sec = PAGE_CLEANER_MAX_PAGES_PER_SEC) {
+        stop_page_cleaner();
+        page_cleaner_ = std::make_unique<PageCleaner>(this, dirty_ratio, max_pages_per_sec);
+    }
+
+    void stop_page_cleaner() { page_cleaner_.reset(); }
+
+    size_t get_pages_cleaned() const { return page_cleaner_ ? page_cleaner_->get_pages_written() : 0; }
+
+    /**
+     * @description: 设置已持久化日志号的来源。设置后后台清理线程只写回page_lsn不超过该日志号的页面，
+     * 保证日志先于数据页落盘；必须在启动清理线程之前设置
+     * @param {function<lsn_t()>} persist_lsn_fn 返回已持久化的最大日志号
+     */
+    void set_persist_lsn_source(std::function<lsn_t()> persist_lsn_fn) { persist_lsn_fn_ = std::move(persist_lsn_fn); }
+
+    BufferPoolStats get_stats() const;
+
+    void start_stats_dump(const std::string &path, int interval_sec = BUFFER_POOL_STATS_INTERVAL_SEC);
+
+    void stop_stats_dump() { stats_dumper_.reset(); }
+
    public: 
     Page* fetch_page(PageId page_id);
 
+    int prefetch_pages(int fd, page_id_t start_page_no, int num_pages);
+
     bool unpin_page(PageId page_id, bool is_dirty);
 
     bool flush_page(PageId page_id);
@@ -76,8 +142,21 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    void resize(size_t new_pool_size);
+
+    size_t clean_pages(double dirty_ratio, size_t max_pages);
+
+    static Replacer* create_replacer(const std::string& replacer_type, size_t pool_size) {
+        return BufferPoolPartition::create_replacer(replacer_type, pool_size);
+    }
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    size_t partition_index(PageId page_id) const;
+
+    /** @return 总帧数total平均分给num_partitions个分区时第index个分区的帧数，各分区至多相差1 */
+    static size_t partition_share(size_t total, size_t num_partitions, size_t index) {
+        return total / num_partitions + (index < total % num_partitions ? 1 : 0);
+    }
 
-    // void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+    BufferPoolPartition *partition_of(PageId page_id) const { return partitions_[partition_index(page_id)].get(); }
 };
\ No newline at end of file
@@ -0,0 +1,741 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "buffer_pool_partition.h"
+
+#include <algorithm>
+
+/**
+ * @description: 根据名称创建置换策略，名称不区分大小写
+ * @return {Replacer*} 创建的replacer，由调用者负责释放
+ * @param {string&} replacer_type "LRU"、"CLOCK"、"LRU-K"（或"LRUK"）、"2Q"
+ * @param {size_t} pool_size 缓冲池中帧的个数
+ */
+Replacer* BufferPoolPartition::create_replacer(const std::string& replacer_type, size_t pool_size) {
+    std::string type = replacer_type;
+    std::transform(type.begin(), type.end(), type.begin(), ::toupper);
+    if (type == "LRU") {
+        return new LRUReplacer(pool_size);
+    } else if (type == "CLOCK") {
+        return new ClockReplacer(pool_size);
+    } else if (type == "LRU-K" || type == "LRUK") {
+        return new LRUKReplacer(pool_size);
+    } else if (type == "2Q") {
+        return new TwoQReplacer(pool_size);
+    }
+    throw InternalError("BufferPoolManager: unknown replacer type " + replacer_type);
+}
+
+// 经由DiskManager的异步接口读写：开启异步I/O时由io_uring或线程池完成，本线程只等待完成；否则直接同步读写
+void BufferPoolPartition::read_frame(PageId page_id, char *data) {
+    uint64_t start = stats_now_ns();
+    disk_manager_->complete_io(disk_manager_->submit_read_page(page_id.fd, page_id.page_no, data));
+    counters_.read_latency.record(stats_now_ns() - start);
+}
+
+void BufferPoolPartition::write_frame(PageId page_id, const char *data) {
+    uint64_t start = stats_now_ns();
+    disk_manager_->complete_io(disk_manager_->submit_write_page(page_id.fd, page_id.page_no, data));
+    counters_.write_latency.record(stats_now_ns() - start);
+    counters_.writebacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ */
+bool BufferPoolPartition::find_victim_page(frame_id_t* frame_id) {
+    // Todo:
+    // 1 使用BufferPoolPartition::free_list_判断缓冲池是否已满需要淘汰页面
+    // 1.1 未满获得frame
+    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
+    if (!free_list_.empty()) {
+    //    std::scoped_lock lock(latch_);
+       *frame_id = free_list_.front();
+        free_list_.pop_front();
+        return true;
+    }
+
+    return replacer_->victim(frame_id);
+}
+
+/**
+ * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
+ * @param {Page*} page 写回页指针
+ * @param {PageId} new_page_id 新的page_id
+ * @param {frame_id_t} new_frame_id 新的帧frame_id
+ */
+// void BufferPoolPartition::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+    // Todo:
+    // 1 如果是脏页，写回磁盘，并且把dirty置为false
+    // 2 更新page table
+    // 3 重置page的data，更新page id
+
+// }
+
+/**
+ * @description: 从buffer pool获取需要的页。
+ *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
+ *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ * 先不持有latch_尝试命中，失败（页面不在缓冲池中、帧上有I/O或与修改页表的线程冲突）时再加锁。
+ * 淘汰脏页的写回和目标页的读入都在释放latch_之后进行，期间该帧处于io_pending状态：
+ * 同一页面的其他访问者只在该帧上等待，访问已在缓冲池中的页面则不受影响
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ */
+Page* BufferPoolPartition::fetch_page(PageId page_id) {
+    if (Page *page = try_fetch_unlatched(page_id)) {
+        return page;
+    }
+    std::unique_lock<TimedMutex> lock(latch_);
+    //Todo:
+    // 1.     从page_table_中搜寻目标页
+    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
+    // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
+    // 2.     若获得的可用frame存储的为dirty page，则须调用write_page将page写回到磁盘
+    // 3.     调用disk_manager_的read_page读取目标页到frame
+    // 4.     固定目标页，更新pin_count_
+    // 5.     返回目标页
+    frame_id_t frame_id;
+    while (true) {
+        while (page_table_.find(page_id, &frame_id)) {
+            Page *page = &pages_[frame_id];
+            if (!page->io_pending()) {
+                page->pin();
+                replacer_->pin(frame_id);
+                record_hit(page, page_id);
+                return page;
+            }
+            // 该帧正在读入目标页，或正在写回被淘汰的目标页；I/O完成后帧的归属可能已经改变，因此重新查找页表
+            uint64_t wait_start = stats_now_ns();
+            io_cv_[frame_id].wait(lock, [page] { return !page->io_pending(); });
+            counters_.pin_waits.fetch_add(1, std::memory_order_relaxed);
+            counters_.pin_wait_ns.fetch_add(stats_now_ns() - wait_start, std::memory_order_relaxed);
+        }
+
+        if (!claim_frame(lock, &frame_id)) {
+            return nullptr;
+        }
+        if (!page_table_.contains(page_id)) {
+            break;
+        }
+        // claim_frame等待后台清理时释放过latch_，其间其他线程已经开始载入目标页，归还帧后重新查找
+        unclaim_frame(frame_id);
+    }
+    counters_.misses.fetch_add(1, std::memory_order_relaxed);
+    file_stats(page_id.fd).misses++;
+    page_table_.insert(page_id, frame_id);
+    Page *page = &pages_[frame_id];
+    PageId victim_id = page->id_;
+    bool write_back = page->is_dirty_;
+    lock.unlock();
+
+    bool written = false;
+    try {
+        if (write_back) {
+            write_frame(victim_id, page->data_);
+        }
+        written = true;
+        read_frame(page_id, page->data_);
+    } catch (RMDBError &e) {
+        lock.lock();
+        if (written && write_back) {
+            file_stats(victim_id.fd).writebacks++;
+        }
+        complete_frame(frame_id, page_id, written, false, false);
+        throw;
+    }
+    lock.lock();
+    if (write_back) {
+        file_stats(victim_id.fd).writebacks++;
+    }
+    complete_frame(frame_id, page_id, true, true, false);
+    return page;
+}
+
+/**
+ * @description: 不持有latch_的命中路径：无锁地查找页表，再用CAS固定帧。
+ * 查找结果可能已经过时，try_pin会确认帧上没有I/O且确实存放着目标页，否则返回nullptr由调用者加锁重试。
+ * 置换策略自带互斥锁，可以在不持有latch_时调用；使用CLOCK时整个命中路径不加任何锁
+ * @return {Page*} 命中时返回已固定的页面，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ */
+Page* BufferPoolPartition::try_fetch_unlatched(PageId page_id) {
+    frame_id_t frame_id;
+    if (!page_table_.find(page_id, &frame_id)) {
+        return nullptr;
+    }
+    Page *page = &pages_[frame_id];
+    if (!page->try_pin(page_id)) {
+        return nullptr;
+    }
+    // 固定之后该帧不会再被淘汰；若replacer_已经选中它，占用帧时会发现它被固定而放弃
+    replacer_->pin(frame_id);
+    record_hit(page, page_id);
+    return page;
+}
+
+/**
+ * @description: 记录一次命中，持有或不持有latch_时都可以调用
+ */
+void BufferPoolPartition::record_hit(Page *page, PageId page_id) {
+    if (page->prefetched_.load(std::memory_order_relaxed) && page->prefetched_.exchange(false)) {
+        prefetch_hits_++;
+    }
+    counters_.hits.fetch_add(1, std::memory_order_relaxed);
+    if (page_id.fd >= 0 && page_id.fd < DiskManager::MAX_FD) {
+        file_hits_[page_id.fd].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @description: 占用一个可淘汰的帧并将其置为io_pending，调用者需通过lock持有latch_
+ * replacer_选出的帧可能刚被无锁命中的线程固定，此时放弃该帧，它在解除固定时会重新交给replacer_。
+ * 若被淘汰的页面是脏页，它在写回完成前仍保留在页表中，访问它的线程会等待写回结束后再从磁盘读取；
+ * 若后台清理线程正在写回该页面，先等待写回完成，避免旧数据在重新读入之后才落盘；
+ * 等待期间会释放latch_，调用者需重新确认目标页仍不在页表中，否则用unclaim_frame归还帧
+ * 等待期间清理线程需要重新获得latch_才能结束写回，因此调用者不能同时持有其他分区的latch_
+ * @return {bool} 是否成功占用
+ * @param {unique_lock<mutex>&} lock 持有latch_的锁
+ * @param {frame_id_t*} frame_id 占用的帧
+ */
+bool BufferPoolPartition::claim_frame(std::unique_lock<TimedMutex> &lock, frame_id_t *frame_id) {
+    Page *page;
+    do {
+        if (!find_victim_page(frame_id)) {
+            return false;
+        }
+        page = &pages_[*frame_id];
+    } while (!page->try_begin_io());
+    if (page->prefetched_.exchange(false)) {
+        prefetch_wasted_++;
+    }
+    if (page->id_.page_no != INVALID_PAGE_ID) {
+        counters_.evictions.fetch_add(1, std::memory_order_relaxed);
+        file_stats(page->id_.fd).evictions++;
+    }
+    num_pending_io_++;
+    io_cv_[*frame_id].wait(lock, [page] { return !page->flushing_; });
+    if (!page->is_dirty_) {
+        page_table_.erase(page->id_);
+    }
+    return true;
+}
+
+/**
+ * @description: 归还claim_frame占用但还没有开始I/O的帧，帧中的页面原样留在缓冲池中，调用者需持有latch_
+ * claim_frame移出页表之后一直持有latch_，被淘汰的页面不会在其他帧中载入，可以直接重新登记
+ * @param {frame_id_t} frame_id 占用的帧
+ */
+void BufferPoolPartition::unclaim_frame(frame_id_t frame_id) {
+    Page *page = &pages_[frame_id];
+    if (page->id_.page_no == INVALID_PAGE_ID) {
+        free_frame(frame_id);
+    } else {
+        if (!page->is_dirty_) {
+            page_table_.insert(page->id_, frame_id);
+        }
+        make_evictable(frame_id);
+    }
+    page->end_io();
+    num_pending_io_--;
+    io_cv_[frame_id].notify_all();
+}
+
+/**
+ * @description: claim_frame占用的帧完成I/O后更新其元数据并唤醒在该帧上等待的线程，调用者需持有latch_
+ * @param {frame_id_t} frame_id 占用的帧
+ * @param {PageId} page_id 要载入的页面
+ * @param {bool} written 被淘汰的脏页是否已写回，写回失败时旧页面原样留在缓冲池中
+ * @param {bool} loaded 目标页面是否已载入，失败时撤销page_id的登记并归还帧
+ * @param {bool} prefetch 载入的页面是否为预读，预读的页面不被固定，直接交给replacer
+ */
+void BufferPoolPartition::complete_frame(frame_id_t frame_id, PageId page_id, bool written, bool loaded,
+                                         bool prefetch) {
+    Page *page = &pages_[frame_id];
+    frame_id_t registered;
+    if (page_table_.find(page_id, &registered) && registered == frame_id && !(written && loaded)) {
+        page_table_.erase(page_id);
+    }
+    if (!written) {
+        make_evictable(frame_id);
+    } else {
+        if (page->is_dirty_) {
+            page_table_.erase(page->id_);
+        }
+        page->is_dirty_ = false;
+        if (loaded) {
+            page->set_id(page_id);
+            page_table_.insert(page_id, frame_id);
+            if (prefetch) {
+                page->prefetched_ = true;
+                make_evictable(frame_id);
+                prefetch_issued_++;
+            } else {
+                // 占用帧时它未被固定，io_pending期间也不会被固定
+                page->pin();
+                replacer_->pin(frame_id);
+            }
+        } else {
+            page->set_id(PageId{-1, INVALID_PAGE_ID});
+            free_frame(frame_id);
+        }
+    }
+    page->end_io();
+    num_pending_io_--;
+    io_cv_[frame_id].notify_all();
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
+ * @param {PageId} page_id 目标page的page_id
+ * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ */
+bool BufferPoolPartition::unpin_page(PageId page_id, bool is_dirty) {
+    // Todo:
+    // 0. lock latch
+    // 1. 尝试在page_table_中搜寻page_id对应的页P
+    // 1.1 P在页表中不存在 return false
+    // 1.2 P在页表中存在，获取其pin_count_
+    // 2.1 若pin_count_已经等于0，则返回false
+    // 2.2 若pin_count_大于0，则pin_count_自减一
+    // 2.2.1 若自减后等于0，则调用replacer_的Unpin
+    // 3 根据参数is_dirty，更改P的is_dirty_
+    std::scoped_lock lock(latch_); 
+    frame_id_t frame_id;
+    if (!page_table_.find(page_id, &frame_id)) {
+        return false; // Page not found
+    }
+    Page *page = &pages_[frame_id];
+    if (page->get_pin_count() <= 0) {
+        return false; // Page already unpinned
+    }
+    if (page->unpin() == 0) {
+        make_evictable(frame_id);
+        if (static_cast<size_t>(frame_id) >= pool_size_) {
+            io_cv_[frame_id].notify_all();    // resize在等待该帧被释放
+        }
+    }
+    
+    page->is_dirty_ |= is_dirty;
+
+    return true;
+}
+
+/**
+ * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
+ * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
+ * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
+ */
+bool BufferPoolPartition::flush_page(PageId page_id) {
+    // Todo:
+    // 0. lock latch
+    // 1. 查找页表,尝试获取目标页P
+    // 1.1 目标页P没有被page_table_记录 ，返回false
+    // 2. 无论P是否为脏都将其写回磁盘。
+    // 3. 更新P的is_dirty_
+    std::unique_lock<TimedMutex> lock(latch_);
+    frame_id_t frame_id;
+    while (true) {
+        if (!page_table_.find(page_id, &frame_id)) {
+            return false; // Page not found
+        }
+        if (!pages_[frame_id].io_busy()) {
+            break;
+        }
+        io_cv_[frame_id].wait(lock, [this, frame_id] { return !pages_[frame_id].io_busy(); });
+    }
+    Page *page = &pages_[frame_id];
+
+    // 写回期间固定该页面以免被淘汰，并提前清除脏标记，写回期间的修改会重新标记
+    page->pin();
+    replacer_->pin(frame_id);
+    page->is_dirty_ = false;
+    lock.unlock();
+    try {
+        write_frame(page->id_, page->data_);
+    } catch (RMDBError &e) {
+        lock.lock();
+        page->is_dirty_ = true;
+        if (page->unpin() == 0) {
+            make_evictable(frame_id);
+            io_cv_[frame_id].notify_all();
+        }
+        throw;
+    }
+    lock.lock();
+    file_stats(page_id.fd).writebacks++;
+    if (page->unpin() == 0) {
+        make_evictable(frame_id);
+        io_cv_[frame_id].notify_all();
+    }
+    return true;
+}
+
+/**
+ * @description: 为一个刚分配的页号获取帧，即从磁盘中移动一个新建的空page到缓冲池某个位置。
+ * 页号由BufferPoolManager从DiskManager分配，并按页号选出本分区
+ * @return {Page*} 返回新创建的page，若没有可用的帧则返回nullptr
+ * @param {PageId} page_id 新页面的page_id
+ */
+Page* BufferPoolPartition::new_page(PageId page_id) {
+    std::unique_lock<TimedMutex> lock(latch_);
+    // 1.   获得一个可用的frame，若无法获得则返回nullptr
+    // 2.   将frame的数据写回磁盘
+    // 3.   固定frame，更新pin_count_
+    // 4.   返回获得的page
+    frame_id_t frame_id;
+    if (!claim_frame(lock, &frame_id)) {
+        return nullptr;
+    }
+    Page *page = &pages_[frame_id];
+    PageId victim_id = page->id_;
+    bool write_back = page->is_dirty_;
+    // 新页号尚未返回给任何人，不会有其他线程访问它，只需在写回淘汰页期间释放latch_
+    lock.unlock();
+    try {
+        if (write_back) {
+            write_frame(victim_id, page->data_);
+        }
+    } catch (RMDBError &e) {
+        lock.lock();
+        complete_frame(frame_id, page_id, false, false, false);
+        throw;
+    }
+    page->reset_memory();
+    lock.lock();
+    if (write_back) {
+        file_stats(victim_id.fd).writebacks++;
+    }
+    complete_frame(frame_id, page_id, true, true, false);
+    return page;
+}
+
+/**
+ * @description: 从buffer_pool删除目标页
+ * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolPartition::delete_page(PageId page_id) {
+    std::unique_lock<TimedMutex> lock(latch_);
+    // 1.   在page_table_中查找目标页，若不存在返回true
+    // 2.   若目标页的pin_count不为0，则返回false
+    // 3.   从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
+    //      页面已被释放，其中的数据不再需要，即使是脏页也不写回磁盘，整个过程不做I/O
+
+    frame_id_t frame_id;
+    bool found = page_table_.find(page_id, &frame_id);
+    while (found && pages_[frame_id].io_busy()) {
+        io_cv_[frame_id].wait(lock, [this, frame_id] { return !pages_[frame_id].io_busy(); });
+        found = page_table_.find(page_id, &frame_id);
+    }
+    if (!found) {
+        return true; // Page not found, already deleted
+    }
+    Page *page = &pages_[frame_id];
+    // 置为io_pending后无锁命中的线程不能再固定该页面
+    if (!page->try_begin_io()) {
+        return false; // Page is pinned, cannot delete
+    }
+    page_table_.erase(page_id);
+    replacer_->pin(frame_id);  // 从replacer中移除，避免该帧同时出现在free_list_和replacer中
+    free_frame(frame_id);
+    disk_manager_->deallocate_page(page->id_.page_no);
+    page->reset_memory();
+    page->is_dirty_ = false;
+    page->prefetched_ = false;
+    page->set_id(PageId{-1, INVALID_PAGE_ID});
+    page->end_io();
+    return true;
+}
+
+/**
+ * @description: 等待本分区中所有正在进行的I/O完成，调用者需通过lock持有latch_
+ * @param {unique_lock<mutex>&} lock 持有latch_的锁，等待期间会被暂时释放
+ */
+void BufferPoolPartition::wait_for_io(std::unique_lock<TimedMutex> &lock) {
+    for (size_t i = 0; i < capacity_; i++) {
+        Page *page = &pages_[i];
+        io_cv_[i].wait(lock, [page] { return !page->io_busy(); });
+    }
+}
+
+/**
+ * @description: 收集本分区中属于指定文件的所有页面，调用者需持有latch_且本分区没有进行中的I/O
+ * @param {int} fd 文件句柄
+ * @param {vector<Page*>&} pages 收集到的页面追加到pages中
+ */
+void BufferPoolPartition::collect_file_pages(int fd, std::vector<Page *> &pages) {
+    page_table_.for_each([&](PageId page_id, frame_id_t frame_id) {
+        if (page_id.fd == fd) {
+            pages.push_back(&pages_[frame_id]);
+        }
+    });
+}
+
+/**
+ * @description: 将本分区中属于指定文件的页面移出缓冲池，调用者需持有latch_并已把这些页面写回磁盘
+ * 文件关闭后fd可能被复用，因此必须把这些页从页表中移除并清空该文件的统计；未被固定的帧直接归还free_list_。
+ * 先修改帧的id再检查pin_count，在此之前无锁固定了该页面的线程会被计入pin_count，之后的则会固定失败
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolPartition::drop_file_pages(int fd) {
+    std::vector<std::pair<PageId, frame_id_t>> entries;
+    page_table_.for_each([&](PageId page_id, frame_id_t frame_id) {
+        if (page_id.fd == fd) {
+            entries.emplace_back(page_id, frame_id);
+        }
+    });
+    for (auto &entry : entries) {
+        Page *page = &pages_[entry.second];
+        page_table_.erase(entry.first);
+        page->is_dirty_ = false;
+        page->prefetched_ = false;
+        page->set_id(PageId{-1, INVALID_PAGE_ID});
+        if (page->get_pin_count() == 0) {
+            replacer_->pin(entry.second);
+            free_frame(entry.second);
+        }
+    }
+    // 文件关闭后fd可能分配给其他文件，统计从零开始
+    if (static_cast<size_t>(fd) < file_stats_.size()) {
+        file_stats_[fd] = FileStats();
+    }
+    if (fd >= 0 && fd < DiskManager::MAX_FD) {
+        file_hits_[fd] = 0;
+    }
+}
+
+/**
+ * @description: 统计本分区中的脏页数
+ * @return {size_t} 脏页数
+ */
+size_t BufferPoolPartition::count_dirty_pages() {
+    std::scoped_lock lock(latch_);
+    size_t num_dirty = 0;
+    for (size_t i = 0; i < pool_size_; i++) {
+        num_dirty += pages_[i].is_dirty_;
+    }
+    return num_dirty;
+}
+
+/**
+ * @description: 从replacer的冷端挑选脏页写回磁盘，供后台清理线程调用
+ * 写回期间不持有latch_，页面仍可被访问和修改（修改会重新标记为脏页），但不会被淘汰或删除
+ * @return {size_t} 成功写回的页面数
+ * @param {size_t} max_pages 最多写回的页面数
+ * @param {bool} check_lsn 是否检查页面的LSN，启用WAL时为true
+ * @param {lsn_t} persist_lsn 已经持久化的最大日志号，page_lsn更大的页面在日志落盘前不能写回
+ */
+size_t BufferPoolPartition::clean_pages(size_t max_pages, bool check_lsn, lsn_t persist_lsn) {
+    std::unique_lock<TimedMutex> lock(latch_);
+    std::vector<frame_id_t> cold;
+    replacer_->cold_frames(std::min(pool_size_.load(), PAGE_CLEANER_LRU_SCAN_DEPTH), &cold);
+    std::vector<frame_id_t> targets;
+    for (frame_id_t frame_id : cold) {
+        if (targets.size() >= max_pages) {
+            break;
+        }
+        Page *page = &pages_[frame_id];
+        if (!page->is_dirty_ || page->io_busy()) {
+            continue;
+        }
+        if (check_lsn && page->get_page_lsn() > persist_lsn) {
+            continue;
+        }
+        page->flushing_ = true;
+        page->is_dirty_ = false;
+        num_pending_io_++;
+        targets.push_back(frame_id);
+    }
+    lock.unlock();
+
+    std::vector<bool> written(targets.size(), true);
+    for (size_t i = 0; i < targets.size(); i++) {
+        Page *page = &pages_[targets[i]];
+        try {
+            write_frame(page->id_, page->data_);
+        } catch (RMDBError &e) {
+            written[i] = false;
+        }
+    }
+
+    lock.lock();
+    size_t num_written = 0;
+    for (size_t i = 0; i < targets.size(); i++) {
+        Page *page = &pages_[targets[i]];
+        page->flushing_ = false;
+        num_pending_io_--;
+        if (written[i]) {
+            num_written++;
+            file_stats(page->id_.fd).writebacks++;
+        } else {
+            page->is_dirty_ = true;
+        }
+        io_cv_[targets[i]].notify_all();
+    }
+    return num_written;
+}
+
+/**
+ * @description: 在线调整本分区的帧数。扩大时新增的帧直接加入free_list_，其内存在首次使用时才分配；
+ * 缩小时先把pool_size_降到new_size，使帧号更大的帧不再被分配或交给replacer，
+ * 再从高到低逐个等待这些帧上的固定和I/O结束、写回脏页并移出页表，最后把它们的内存归还给操作系统。
+ * 其他线程在此期间照常访问本分区，只有访问正在回收的页面时需要等待，随后从磁盘重新读入到其他帧中
+ * @param {size_t} new_size 新的帧数，不能超过capacity_
+ */
+void BufferPoolPartition::resize(size_t new_size) {
+    std::unique_lock<TimedMutex> lock(latch_);
+    if (new_size == 0 || new_size > capacity_) {
+        throw InternalError("BufferPoolPartition: invalid pool size " + std::to_string(new_size));
+    }
+    size_t old_size = pool_size_;
+    if (new_size >= old_size) {
+        arena_->grow(new_size);
+        for (size_t i = old_size; i < new_size; i++) {
+            free_list_.emplace_back(static_cast<frame_id_t>(i));
+        }
+        pool_size_ = new_size;
+        return;
+    }
+
+    pool_size_ = new_size;
+    free_list_.remove_if([new_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_size; });
+    for (size_t i = new_size; i < old_size; i++) {
+        replacer_->pin(static_cast<frame_id_t>(i));
+    }
+    for (size_t i = old_size; i > new_size; i--) {
+        frame_id_t frame_id = static_cast<frame_id_t>(i - 1);
+        try {
+            retire_frame(lock, frame_id);
+        } catch (RMDBError &e) {
+            // 写回失败的帧及帧号更小的帧仍保留在本分区中
+            restore_frames(lock, i);
+            throw;
+        }
+    }
+    lock.unlock();
+    arena_->release(new_size, old_size - new_size);
+}
+
+/**
+ * @description: 等待帧号不小于pool_size_的帧空闲后将其回收：写回脏页并把页面移出页表，调用者需通过lock持有latch_
+ * @param {unique_lock<mutex>&} lock 持有latch_的锁，等待和写回期间会被暂时释放
+ * @param {frame_id_t} frame_id 要回收的帧
+ */
+void BufferPoolPartition::retire_frame(std::unique_lock<TimedMutex> &lock, frame_id_t frame_id) {
+    Page *page = &pages_[frame_id];
+    // drop_file_pages移出页表时仍被固定的帧不会再被unpin，不必等待；
+    // 其他帧在置为io_pending之前仍可能被无锁命中的线程固定，此时继续等待它解除固定
+    while (true) {
+        io_cv_[frame_id].wait(lock, [page] {
+            return !page->io_busy() && (page->get_pin_count() == 0 || page->id_.page_no == INVALID_PAGE_ID);
+        });
+        if (page->id_.page_no == INVALID_PAGE_ID) {
+            page->begin_io();
+            break;
+        }
+        if (page->try_begin_io()) {
+            break;
+        }
+    }
+    // 回收期间该帧处于io_pending状态，访问该页面的线程等待回收结束后重新查找页表
+    num_pending_io_++;
+    if (page->is_dirty_) {
+        lock.unlock();
+        try {
+            write_frame(page->id_, page->data_);
+        } catch (RMDBError &e) {
+            lock.lock();
+            page->end_io();
+            num_pending_io_--;
+            io_cv_[frame_id].notify_all();
+            throw;
+        }
+        lock.lock();
+        file_stats(page->id_.fd).writebacks++;
+        page->is_dirty_ = false;
+    }
+    frame_id_t registered;
+    if (page_table_.find(page->id_, &registered) && registered == frame_id) {
+        page_table_.erase(page->id_);
+    }
+    if (page->prefetched_.exchange(false)) {
+        prefetch_wasted_++;
+    }
+    page->set_id(PageId{-1, INVALID_PAGE_ID});
+    page->reset_pin_count();
+    page->end_io();
+    num_pending_io_--;
+    io_cv_[frame_id].notify_all();
+}
+
+/**
+ * @description: 缩小失败时把[pool_size_, size)内尚未回收的帧重新交还本分区，调用者需通过lock持有latch_
+ * 先等待这些帧上的I/O结束，因为后台清理线程结束写回时不会把帧交给replacer_
+ * @param {unique_lock<mutex>&} lock 持有latch_的锁
+ * @param {size_t} size 恢复后的帧数
+ */
+void BufferPoolPartition::restore_frames(std::unique_lock<TimedMutex> &lock, size_t size) {
+    size_t old_size = pool_size_;
+    for (size_t i = old_size; i < size; i++) {
+        Page *page = &pages_[i];
+        io_cv_[i].wait(lock, [page] { return !page->io_busy(); });
+    }
+    pool_size_ = size;
+    for (size_t i = old_size; i < size; i++) {
+        frame_id_t frame_id = static_cast<frame_id_t>(i);
+        Page *page = &pages_[frame_id];
+        if (page->get_pin_count() != 0) {
+            continue;   // 被固定的帧在unpin时交给replacer_
+        }
+        if (page->id_.page_no == INVALID_PAGE_ID) {
+            free_list_.push_back(frame_id);
+        } else {
+            replacer_->unpin(frame_id);
+        }
+    }
+}
+
+/**
+ * @description: 把本分区的统计累加到stats中
+ * @param {BufferPoolStats*} stats 汇总的统计信息
+ */
+void BufferPoolPartition::collect_stats(BufferPoolStats *stats) {
+    stats->hits += counters_.hits.load(std::memory_order_relaxed);
+    stats->misses += counters_.misses.load(std::memory_order_relaxed);
+    stats->evictions += counters_.evictions.load(std::memory_order_relaxed);
+    stats->writebacks += counters_.writebacks.load(std::memory_order_relaxed);
+    stats->pin_waits += counters_.pin_waits.load(std::memory_order_relaxed);
+    stats->pin_wait_ns += counters_.pin_wait_ns.load(std::memory_order_relaxed);
+    stats->latch_acquisitions += latch_.get_acquisitions();
+    stats->latch_contended += latch_.get_contended();
+    stats->latch_hold_samples += latch_.get_hold_samples();
+    stats->latch_hold_ns += latch_.get_hold_ns();
+    stats->prefetch_issued += prefetch_issued_;
+    stats->prefetch_hits += prefetch_hits_;
+    LatencySnapshot latency;
+    counters_.read_latency.snapshot(&latency);
+    stats->read_latency.merge(latency);
+    counters_.write_latency.snapshot(&latency);
+    stats->write_latency.merge(latency);
+    stats->dirty_pages += count_dirty_pages();
+
+    std::scoped_lock lock(latch_);
+    for (int fd = 0; fd < DiskManager::MAX_FD; fd++) {
+        FileStats file = static_cast<size_t>(fd) < file_stats_.size() ? file_stats_[fd] : FileStats();
+        file.hits = file_hits_[fd].load(std::memory_order_relaxed);
+        if (file.hits + file.misses + file.evictions + file.writebacks != 0) {
+            stats->files[fd].merge(file);
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "buffer_pool_stats.h"
+#include "disk_manager.h"
+#include "errors.h"
+#include "frame_arena.h"
+#include "page.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+#include "replacer/replacer.h"
+#include "replacer/two_q_replacer.h"
+
+/**
+ * @description: 缓冲池的一个分区，拥有独立的帧数组、页表、空闲链表、置换策略和latch
+ * 每个PageId只会被BufferPoolManager路由到唯一的分区，不同分区之间的操作互不阻塞
+ */
+class BufferPoolPartition {
+    friend class BufferPoolManager;
+
+   private:
+    std::atomic<size_t> pool_size_;     // 本分区中可用帧的个数，帧号为[0, pool_size_)，由resize修改
+    size_t capacity_;       // 本分区最多可扩展到的帧数，帧数组、replacer和arena_都按它分配
+    std::unique_ptr<FrameArena> arena_;  // 本分区帧数据所在的内存区域，只有被访问过的帧占用物理内存
+    Page *pages_;           // 本分区的Page对象数组，只含元数据，第i个Page的数据位于arena_的第i帧
+    PageTable page_table_;  // 页面号到帧号的映射，被淘汰的脏页在写回前仍占一个条目，因此最多有2*capacity_个条目
+    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    DiskManager *disk_manager_;
+    Replacer *replacer_;    // 本分区的置换策略
+    TimedMutex latch_;      // 保护本分区的页表、空闲链表和帧元数据，磁盘I/O期间不持有
+    std::unique_ptr<std::condition_variable_any[]> io_cv_;  // 每个帧一个条件变量，等待该帧上进行中的I/O完成
+    size_t num_pending_io_ = 0;                         // 处于io_pending或flushing_状态的帧数
+
+    std::atomic<size_t> prefetch_issued_{0};   // 预读载入的页面数
+    std::atomic<size_t> prefetch_hits_{0};     // 预读载入后被访问到的页面数
+    std::atomic<size_t> prefetch_wasted_{0};   // 预读载入后未被访问就被淘汰的页面数
+
+    BufferPoolCounters counters_;           // 命中、淘汰、写回和I/O延迟等统计
+    std::vector<FileStats> file_stats_;     // 以fd为下标的各文件统计，受latch_保护，其中的hits不使用
+    std::unique_ptr<std::atomic<uint64_t>[]> file_hits_;   // 以fd为下标的各文件命中次数，无锁命中时也要更新
+
+   public:
+    /**
+     * @description: 创建一个分区
+     * @param {size_t} pool_size 本分区中帧的个数
+     * @param {DiskManager*} disk_manager
+     * @param {string} &replacer_type 置换策略
+     * @param {int} numa_node 帧数据绑定的NUMA节点，-1表示不绑定
+     * @param {size_t} capacity 本分区最多可扩展到的帧数，0表示等于pool_size
+     */
+    BufferPoolPartition(size_t pool_size, DiskManager *disk_manager, const std::string &replacer_type,
+                        int numa_node = -1, size_t capacity = 0)
+        : pool_size_(pool_size),
+          capacity_(std::max(pool_size, capacity)),
+          page_table_(2 * capacity_),
+          disk_manager_(disk_manager),
+          file_hits_(std::make_unique<std::atomic<uint64_t>[]>(DiskManager::MAX_FD)) {
+        arena_ = std::make_unique<FrameArena>(capacity_, numa_node, BUFFER_POOL_HUGE_PAGES, pool_size_);
+        pages_ = new Page[capacity_];
+        for (size_t i = 0; i < capacity_; ++i) {
+            pages_[i].data_ = arena_->frame(i);
+        }
+        io_cv_ = std::make_unique<std::condition_variable_any[]>(capacity_);
+        replacer_ = create_replacer(replacer_type, capacity_);
+        for (size_t i = 0; i < pool_size_; ++i) {
+            free_list_.emplace_back(static_cast<frame_id_t>(i));
+        }
+    }
+
+    ~BufferPoolPartition() {
+        delete[] pages_;
+        delete replacer_;
+    }
+
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_capacity() const { return capacity_; }
+
+    const FrameArena *get_arena() const { return arena_.get(); }
+
+    Page* fetch_page(PageId page_id);
+
+    bool unpin_page(PageId page_id, bool is_dirty);
+
+    bool flush_page(PageId page_id);
+
+    Page* new_page(PageId page_id);
+
+    bool delete_page(PageId page_id);
+
+    size_t count_dirty_pages();
+
+    size_t clean_pages(size_t max_pages, bool check_lsn, lsn_t persist_lsn);
+
+    void resize(size_t new_size);
+
+    void collect_stats(BufferPoolStats *stats);
+
+    static Replacer* create_replacer(const std::string& replacer_type, size_t pool_size);
+
+   private:
+    Page* try_fetch_unlatched(PageId page_id);
+
+    void record_hit(Page *page, PageId page_id);
+
+    bool find_victim_page(frame_id_t* frame_id);
+
+    // 帧号不小于pool_size_的帧正在被resize回收，以下两个函数不再把它们交给replacer_和free_list_
+
+    void make_evictable(frame_id_t frame_id) {
+        if (static_cast<size_t>(frame_id) < pool_size_) {
+            replacer_->unpin(frame_id);
+        }
+    }
+
+    void free_frame(frame_id_t frame_id) {
+        if (static_cast<size_t>(frame_id) < pool_size_) {
+            free_list_.push_back(frame_id);
+        }
+    }
+
+    FileStats &file_stats(int fd) {
+        if (static_cast<size_t>(fd) >= file_stats_.size()) {
+            file_stats_.resize(fd + 1);
+        }
+        return file_stats_[fd];
+    }
+
+    // 以下两个函数在不持有latch_时读写一个帧，并把延迟记入counters_
+
+    void read_frame(PageId page_id, char *data);
+
+    void write_frame(PageId page_id, const char *data);
+
+    void retire_frame(std::unique_lock<TimedMutex> &lock, frame_id_t frame_id);
+
+    void restore_frames(std::unique_lock<TimedMutex> &lock, size_t size);
+
+    // 以下函数的调用者需持有本分区的latch_，BufferPoolManager也用它们完成跨分区的批量读写
+
+    bool claim_frame(std::unique_lock<TimedMutex> &lock, frame_id_t *frame_id);
+
+    void unclaim_frame(frame_id_t frame_id);
+
+    void complete_frame(frame_id_t frame_id, PageId page_id, bool written, bool loaded, bool prefetch);
+
+    void wait_for_io(std::unique_lock<TimedMutex> &lock);
+
+    void collect_file_pages(int fd, std::vector<Page *> &pages);
+
+    void drop_file_pages(int fd);
+};
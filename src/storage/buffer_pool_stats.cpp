@@ -0,0 +1,126 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "buffer_pool_stats.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+void LatencySnapshot::merge(const LatencySnapshot &other) {
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    total_ns += other.total_ns;
+    max_ns = std::max(max_ns, other.max_ns);
+}
+
+uint64_t LatencySnapshot::percentile_us(double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(quantile * count);
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return bucket_upper_us(i);
+        }
+    }
+    return bucket_upper_us(NUM_BUCKETS - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int bucket = 0;
+    while (us > 0 && bucket < LatencySnapshot::NUM_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::snapshot(LatencySnapshot *out) const {
+    for (int i = 0; i < LatencySnapshot::NUM_BUCKETS; i++) {
+        out->buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    out->count = count_.load(std::memory_order_relaxed);
+    out->total_ns = total_ns_.load(std::memory_order_relaxed);
+    out->max_ns = max_ns_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @description: 输出一个直方图，只列出非空的桶
+ */
+static void print_latency(std::ostream &os, const std::string &name, const LatencySnapshot &latency) {
+    os << name << ": count=" << latency.count << " avg=" << std::fixed << std::setprecision(1) << latency.avg_us()
+       << "us p50<" << latency.percentile_us(0.5) << "us p99<" << latency.percentile_us(0.99)
+       << "us max=" << latency.max_ns / 1000 << "us\n";
+    for (int i = 0; i < LatencySnapshot::NUM_BUCKETS; i++) {
+        if (latency.buckets[i] != 0) {
+            os << "  <" << LatencySnapshot::bucket_upper_us(i) << "us: " << latency.buckets[i] << "\n";
+        }
+    }
+}
+
+std::string BufferPoolStats::to_string(const std::function<std::string(int)> &file_name) const {
+    std::stringstream os;
+    os << "pool_size=" << pool_size << " partitions=" << num_partitions << " dirty_pages=" << dirty_pages << "\n";
+    os << "hits=" << hits << " misses=" << misses << " hit_ratio=" << std::fixed << std::setprecision(4)
+       << hit_ratio() << " evictions=" << evictions << " writebacks=" << writebacks << "\n";
+    os << "pin_waits=" << pin_waits << " pin_wait_total_us=" << pin_wait_ns / 1000
+       << " prefetch_issued=" << prefetch_issued << " prefetch_hits=" << prefetch_hits << "\n";
+    os << "latch_acquisitions=" << latch_acquisitions << " latch_contended=" << latch_contended
+       << " latch_hold_avg_ns=" << std::setprecision(1) << avg_latch_hold_ns() << "\n";
+    print_latency(os, "read_latency", read_latency);
+    print_latency(os, "write_latency", write_latency);
+    for (auto &entry : files) {
+        os << "file " << (file_name ? file_name(entry.first) : std::to_string(entry.first))
+           << ": hits=" << entry.second.hits << " misses=" << entry.second.misses
+           << " evictions=" << entry.second.evictions << " writebacks=" << entry.second.writebacks << "\n";
+    }
+    return os.str();
+}
+
+StatsDumper::StatsDumper(std::function<std::string()> stats_fn, const std::string &path, int interval_sec)
+    : stats_fn_(std::move(stats_fn)), path_(path), interval_sec_(interval_sec) {
+    thread_ = std::thread(&StatsDumper::run, this);
+}
+
+StatsDumper::~StatsDumper() {
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void StatsDumper::run() {
+    const auto interval = std::chrono::seconds(interval_sec_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+        lock.unlock();
+        std::time_t now = std::time(nullptr);
+        std::tm local_time;
+        localtime_r(&now, &local_time);
+        std::ofstream out(path_, std::ios::out | std::ios::app);
+        out << "==== " << std::put_time(&local_time, "%F %T") << " ====\n" << stats_fn_();
+        lock.lock();
+    }
+}
@@ -0,0 +1,229 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/config.h"
+
+/** @return 单调时钟的当前时间，单位纳秒 */
+inline uint64_t stats_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @description: 统计持有时间的互斥锁，可直接配合unique_lock、scoped_lock和condition_variable_any使用
+ * 每次加锁都计数，并记录需要等待的次数；持有时间每BUFFER_POOL_LATCH_SAMPLE_RATE次加锁采样一次，
+ * 避免每次加锁都读取时钟。计数只在持有锁时修改，读取时不需要加锁
+ */
+class TimedMutex {
+   public:
+    void lock() {
+        if (!mutex_.try_lock()) {
+            mutex_.lock();
+            contended_.store(contended_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        on_acquire();
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        on_acquire();
+        return true;
+    }
+
+    void unlock() {
+        if (sampled_) {
+            hold_ns_.store(hold_ns_.load(std::memory_order_relaxed) + (stats_now_ns() - acquired_at_),
+                           std::memory_order_relaxed);
+            hold_samples_.store(hold_samples_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        mutex_.unlock();
+    }
+
+    uint64_t get_acquisitions() const { return acquisitions_.load(std::memory_order_relaxed); }
+
+    uint64_t get_contended() const { return contended_.load(std::memory_order_relaxed); }
+
+    uint64_t get_hold_samples() const { return hold_samples_.load(std::memory_order_relaxed); }
+
+    uint64_t get_hold_ns() const { return hold_ns_.load(std::memory_order_relaxed); }
+
+   private:
+    void on_acquire() {
+        uint64_t n = acquisitions_.load(std::memory_order_relaxed) + 1;
+        acquisitions_.store(n, std::memory_order_relaxed);
+        sampled_ = n % BUFFER_POOL_LATCH_SAMPLE_RATE == 0;
+        if (sampled_) {
+            acquired_at_ = stats_now_ns();
+        }
+    }
+
+    std::mutex mutex_;
+    bool sampled_ = false;          // 本次持有是否被采样
+    uint64_t acquired_at_ = 0;      // 被采样的这次持有的加锁时间
+    std::atomic<uint64_t> acquisitions_{0};
+    std::atomic<uint64_t> contended_{0};
+    std::atomic<uint64_t> hold_samples_{0};
+    std::atomic<uint64_t> hold_ns_{0};
+};
+
+/**
+ * @description: I/O延迟的直方图快照，第i个桶统计延迟在[2^(i-1), 2^i)微秒内的次数，第0个桶为不足1微秒，
+ * 最后一个桶包含所有更长的延迟
+ */
+struct LatencySnapshot {
+    static constexpr int NUM_BUCKETS = 24;
+
+    uint64_t buckets[NUM_BUCKETS] = {0};
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    void merge(const LatencySnapshot &other);
+
+    /** @return 平均延迟，单位微秒 */
+    double avg_us() const { return count == 0 ? 0 : total_ns / 1000.0 / count; }
+
+    /**
+     * @description: 按桶估计分位数，返回所在桶的上界
+     * @return {uint64_t} 延迟的上界，单位微秒
+     * @param {double} quantile 分位数，如0.99
+     */
+    uint64_t percentile_us(double quantile) const;
+
+    /** @return 第i个桶的上界，单位微秒 */
+    static uint64_t bucket_upper_us(int i) { return 1ULL << i; }
+};
+
+/**
+ * @description: 无锁的I/O延迟直方图，由执行I/O的线程在不持有latch时记录
+ */
+class LatencyHistogram {
+   public:
+    void record(uint64_t ns);
+
+    void snapshot(LatencySnapshot *out) const;
+
+   private:
+    std::atomic<uint64_t> buckets_[LatencySnapshot::NUM_BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+/**
+ * @description: 单个文件在缓冲池中的访问统计，由所在分区在持有latch时更新
+ */
+struct FileStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+
+    void merge(const FileStats &other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        writebacks += other.writebacks;
+    }
+};
+
+/**
+ * @description: 缓冲池的运行计数器，每个分区一份，避免各分区在同一缓存行上竞争
+ */
+struct BufferPoolCounters {
+    std::atomic<uint64_t> hits{0};          // fetch_page时页面已在缓冲池中
+    std::atomic<uint64_t> misses{0};        // fetch_page时需要从磁盘读入
+    std::atomic<uint64_t> evictions{0};     // 为载入新页面而淘汰的页面数
+    std::atomic<uint64_t> writebacks{0};    // 写回磁盘的脏页数，包括淘汰、刷盘和后台清理
+    std::atomic<uint64_t> pin_waits{0};     // 访问的页面正在进行I/O而需要等待的次数
+    std::atomic<uint64_t> pin_wait_ns{0};   // 上述等待的总时长
+    LatencyHistogram read_latency;          // 每次读盘调用的延迟
+    LatencyHistogram write_latency;         // 每次写盘调用的延迟
+};
+
+/**
+ * @description: 缓冲池统计信息的快照，由BufferPoolManager::get_stats汇总各分区得到
+ */
+struct BufferPoolStats {
+    size_t pool_size = 0;
+    size_t num_partitions = 0;
+    size_t dirty_pages = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    uint64_t pin_waits = 0;
+    uint64_t pin_wait_ns = 0;
+    uint64_t latch_acquisitions = 0;
+    uint64_t latch_contended = 0;
+    uint64_t latch_hold_samples = 0;
+    uint64_t latch_hold_ns = 0;
+    uint64_t prefetch_issued = 0;
+    uint64_t prefetch_hits = 0;
+    LatencySnapshot read_latency;
+    LatencySnapshot write_latency;
+    std::map<int, FileStats> files;     // 以fd为键，只包含在缓冲池中被访问过且尚未关闭的文件
+
+    double hit_ratio() const { return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses); }
+
+    /** @return 采样得到的平均latch持有时间，单位纳秒 */
+    double avg_latch_hold_ns() const {
+        return latch_hold_samples == 0 ? 0 : static_cast<double>(latch_hold_ns) / latch_hold_samples;
+    }
+
+    /**
+     * @description: 转换为多行文本，用于定期输出到日志
+     * @return {string} 文本形式的统计信息
+     * @param {function<string(int)>} file_name 由fd得到文件名，为空时直接输出fd
+     */
+    std::string to_string(const std::function<std::string(int)> &file_name = nullptr) const;
+};
+
+/**
+ * @description: 定期输出缓冲池统计信息的后台线程，每隔一段时间把stats_fn的结果追加到指定文件
+ */
+class StatsDumper {
+   public:
+    /**
+     * @description: 创建并启动输出线程
+     * @param {function<string()>} stats_fn 生成要输出的文本
+     * @param {string&} path 输出文件的路径
+     * @param {int} interval_sec 输出的间隔，单位秒
+     */
+    StatsDumper(std::function<std::string()> stats_fn, const std::string &path, int interval_sec);
+
+    ~StatsDumper();
+
+   private:
+    void run();
+
+    std::function<std::string()> stats_fn_;
+    std::string path_;
+    int interval_sec_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
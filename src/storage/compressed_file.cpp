@@ -0,0 +1,297 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/compressed_file.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "errors.h"
+#include "storage/lz_codec.h"
+
+static int align_to_sector(int len) {
+    return (len + CompressedFile::SECTOR_SIZE - 1) / CompressedFile::SECTOR_SIZE * CompressedFile::SECTOR_SIZE;
+}
+
+static bool is_all_zero(const char *buf, int len) {
+    static const char zero_buffer[PAGE_SIZE] = {0};
+    for (int i = 0; i < len; i += PAGE_SIZE) {
+        if (memcmp(buf + i, zero_buffer, std::min(PAGE_SIZE, len - i)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CompressedFile::create_map(const std::string &path, int num_pages) {
+    std::string map_path = map_file_name(path);
+    int map_fd = open(map_path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (map_fd == -1) {
+        throw UnixError();
+    }
+    MapHdr hdr{MAGIC, num_pages, 0, 0};
+    bool ok = pwrite(map_fd, &hdr, sizeof(hdr), 0) == sizeof(hdr);
+    close(map_fd);
+    if (!ok) {
+        throw InternalError("CompressedFile::create_map Error");
+    }
+}
+
+int CompressedFile::read_num_pages(const std::string &map_path) {
+    int map_fd = open(map_path.c_str(), O_RDONLY);
+    if (map_fd == -1) {
+        return -1;
+    }
+    MapHdr hdr;
+    bool ok = pread(map_fd, &hdr, sizeof(hdr), 0) == sizeof(hdr) && hdr.magic == MAGIC;
+    close(map_fd);
+    return ok ? hdr.num_pages : -1;
+}
+
+CompressedFile::CompressedFile(int fd, const std::string &path)
+    : fd_(fd), cache_(new char[EXTENT_SIZE]), compress_buf_(new char[EXTENT_SIZE]) {
+    std::string map_path = map_file_name(path);
+    map_fd_ = open(map_path.c_str(), O_RDWR);
+    if (map_fd_ == -1) {
+        throw FileNotFoundError(map_path);
+    }
+    MapHdr hdr;
+    if (pread(map_fd_, &hdr, sizeof(hdr), 0) != sizeof(hdr) || hdr.magic != MAGIC) {
+        close(map_fd_);
+        throw InternalError("CompressedFile: invalid map file " + map_path);
+    }
+    num_pages_ = hdr.num_pages;
+    extents_.resize(hdr.num_extents);
+    ssize_t entries_size = (ssize_t)hdr.num_extents * sizeof(ExtentEntry);
+    if (entries_size > 0 && pread(map_fd_, extents_.data(), entries_size, sizeof(MapHdr)) != entries_size) {
+        close(map_fd_);
+        throw InternalError("CompressedFile: truncated map file " + map_path);
+    }
+
+    // 已分配的空间之间的空洞即为空闲空间；崩溃时写了数据但没来得及写映射项的空间也在此回收
+    std::vector<std::pair<int64_t, int>> used;
+    for (auto &entry : extents_) {
+        if (entry.capacity > 0) {
+            used.emplace_back(entry.offset, entry.capacity);
+        }
+    }
+    std::sort(used.begin(), used.end());
+    for (auto &[offset, capacity] : used) {
+        if (offset > file_end_) {
+            free_list_[file_end_] = (int)(offset - file_end_);
+        }
+        file_end_ = std::max(file_end_, offset + capacity);
+    }
+}
+
+CompressedFile::~CompressedFile() { close(map_fd_); }
+
+void CompressedFile::read_page(page_id_t page_no, char *buf) {
+    std::scoped_lock lock(latch_);
+    if (page_no < 0 || page_no >= num_pages_) {
+        throw InternalError("CompressedFile::read_page: page_no out of range");
+    }
+    load_extent(page_no / EXTENT_PAGES);
+    memcpy(buf, cache_.get() + (size_t)(page_no % EXTENT_PAGES) * PAGE_SIZE, PAGE_SIZE);
+}
+
+void CompressedFile::write_pages(page_id_t start_page_no, const char *const *bufs, int num_pages) {
+    std::scoped_lock lock(latch_);
+    std::vector<std::pair<int, ExtentEntry>> stored;  // 已写出数据、还没有写映射项的extent
+    try {
+        int done = 0;
+        while (done < num_pages) {
+            page_id_t page_no = start_page_no + done;
+            int extent_no = page_no / EXTENT_PAGES;
+            int first = page_no % EXTENT_PAGES;
+            int count = std::min(num_pages - done, EXTENT_PAGES - first);
+            if (count == EXTENT_PAGES) {
+                // 整个extent都被覆盖，不需要先读出旧内容
+                cache_extent_no_ = extent_no;
+            } else {
+                load_extent(extent_no);
+            }
+            for (int i = 0; i < count; i++) {
+                memcpy(cache_.get() + (size_t)(first + i) * PAGE_SIZE, bufs[done + i], PAGE_SIZE);
+            }
+            stored.emplace_back(extent_no, store_extent());
+            done += count;
+        }
+    } catch (InternalError &) {
+        // 映射项还没有指向新写出的数据，可以直接回收；修改后的cache_没有写到磁盘上，之后要重新载入
+        cache_extent_no_ = -1;
+        for (auto &[extent_no, entry] : stored) {
+            if (entry.capacity > 0) {
+                free_space(entry.offset, entry.capacity);
+            }
+        }
+        throw;
+    }
+    try {
+        commit_extents(stored, std::max(num_pages_, start_page_no + num_pages));
+    } catch (InternalError &) {
+        cache_extent_no_ = -1;
+        throw;
+    }
+}
+
+void CompressedFile::extend(int num_pages) {
+    std::scoped_lock lock(latch_);
+    if (num_pages > num_pages_) {
+        num_pages_ = num_pages;
+        write_hdr();
+    }
+}
+
+int64_t CompressedFile::get_physical_size() {
+    std::scoped_lock lock(latch_);
+    int64_t size = 0;
+    for (auto &entry : extents_) {
+        size += entry.capacity;
+    }
+    return size;
+}
+
+void CompressedFile::load_extent(int extent_no) {
+    if (cache_extent_no_ == extent_no) {
+        return;
+    }
+    cache_extent_no_ = -1;
+    if (extent_no >= (int)extents_.size() || extents_[extent_no].length == 0) {
+        memset(cache_.get(), 0, EXTENT_SIZE);
+        cache_extent_no_ = extent_no;
+        return;
+    }
+    const ExtentEntry &entry = extents_[extent_no];
+    char *dst = entry.length == EXTENT_SIZE ? cache_.get() : compress_buf_.get();
+    if (pread(fd_, dst, entry.length, entry.offset) != entry.length) {
+        throw InternalError("CompressedFile::read_page Error");
+    }
+    if (entry.length != EXTENT_SIZE &&
+        LzCodec::decompress(compress_buf_.get(), entry.length, cache_.get(), EXTENT_SIZE) != EXTENT_SIZE) {
+        throw InternalError("CompressedFile: corrupted extent");
+    }
+    cache_extent_no_ = extent_no;
+}
+
+CompressedFile::ExtentEntry CompressedFile::store_extent() {
+    ExtentEntry entry{0, 0, 0};
+    if (is_all_zero(cache_.get(), EXTENT_SIZE)) {
+        return entry;
+    }
+    // 压缩后至少要省下一个扇区，否则原样存放，读取时也省去解压
+    const char *data;
+    int len = LzCodec::compress(cache_.get(), EXTENT_SIZE, compress_buf_.get(), EXTENT_SIZE - SECTOR_SIZE);
+    if (len > 0) {
+        data = compress_buf_.get();
+        entry.length = len;
+    } else {
+        data = cache_.get();
+        entry.length = EXTENT_SIZE;
+    }
+    entry.capacity = align_to_sector(entry.length);
+    // 旧位置在映射项落盘之前仍被占用，不会被分配到
+    entry.offset = allocate_space(entry.capacity);
+    if (pwrite(fd_, data, entry.length, entry.offset) != entry.length) {
+        free_space(entry.offset, entry.capacity);
+        throw InternalError("CompressedFile::write_pages Error");
+    }
+    return entry;
+}
+
+/**
+ * @note 写映射项的过程中出错时，内存中的映射项恢复为旧值，新旧空间都不回收：
+ * 磁盘上的映射项可能已经指向新数据，这些空间在重新打开文件、按映射项重建空闲链表时才回收
+ */
+void CompressedFile::commit_extents(const std::vector<std::pair<int, ExtentEntry>> &stored, int num_pages) {
+    if (fdatasync(fd_) != 0) {
+        throw InternalError("CompressedFile: failed to sync data");
+    }
+    std::vector<ExtentEntry> old_entries;
+    size_t old_num_extents = extents_.size();
+    try {
+        for (auto &[extent_no, entry] : stored) {
+            if (extent_no >= (int)extents_.size()) {
+                extents_.resize(extent_no + 1, ExtentEntry{0, 0, 0});
+            }
+            old_entries.push_back(extents_[extent_no]);
+            extents_[extent_no] = entry;
+            write_entry(extent_no);
+        }
+        if (num_pages != num_pages_ || extents_.size() != old_num_extents) {
+            // 映射项个数增加时同时更新头部，重新打开时才能读到新的映射项
+            num_pages_ = num_pages;
+            write_hdr();
+        }
+        if (fdatasync(map_fd_) != 0) {
+            throw InternalError("CompressedFile: failed to sync map file");
+        }
+    } catch (InternalError &) {
+        for (size_t i = 0; i < old_entries.size(); i++) {
+            extents_[stored[i].first] = old_entries[i];
+        }
+        throw;
+    }
+    for (auto &entry : old_entries) {
+        if (entry.capacity > 0) {
+            free_space(entry.offset, entry.capacity);
+        }
+    }
+}
+
+int64_t CompressedFile::allocate_space(int capacity) {
+    for (auto it = free_list_.begin(); it != free_list_.end(); ++it) {
+        if (it->second >= capacity) {
+            int64_t offset = it->first;
+            int remaining = it->second - capacity;
+            free_list_.erase(it);
+            if (remaining > 0) {
+                free_list_[offset + capacity] = remaining;
+            }
+            return offset;
+        }
+    }
+    int64_t offset = file_end_;
+    file_end_ += capacity;
+    return offset;
+}
+
+void CompressedFile::free_space(int64_t offset, int capacity) {
+    auto next = free_list_.lower_bound(offset);
+    if (next != free_list_.end() && next->first == offset + capacity) {
+        capacity += next->second;
+        next = free_list_.erase(next);
+    }
+    if (next != free_list_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            prev->second += capacity;
+            return;
+        }
+    }
+    free_list_[offset] = capacity;
+}
+
+void CompressedFile::write_hdr() {
+    MapHdr hdr{MAGIC, num_pages_, (int)extents_.size(), 0};
+    if (pwrite(map_fd_, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+        throw InternalError("CompressedFile: failed to write map header");
+    }
+}
+
+void CompressedFile::write_entry(int extent_no) {
+    off_t offset = sizeof(MapHdr) + (off_t)extent_no * sizeof(ExtentEntry);
+    if (pwrite(map_fd_, &extents_[extent_no], sizeof(ExtentEntry), offset) != sizeof(ExtentEntry)) {
+        throw InternalError("CompressedFile: failed to write map entry");
+    }
+}
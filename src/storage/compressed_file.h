@@ -0,0 +1,126 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+/*
+CompressedFile以extent（连续EXTENT_PAGES个页面）为单位压缩存放一个表文件或索引文件，对上层仍表现为按页编号的文件。
+每个extent压缩后存放在数据文件中按SECTOR_SIZE对齐的一段空间里，位置记录在"<文件名>.cmap"映射文件中：
+映射文件开头是MapHdr，之后第e项ExtentEntry对应第e个extent。压缩后没有变小的extent原样存放，从未写过或全零的extent不占空间。
+写入时把extent解压、替换其中的页面后整体重新压缩，压缩结果总是写到空闲链表中或文件末尾的新位置，从不原地覆盖。
+一次write_pages先写出所有extent的数据并fdatasync，再写映射项并fdatasync映射文件，最后才回收旧位置，
+因此崩溃时映射文件中的每一项要么指向完整的旧数据，要么指向已落盘的新数据。
+最近访问的一个extent以解压后的形式缓存，缓冲池顺序读取同一extent中的页面时只需解压一次。
+所有操作由一个互斥锁串行化；压缩文件总是使用缓冲I/O
+*/
+class CompressedFile {
+   public:
+    static constexpr int EXTENT_PAGES = 8;
+    static constexpr int EXTENT_SIZE = EXTENT_PAGES * PAGE_SIZE;
+    static constexpr int SECTOR_SIZE = 512;
+
+    /** @return 数据文件对应的映射文件名 */
+    static std::string map_file_name(const std::string &path) { return path + ".cmap"; }
+
+    /**
+     * @description: 创建空的映射文件
+     * @param {string&} path 数据文件路径
+     * @param {int} num_pages 文件的初始页面数，与普通文件创建时的大小一致
+     */
+    static void create_map(const std::string &path, int num_pages);
+
+    /** @return 映射文件中记录的页面数，读取失败时返回-1 */
+    static int read_num_pages(const std::string &map_path);
+
+    /**
+     * @description: 打开映射文件，读入所有映射项并重建空闲空间链表
+     * @param {int} fd 已打开的数据文件句柄，由调用者关闭
+     * @param {string&} path 数据文件路径
+     */
+    CompressedFile(int fd, const std::string &path);
+
+    ~CompressedFile();
+
+    /**
+     * @description: 读取一个完整页面，页面号超过文件大小时抛出InternalError
+     */
+    void read_page(page_id_t page_no, char *buf);
+
+    /**
+     * @description: 写入从start_page_no开始的连续num_pages个完整页面，每个extent只重新压缩一次
+     */
+    void write_pages(page_id_t start_page_no, const char *const *bufs, int num_pages);
+
+    /**
+     * @description: 把文件的页面数扩大到num_pages，新页面内容为全零，不占用磁盘空间
+     */
+    void extend(int num_pages);
+
+    int get_num_pages() {
+        std::scoped_lock lock(latch_);
+        return num_pages_;
+    }
+
+    /** @return 数据文件中已分配给extent的字节数，不含空闲空间 */
+    int64_t get_physical_size();
+
+   private:
+    static constexpr uint32_t MAGIC = 0x50414d43;  // "CMAP"
+
+    struct MapHdr {
+        uint32_t magic;
+        int num_pages;    // 文件的逻辑页面数
+        int num_extents;  // 映射项个数
+        int reserved;
+    };
+
+    struct ExtentEntry {
+        int64_t offset;    // extent在数据文件中的起始位置
+        int32_t length;    // 压缩后的长度，0表示全零，EXTENT_SIZE表示原样存放
+        int32_t capacity;  // 分配的空间，按SECTOR_SIZE对齐
+    };
+
+    // 把第extent_no个extent解压到cache_中
+    void load_extent(int extent_no);
+
+    // 压缩cache_中的extent并写到新分配的空间，返回新的映射项，不修改extents_
+    ExtentEntry store_extent();
+
+    // 数据落盘后写出stored中的映射项和页面数为num_pages的头部，映射文件落盘后回收旧位置
+    void commit_extents(const std::vector<std::pair<int, ExtentEntry>> &stored, int num_pages);
+
+    int64_t allocate_space(int capacity);
+
+    void free_space(int64_t offset, int capacity);
+
+    void write_hdr();
+
+    void write_entry(int extent_no);
+
+    int fd_;
+    int map_fd_;
+    std::mutex latch_;
+    int num_pages_ = 0;
+    std::vector<ExtentEntry> extents_;
+    std::map<int64_t, int> free_list_;  // 空闲空间：起始位置 -> 长度，相邻的空闲空间合并
+    int64_t file_end_ = 0;              // 数据文件中最后一个extent之后的位置
+    std::unique_ptr<char[]> cache_;     // 解压后的extent
+    int cache_extent_no_ = -1;          // cache_中的extent编号，-1表示无效
+    std::unique_ptr<char[]> compress_buf_;
+};
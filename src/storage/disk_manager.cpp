@@ -11,14 +11,46 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <errno.h>     // for errno
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for preadv, pwritev
+#include <unistd.h>    // for pread, pwrite
+
+#include <algorithm>
+#include <climits>  // for IOV_MAX
+#include <cstdlib>  // for aligned_alloc
 
 #include "defs.h"
 
+/**
+ * @description: O_DIRECT要求用户缓冲区按逻辑块大小对齐，这里统一按PAGE_SIZE检查
+ */
+static bool is_direct_io_aligned(const char *buf) { return reinterpret_cast<uintptr_t>(buf) % PAGE_SIZE == 0; }
+
 DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
 
+/**
+ * @description: 获取当前线程的对齐中转缓冲区，用于O_DIRECT文件上未对齐或不足一页的读写
+ * @return {char*} 大小为PAGE_SIZE、按PAGE_SIZE对齐的缓冲区
+ */
+char *DiskManager::direct_io_buffer() {
+    static thread_local std::unique_ptr<char, decltype(&free)> buffer(
+        static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)), &free);
+    return buffer.get();
+}
+
+/**
+ * @description: 将O_DIRECT文件的写入持久化。O_DIRECT只绕过页缓存，文件大小等元数据和磁盘缓存仍需fdatasync；
+ * 写入时只做标记，由flush_all_pages或关闭文件时统一调用一次，把多次写入合并为一次fdatasync
+ * @param {int} fd 文件句柄
+ */
+void DiskManager::sync_file(int fd) {
+    if (needs_sync_[fd].exchange(false) && fdatasync(fd) != 0) {
+        throw UnixError();
+    }
+}
+
 /**
  * @description: 将数据写入文件的指定磁盘页面中
  * @param {int} fd 磁盘文件的文件句柄
@@ -27,26 +59,48 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
-    // 获取当前文件大小
-    off_t current_size = lseek(fd, 0, SEEK_END);
     if (num_bytes > PAGE_SIZE) {
         throw InternalError("DiskManager::write_page: num_bytes exceeds PAGE_SIZE");
     }
-    if (current_size < (off_t)(page_no + 1) * PAGE_SIZE) {
-        if (ftruncate(fd, (off_t)(page_no + 1) * PAGE_SIZE) == -1) {
-            throw UnixError();
+    if (compressed_[fd]) {
+        if (num_bytes != PAGE_SIZE) {
+            char *buf = direct_io_buffer();
+            memcpy(buf, offset, num_bytes);
+            memset(buf + num_bytes, 0, PAGE_SIZE - num_bytes);
+            offset = buf;
         }
+        compressed_[fd]->write_pages(page_no, &offset, 1);
+        return;
     }
-    lseek(fd, (off_t)page_no * PAGE_SIZE, SEEK_SET);
-    if (write(fd, offset, num_bytes) != num_bytes) {
-        throw InternalError("DiskManager::write_page Error");
+    // 使用带偏移量的pwrite/pwritev，不再依赖共享的文件偏移，多个线程可以并发地读写同一文件；
+    // 写入位置超过文件末尾时内核会自动扩展文件，因此无需先ftruncate
+    off_t file_offset = (off_t)page_no * PAGE_SIZE;
+    if (direct_fd_[fd]) {
+        needs_sync_[fd] = true;
+        // O_DIRECT要求缓冲区地址和长度都按块对齐，不满足时经由对齐的缓冲区整页写出
+        if (num_bytes != PAGE_SIZE || !is_direct_io_aligned(offset)) {
+            char *buf = direct_io_buffer();
+            memcpy(buf, offset, num_bytes);
+            memset(buf + num_bytes, 0, PAGE_SIZE - num_bytes);
+            offset = buf;
+            num_bytes = PAGE_SIZE;
+        }
     }
-    if (num_bytes < PAGE_SIZE) {
-        int remaining_bytes = PAGE_SIZE - num_bytes;
-        char zero_buffer[PAGE_SIZE] = {0};
-        if (write(fd, zero_buffer, remaining_bytes) != remaining_bytes) {
-            throw InternalError("DiskManager::write_page zero padding Error");
+    if (num_bytes == PAGE_SIZE) {
+        if (pwrite(fd, offset, num_bytes, file_offset) != num_bytes) {
+            throw InternalError("DiskManager::write_page Error");
         }
+        return;
+    }
+    // 不足一页的部分补零，数据和填充在一次系统调用中写出
+    static const char zero_buffer[PAGE_SIZE] = {0};
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<char *>(offset);
+    iov[0].iov_len = num_bytes;
+    iov[1].iov_base = const_cast<char *>(zero_buffer);
+    iov[1].iov_len = PAGE_SIZE - num_bytes;
+    if (pwritev(fd, iov, 2, file_offset) != PAGE_SIZE) {
+        throw InternalError("DiskManager::write_page Error");
     }
 }
 
@@ -58,9 +112,190 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  * @param {int} num_bytes 读取的数据量大小
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
-    lseek(fd, (off_t)page_no * PAGE_SIZE, SEEK_SET);
-    if (read(fd, offset, num_bytes) != num_bytes)
+    if (compressed_[fd]) {
+        if (num_bytes == PAGE_SIZE) {
+            compressed_[fd]->read_page(page_no, offset);
+        } else {
+            char *buf = direct_io_buffer();
+            compressed_[fd]->read_page(page_no, buf);
+            memcpy(offset, buf, num_bytes);
+        }
+        return;
+    }
+    if (direct_fd_[fd] && (num_bytes != PAGE_SIZE || !is_direct_io_aligned(offset))) {
+        char *buf = direct_io_buffer();
+        if (pread(fd, buf, PAGE_SIZE, (off_t)page_no * PAGE_SIZE) != PAGE_SIZE) {
+            throw InternalError("DiskManager::read_page Error");
+        }
+        memcpy(offset, buf, num_bytes);
+        return;
+    }
+    if (pread(fd, offset, num_bytes, (off_t)page_no * PAGE_SIZE) != num_bytes) {
         throw InternalError("DiskManager::read_page Error");
+    }
+}
+
+/**
+ * @description: 将文件中从start_page_no开始的连续num_pages个页面读入到bufs指向的各个缓冲区中
+ * 使用preadv，一次系统调用即可读取一段连续页面，各缓冲区在内存中无需连续
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 起始页面编号
+ * @param {char} **bufs 长度为num_pages的缓冲区数组，每个缓冲区大小为PAGE_SIZE
+ * @param {int} num_pages 读取的页面个数
+ */
+void DiskManager::read_pages(int fd, page_id_t start_page_no, char **bufs, int num_pages) {
+    if (compressed_[fd] || (direct_fd_[fd] && !std::all_of(bufs, bufs + num_pages, is_direct_io_aligned))) {
+        // 压缩文件逐页读取，同一extent中的页面只在第一次读取时解压
+        for (int i = 0; i < num_pages; i++) {
+            read_page(fd, start_page_no + i, bufs[i], PAGE_SIZE);
+        }
+        return;
+    }
+    struct iovec iov[IOV_MAX];
+    int done = 0;
+    while (done < num_pages) {
+        int batch = std::min(num_pages - done, (int)IOV_MAX);
+        for (int i = 0; i < batch; i++) {
+            iov[i].iov_base = bufs[done + i];
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        ssize_t expected = (ssize_t)batch * PAGE_SIZE;
+        if (preadv(fd, iov, batch, (off_t)(start_page_no + done) * PAGE_SIZE) != expected) {
+            throw InternalError("DiskManager::read_pages Error");
+        }
+        done += batch;
+    }
+}
+
+/**
+ * @description: 将bufs指向的num_pages个页面写入文件中从start_page_no开始的连续页面
+ * 使用pwritev，一次系统调用即可写出一段连续页面，各缓冲区在内存中无需连续
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 起始页面编号
+ * @param {char} **bufs 长度为num_pages的缓冲区数组，每个缓冲区大小为PAGE_SIZE
+ * @param {int} num_pages 写入的页面个数
+ */
+void DiskManager::write_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    if (compressed_[fd]) {
+        compressed_[fd]->write_pages(start_page_no, bufs, num_pages);
+        return;
+    }
+    if (direct_fd_[fd]) {
+        needs_sync_[fd] = true;
+        if (!std::all_of(bufs, bufs + num_pages, is_direct_io_aligned)) {
+            for (int i = 0; i < num_pages; i++) {
+                write_page(fd, start_page_no + i, bufs[i], PAGE_SIZE);
+            }
+            return;
+        }
+    }
+    struct iovec iov[IOV_MAX];
+    int done = 0;
+    while (done < num_pages) {
+        int batch = std::min(num_pages - done, (int)IOV_MAX);
+        for (int i = 0; i < batch; i++) {
+            iov[i].iov_base = bufs[done + i];
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        ssize_t expected = (ssize_t)batch * PAGE_SIZE;
+        if (pwritev(fd, iov, batch, (off_t)(start_page_no + done) * PAGE_SIZE) != expected) {
+            throw InternalError("DiskManager::write_pages Error");
+        }
+        done += batch;
+    }
+}
+
+/**
+ * @description: 开启异步页面I/O，之后submit_read_page/submit_write_page立即返回，由I/O引擎在后台完成读写
+ * @param {IoBackendType} backend 期望的后端，默认优先使用io_uring，不可用时退回线程池
+ */
+void DiskManager::enable_async_io(IoBackendType backend) {
+    async_io_ = AsyncIoEngine::create(backend, ASYNC_IO_QUEUE_DEPTH, ASYNC_IO_THREADS);
+}
+
+/**
+ * @description: 提交一次整页读请求，调用者可以在等待期间释放自己持有的锁
+ * @return {shared_ptr<AsyncIoHandle>} 请求的完成状态，配合complete_io等待完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 读取的页面编号
+ * @param {char} *buf 读取的内容写入到buf中，大小为PAGE_SIZE，完成前必须保持有效
+ * @param {Callback} callback 完成时在I/O线程中调用，参数为读取的字节数或-errno
+ */
+std::shared_ptr<AsyncIoHandle> DiskManager::submit_read_page(int fd, page_id_t page_no, char *buf,
+                                                             AsyncIoHandle::Callback callback) {
+    auto handle = std::make_shared<AsyncIoHandle>(std::move(callback));
+    // 压缩文件需要在内存中解压，与未对齐的O_DIRECT读取一样同步完成
+    if (compressed_[fd] || (direct_fd_[fd] && !is_direct_io_aligned(buf))) {
+        ssize_t ret = PAGE_SIZE;
+        try {
+            read_page(fd, page_no, buf, PAGE_SIZE);
+        } catch (InternalError &e) {
+            ret = -EIO;
+        }
+        handle->complete(ret);
+        return handle;
+    }
+    if (!async_io_) {
+        ssize_t ret = pread(fd, buf, PAGE_SIZE, (off_t)page_no * PAGE_SIZE);
+        handle->complete(ret < 0 ? -errno : ret);
+        return handle;
+    }
+    async_io_->submit(AsyncIoRequest{IO_OP_READ, fd, buf, PAGE_SIZE, (off_t)page_no * PAGE_SIZE, handle});
+    return handle;
+}
+
+/**
+ * @description: 提交一次整页写请求
+ * @return {shared_ptr<AsyncIoHandle>} 请求的完成状态，配合complete_io等待完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 写入的页面编号
+ * @param {char} *buf 要写入的数据，大小为PAGE_SIZE，完成前必须保持有效
+ * @param {Callback} callback 完成时在I/O线程中调用，参数为写入的字节数或-errno
+ */
+std::shared_ptr<AsyncIoHandle> DiskManager::submit_write_page(int fd, page_id_t page_no, const char *buf,
+                                                              AsyncIoHandle::Callback callback) {
+    auto handle = std::make_shared<AsyncIoHandle>(std::move(callback));
+    if (compressed_[fd]) {
+        ssize_t ret = PAGE_SIZE;
+        try {
+            write_page(fd, page_no, buf, PAGE_SIZE);
+        } catch (InternalError &e) {
+            ret = -EIO;
+        }
+        handle->complete(ret);
+        return handle;
+    }
+    if (direct_fd_[fd]) {
+        needs_sync_[fd] = true;
+        if (!is_direct_io_aligned(buf)) {
+            ssize_t ret = PAGE_SIZE;
+            try {
+                write_page(fd, page_no, buf, PAGE_SIZE);
+            } catch (InternalError &e) {
+                ret = -EIO;
+            }
+            handle->complete(ret);
+            return handle;
+        }
+    }
+    if (!async_io_) {
+        ssize_t ret = pwrite(fd, buf, PAGE_SIZE, (off_t)page_no * PAGE_SIZE);
+        handle->complete(ret < 0 ? -errno : ret);
+        return handle;
+    }
+    async_io_->submit(
+        AsyncIoRequest{IO_OP_WRITE, fd, const_cast<char *>(buf), PAGE_SIZE, (off_t)page_no * PAGE_SIZE, handle});
+    return handle;
+}
+
+/**
+ * @description: 等待一次异步页面I/O完成，未能完整读写一页时与同步接口一样抛出InternalError
+ * @param {shared_ptr<AsyncIoHandle>} &handle submit_read_page/submit_write_page返回的句柄
+ */
+void DiskManager::complete_io(const std::shared_ptr<AsyncIoHandle> &handle) {
+    if (handle->wait() != PAGE_SIZE) {
+        throw InternalError("DiskManager::complete_io Error");
+    }
 }
 
 /**
@@ -71,13 +306,49 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
 page_id_t DiskManager::allocate_page(int fd) {
     assert(fd >= 0 && fd < MAX_FD);
     page_id_t allocated_page = fd2pageno_[fd]++;
-    off_t required_size = (off_t)(allocated_page + 1) * PAGE_SIZE;
-    if (ftruncate(fd, required_size) == -1) {
-        throw UnixError();
+    if (compressed_[fd]) {
+        // 压缩文件的新页面在写出之前不占用磁盘空间，只扩大逻辑大小
+        compressed_[fd]->extend(allocated_page + 1);
+        return allocated_page;
+    }
+    // 并发分配时各线程扩展文件的先后不确定，只能扩大文件，不能把其它线程分配的页面截掉
+    if (fallocate(fd, 0, (off_t)allocated_page * PAGE_SIZE, PAGE_SIZE) == -1) {
+        if (errno != EOPNOTSUPP) {
+            throw UnixError();
+        }
+        grow_file(fd, (off_t)(allocated_page + 1) * PAGE_SIZE);
     }
     return allocated_page;
 }
 
+/**
+ * @description: 文件小于size时用ftruncate扩展到size，已经更大时不变
+ * @param {int} fd 指定文件的文件句柄
+ * @param {off_t} size 文件至少应有的字节数
+ */
+void DiskManager::grow_file(int fd, off_t size) {
+    std::scoped_lock lock(grow_latch_);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        throw UnixError();
+    }
+    if (st.st_size < size && ftruncate(fd, size) == -1) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 归还一个刚分配但没有用上的页号。只有它仍是文件中最后分配的页号时才能归还，
+ * 否则之后的页号已经分配出去，该页留作文件中的空页
+ * @param {int} fd 指定文件的文件句柄
+ * @param {page_id_t} page_no allocate_page返回的页号
+ */
+void DiskManager::release_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD);
+    page_id_t expected = page_no + 1;
+    fd2pageno_[fd].compare_exchange_strong(expected, page_no);
+}
+
 void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
 
 bool DiskManager::is_dir(const std::string& path) {
@@ -115,11 +386,23 @@ bool DiskManager::is_file(const std::string &path) {
  * @description: 用于创建指定路径文件
  * @return {*}
  * @param {string} &path
+ * @param {bool} compressed 是否以压缩格式存放，同时创建映射文件
  */
-void DiskManager::create_file(const std::string &path) {
+void DiskManager::create_file(const std::string &path, bool compressed) {
     if (is_file(path)) throw FileExistsError(path);
+    std::string map_path = CompressedFile::map_file_name(path);
+    if (is_file(map_path)) {
+        // 同名文件残留的映射文件，否则新文件会被当作压缩文件打开
+        unlink(map_path.c_str());
+    }
     int fd = open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
     if (fd == -1) throw UnixError();
+    if (compressed) {
+        // 与普通文件一样初始为一个页面，但全零的页面不占用空间
+        close(fd);
+        CompressedFile::create_map(path, 1);
+        return;
+    }
     if (ftruncate(fd, PAGE_SIZE) == -1) {
         close(fd);
         throw UnixError();
@@ -138,6 +421,10 @@ void DiskManager::destroy_file(const std::string &path) {
     if (unlink(path.c_str()) != 0) {
         throw FileNotFoundError(path);
     }
+    std::string map_path = CompressedFile::map_file_name(path);
+    if (is_file(map_path)) {
+        unlink(map_path.c_str());
+    }
 }
 
 
@@ -145,15 +432,34 @@ void DiskManager::destroy_file(const std::string &path) {
  * @description: 打开指定路径文件 
  * @return {int} 返回打开的文件的文件句柄
  * @param {string} &path 文件所在路径
+ * @param {bool} allow_direct_io 开启直接I/O时是否以O_DIRECT打开该文件，日志文件传入false
  */
-int DiskManager::open_file(const std::string &path) {
+int DiskManager::open_file(const std::string &path, bool allow_direct_io) {
     if (path2fd_.count(path)) {
         throw FileExistsError(path);
     }
-    int fd = open(path.c_str(), O_RDWR);
+    // 压缩文件的extent长度不定，且总是先在内存中解压，使用缓冲I/O
+    bool compressed = is_file(CompressedFile::map_file_name(path));
+    bool direct = direct_io_ && allow_direct_io && !compressed;
+    int fd = open(path.c_str(), O_RDWR | (direct ? O_DIRECT : 0));
+    if (fd < 0 && direct && errno == EINVAL) {
+        // 文件系统（如tmpfs）不支持O_DIRECT，退回缓冲I/O
+        direct = false;
+        fd = open(path.c_str(), O_RDWR);
+    }
     if (fd < 0 || fd >= MAX_FD) {
         throw FileNotFoundError(path);
     }
+    if (compressed) {
+        try {
+            compressed_[fd] = std::make_unique<CompressedFile>(fd, path);
+        } catch (RMDBError &e) {
+            close(fd);
+            throw;
+        }
+    }
+    direct_fd_[fd] = direct;
+    needs_sync_[fd] = false;
     path2fd_[path] = fd;
     fd2path_[fd] = path;
     return fd;
@@ -168,7 +474,10 @@ void DiskManager::close_file(int fd) {
     if (!fd2path_.count(fd)) {
         throw FileNotFoundError("");
     }
+    sync_file(fd);
+    compressed_[fd].reset();
     close(fd);
+    direct_fd_[fd] = false;
     path2fd_.erase(fd2path_[fd]);
     fd2path_.erase(fd);
 }
@@ -180,11 +489,30 @@ void DiskManager::close_file(int fd) {
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_size(const std::string &file_name) {
+    // 压缩文件返回逻辑大小，即页面数乘以PAGE_SIZE
+    std::string map_path = CompressedFile::map_file_name(file_name);
+    if (is_file(map_path)) {
+        int num_pages = CompressedFile::read_num_pages(map_path);
+        return num_pages < 0 ? -1 : num_pages * PAGE_SIZE;
+    }
     struct stat stat_buf;
     int rc = stat(file_name.c_str(), &stat_buf);
     return rc == 0 ? stat_buf.st_size : -1;
 }
 
+/**
+ * @description: 获得文件在磁盘上实际占用的字节数，压缩文件只计算已分配给extent的空间
+ * @return {int64_t} 占用的字节数
+ * @param {int} fd 文件句柄
+ */
+int64_t DiskManager::get_physical_size(int fd) {
+    if (compressed_[fd]) {
+        return compressed_[fd]->get_physical_size();
+    }
+    struct stat stat_buf;
+    return fstat(fd, &stat_buf) == 0 ? stat_buf.st_size : -1;
+}
+
 /**
  * @description: 根据文件句柄获得文件名
  * @return {string} 文件句柄对应文件的文件名
@@ -220,7 +548,7 @@ int DiskManager::get_file_fd(const std::string &file_name) {
 int DiskManager::read_log(char *log_data, int size, int offset) {
     // read log file from the previous end
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        log_fd_ = open_file(LOG_FILE_NAME, false);
     }
     int file_size = get_file_size(LOG_FILE_NAME);
     if (offset > file_size) {
@@ -229,8 +557,7 @@ int DiskManager::read_log(char *log_data, int size, int offset) {
 
     size = std::min(size, file_size - offset);
     if(size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
+    ssize_t bytes_read = pread(log_fd_, log_data, size, offset);
     assert(bytes_read == size);
     return bytes_read;
 }
@@ -243,7 +570,7 @@ int DiskManager::read_log(char *log_data, int size, int offset) {
  */
 void DiskManager::write_log(char *log_data, int size) {
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        log_fd_ = open_file(LOG_FILE_NAME, false);
     }
 
     // write from the file_end
@@ -17,11 +17,15 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include "common/config.h"
-#include "errors.h"  
+#include "errors.h"
+#include "storage/async_io.h"
+#include "storage/compressed_file.h"
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -36,8 +40,55 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void read_pages(int fd, page_id_t start_page_no, char **bufs, int num_pages);
+
+    void write_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
+    /*异步页面I/O*/
+    void enable_async_io(IoBackendType backend = IO_BACKEND_AUTO);
+
+    void disable_async_io() { async_io_.reset(); }
+
+    /**
+     * @description: 当前使用的异步I/O后端名称，未开启异步I/O时为"sync"
+     */
+    const char *async_io_backend() const { return async_io_ ? async_io_->name() : "sync"; }
+
+    std::shared_ptr<AsyncIoHandle> submit_read_page(int fd, page_id_t page_no, char *buf,
+                                                    AsyncIoHandle::Callback callback = nullptr);
+
+    std::shared_ptr<AsyncIoHandle> submit_write_page(int fd, page_id_t page_no, const char *buf,
+                                                     AsyncIoHandle::Callback callback = nullptr);
+
+    void complete_io(const std::shared_ptr<AsyncIoHandle> &handle);
+
+    /*直接I/O*/
+    /**
+     * @description: 设置之后打开的表文件和索引文件是否使用O_DIRECT，绕过内核页缓存，避免页面在内存中缓存两份
+     * 文件系统不支持O_DIRECT时该文件退回普通的缓冲I/O；日志文件总是使用缓冲I/O
+     * @param {bool} enabled 是否开启
+     */
+    void set_direct_io(bool enabled) { direct_io_ = enabled; }
+
+    bool is_direct_io(int fd) const { return direct_fd_[fd]; }
+
+    /*页面压缩*/
+    /**
+     * @description: 文件是否以压缩格式存放，压缩文件的页面读写经由CompressedFile完成
+     */
+    bool is_compressed(int fd) const { return compressed_[fd] != nullptr; }
+
+    /**
+     * @description: 压缩文件在磁盘上实际占用的字节数，非压缩文件返回文件大小
+     */
+    int64_t get_physical_size(int fd);
+
+    void sync_file(int fd);
+
     page_id_t allocate_page(int fd);
 
+    void release_page(int fd, page_id_t page_no);
+
     void deallocate_page(page_id_t page_id);
 
     /*目录操作*/
@@ -50,11 +101,11 @@ class DiskManager {
     /*文件操作*/
     bool is_file(const std::string &path);
 
-    void create_file(const std::string &path);
+    void create_file(const std::string &path, bool compressed = false);
 
     void destroy_file(const std::string &path);
 
-    int open_file(const std::string &path);
+    int open_file(const std::string &path, bool allow_direct_io = true);
 
     void close_file(int fd);
 
@@ -90,10 +141,20 @@ class DiskManager {
     static constexpr int MAX_FD = 8192;
 
    private:
+    char *direct_io_buffer();
+
+    void grow_file(int fd, off_t size);
+
     // 文件打开列表，用于记录文件是否被打开
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    std::unique_ptr<AsyncIoEngine> async_io_;      // 异步I/O引擎，为空时submit_*退化为同步读写
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+    bool direct_io_ = USE_DIRECT_IO;              // 之后打开的文件是否尝试使用O_DIRECT
+    std::atomic<bool> direct_fd_[MAX_FD]{};       // 文件是否以O_DIRECT打开
+    std::atomic<bool> needs_sync_[MAX_FD]{};      // O_DIRECT文件自上次sync_file以来是否有写入
+    std::unique_ptr<CompressedFile> compressed_[MAX_FD];  // 压缩文件的页面映射，非压缩文件为空
+    std::mutex grow_latch_;                       // 文件系统不支持fallocate时串行化grow_file中的比较和扩展
 };
\ No newline at end of file
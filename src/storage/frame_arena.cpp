@@ -0,0 +1,144 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "frame_arena.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "errors.h"
+
+static size_t round_up_to_huge_page(size_t size) {
+    return (size + FrameArena::HUGE_PAGE_SIZE - 1) / FrameArena::HUGE_PAGE_SIZE * FrameArena::HUGE_PAGE_SIZE;
+}
+
+FrameArena::FrameArena(size_t num_frames, int numa_node, bool use_huge_pages, size_t num_used_frames)
+    : num_frames_(num_frames), try_huge_pages_(use_huge_pages) {
+    // 映射大小向上取整到2MB，使整块区域能完全由大页覆盖
+    mapped_size_ = round_up_to_huge_page(num_frames * PAGE_SIZE);
+    // 多映射一个大页的长度，以便把起始地址对齐到2MB，显式大页和透明大页都只能用于对齐的区域；
+    // 缓冲池可以预留远大于当前帧数的区域，用MAP_NORESERVE使未访问的部分不占用可提交内存
+    size_t length = mapped_size_ + HUGE_PAGE_SIZE;
+    void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED) {
+        throw UnixError();
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+    uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (aligned > start) {
+        munmap(addr, aligned - start);
+    }
+    if (aligned + mapped_size_ < start + length) {
+        munmap(reinterpret_cast<void *>(aligned + mapped_size_), start + length - aligned - mapped_size_);
+    }
+    base_ = reinterpret_cast<char *>(aligned);
+    if (use_huge_pages) {
+        madvise(base_, mapped_size_, MADV_HUGEPAGE);
+    }
+    if (numa_node >= 0) {
+        bind_numa_node(base_, mapped_size_, numa_node);
+    }
+    grow(num_used_frames == 0 ? num_frames : num_used_frames);
+}
+
+void FrameArena::grow(size_t num_frames) {
+    size_t size = round_up_to_huge_page(std::min(num_frames, num_frames_) * PAGE_SIZE);
+    if (!try_huge_pages_ || size <= huge_size_) {
+        return;
+    }
+    // 在保留的地址区间上用MAP_FIXED覆盖显式大页，原区间中这部分尚未被访问过，不会丢失数据
+    char *start = base_ + huge_size_;
+    size_t length = size - huge_size_;
+    void *addr = mmap(start, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_FIXED, -1, 0);
+    if (addr == MAP_FAILED) {
+        // 大页不足。失败的MAP_FIXED可能已经拆除了原来的映射，重新建立普通映射
+        try_huge_pages_ = false;
+        addr = mmap(start, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+                    -1, 0);
+        if (addr == MAP_FAILED) {
+            throw UnixError();
+        }
+        madvise(start, length, MADV_HUGEPAGE);
+    } else {
+        huge_size_ = size;
+    }
+    if (numa_node_ >= 0) {
+        bind_numa_node(start, length, numa_node_);
+    }
+}
+
+FrameArena::~FrameArena() { munmap(base_, mapped_size_); }
+
+void FrameArena::release(size_t first, size_t count) {
+    uintptr_t start = reinterpret_cast<uintptr_t>(frame(first));
+    uintptr_t end = reinterpret_cast<uintptr_t>(frame(first + count));
+    uintptr_t huge_end = reinterpret_cast<uintptr_t>(base_) + huge_size_;
+    if (start < huge_end) {
+        // 显式大页部分只能归还完整的大页
+        uintptr_t huge_start = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        uintptr_t huge_stop = std::min(end, huge_end) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if (huge_start < huge_stop) {
+            madvise(reinterpret_cast<void *>(huge_start), huge_stop - huge_start, MADV_DONTNEED);
+        }
+        start = huge_end;
+    }
+    if (start < end) {
+        madvise(reinterpret_cast<void *>(start), end - start, MADV_DONTNEED);
+    }
+}
+
+/**
+ * @description: 将一段区域绑定到指定的NUMA节点。此时内存尚未被访问过，之后首次访问时即在该节点上分配物理页。
+ * 直接使用mbind系统调用，不依赖libnuma；内核或容器不允许时保持默认的分配策略
+ * @param {char*} addr 区域的起始地址，按页对齐
+ * @param {size_t} length 区域的长度
+ * @param {int} numa_node NUMA节点编号
+ */
+void FrameArena::bind_numa_node(char *addr, size_t length, int numa_node) {
+    constexpr int MASK_BITS = 8 * sizeof(unsigned long);
+    if (numa_node >= 64 * MASK_BITS) {
+        return;
+    }
+    unsigned long nodemask[64] = {0};
+    nodemask[numa_node / MASK_BITS] = 1UL << (numa_node % MASK_BITS);
+    if (syscall(SYS_mbind, addr, length, MPOL_BIND, nodemask, 64 * MASK_BITS, 0) == 0) {
+        numa_node_ = numa_node;
+    }
+}
+
+std::vector<int> FrameArena::online_numa_nodes() {
+    std::vector<int> nodes;
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string list;
+    if (in >> list) {
+        // 格式形如"0"、"0-3"或"0,2-3"
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int node = first; node <= last; node++) {
+                nodes.push_back(node);
+            }
+        }
+    }
+    if (nodes.empty()) {
+        nodes.push_back(0);
+    }
+    return nodes;
+}
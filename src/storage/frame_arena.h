@@ -0,0 +1,88 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 缓冲池帧数据的内存区域，与帧的元数据（Page对象）分开存放
+ * 整块区域先用MAP_NORESERVE的普通映射保留地址空间并按2MB对齐，未访问的帧不占用内存；
+ * 优先为正在使用的帧在其上覆盖显式的大页（MAP_HUGETLB），显式大页在映射时就从系统预留的大页池中扣除，
+ * 因此只映射使用中的帧，缓冲池扩大时再由grow扩展。系统没有预留足够的大页时，其余部分通过madvise请求透明大页。
+ * 每一帧都按PAGE_SIZE对齐，可直接用于O_DIRECT。可选地用mbind把整块区域绑定到指定的NUMA节点
+ */
+class FrameArena {
+   public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * @description: 申请num_frames个帧的内存，失败时抛出UnixError
+     * @param {size_t} num_frames 帧的个数
+     * @param {int} numa_node 绑定的NUMA节点，-1表示不绑定
+     * @param {bool} use_huge_pages 是否尝试使用大页
+     * @param {size_t} num_used_frames 一开始使用的帧数，0表示全部使用，显式大页只覆盖这些帧
+     */
+    FrameArena(size_t num_frames, int numa_node = -1, bool use_huge_pages = BUFFER_POOL_HUGE_PAGES,
+               size_t num_used_frames = 0);
+
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    char *frame(size_t frame_id) const { return base_ + frame_id * PAGE_SIZE; }
+
+    size_t get_num_frames() const { return num_frames_; }
+
+    /**
+     * @description: 开始使用前num_frames个帧，为此前未覆盖的部分映射显式大页；
+     * 调用者保证这些新增的帧还没有被访问过。大页不足时不再尝试，这些帧由普通映射提供
+     * @param {size_t} num_frames 使用中的帧数，不能超过get_num_frames()
+     */
+    void grow(size_t num_frames);
+
+    /**
+     * @description: 把[first, first + count)这些帧占用的物理内存归还给操作系统，地址区间仍然保留，
+     * 再次访问时得到全零的新页。显式大页只能整页归还，不足一个大页的部分保持原样
+     * @param {size_t} first 第一个帧
+     * @param {size_t} count 帧的个数
+     */
+    void release(size_t first, size_t count);
+
+    /** @return 是否有帧由显式大页（hugetlbfs）支撑 */
+    bool uses_huge_pages() const { return huge_size_ > 0; }
+
+    /** @return 由显式大页支撑的字节数，从第一帧开始连续 */
+    size_t get_huge_size() const { return huge_size_; }
+
+    /** @return 实际绑定的NUMA节点，未绑定或绑定失败时为-1 */
+    int get_numa_node() const { return numa_node_; }
+
+    /**
+     * @description: 读取/sys/devices/system/node/online得到在线的NUMA节点
+     * @return {vector<int>} 在线节点的编号，无法读取时视为只有节点0
+     */
+    static std::vector<int> online_numa_nodes();
+
+   private:
+    void bind_numa_node(char *addr, size_t length, int numa_node);
+
+    char *base_ = nullptr;
+    size_t mapped_size_ = 0;
+    size_t num_frames_;
+    bool try_huge_pages_;       // 是否还尝试为新使用的帧映射显式大页，映射失败一次后不再尝试
+    size_t huge_size_ = 0;      // [base_, base_ + huge_size_)由显式大页支撑，是HUGE_PAGE_SIZE的整数倍
+    int numa_node_ = -1;
+};
@@ -0,0 +1,182 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/lz_codec.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr int HASH_BITS = 12;
+
+inline uint32_t load32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash32(uint32_t v) { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+// 写出长度的扩展字节，返回新的输出位置，空间不足时返回nullptr
+inline uint8_t *write_length(uint8_t *op, const uint8_t *op_end, int len) {
+    while (len >= 255) {
+        if (op >= op_end) {
+            return nullptr;
+        }
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= op_end) {
+        return nullptr;
+    }
+    *op++ = static_cast<uint8_t>(len);
+    return op;
+}
+
+// 写出一个序列：字面量[anchor, anchor + lit_len)，以及匹配（match_len为0表示最后一个只有字面量的序列）
+inline uint8_t *write_sequence(uint8_t *op, const uint8_t *op_end, const uint8_t *anchor, int lit_len, int offset,
+                               int match_len) {
+    if (op >= op_end) {
+        return nullptr;
+    }
+    uint8_t *token = op++;
+    int lit_code = lit_len < 15 ? lit_len : 15;
+    int match_code = 0;
+    if (match_len > 0) {
+        match_code = match_len - LzCodec::MIN_MATCH < 15 ? match_len - LzCodec::MIN_MATCH : 15;
+    }
+    *token = static_cast<uint8_t>(lit_code << 4 | match_code);
+    if (lit_code == 15 && (op = write_length(op, op_end, lit_len - 15)) == nullptr) {
+        return nullptr;
+    }
+    if (op_end - op < lit_len) {
+        return nullptr;
+    }
+    memcpy(op, anchor, lit_len);
+    op += lit_len;
+    if (match_len == 0) {
+        return op;
+    }
+    if (op_end - op < 2) {
+        return nullptr;
+    }
+    *op++ = static_cast<uint8_t>(offset & 0xff);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    if (match_code == 15) {
+        op = write_length(op, op_end, match_len - LzCodec::MIN_MATCH - 15);
+    }
+    return op;
+}
+
+// 读出长度的扩展字节，累加到len上，输入不完整时返回false
+inline bool read_length(const uint8_t *&ip, const uint8_t *ip_end, int &len) {
+    uint8_t b;
+    do {
+        if (ip >= ip_end) {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+}  // namespace
+
+int LzCodec::compress(const char *src, int src_len, char *dst, int dst_capacity) {
+    const uint8_t *base = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *ip = base;
+    const uint8_t *anchor = base;
+    const uint8_t *ip_end = base + src_len;
+    uint8_t *op = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *op_end = op + dst_capacity;
+
+    // 每个哈希桶记录最近一个4字节序列的位置加1，0表示空
+    int table[1 << HASH_BITS] = {0};
+    while (ip_end - ip >= MIN_MATCH) {
+        uint32_t seq = load32(ip);
+        uint32_t h = hash32(seq);
+        const uint8_t *ref = table[h] > 0 ? base + table[h] - 1 : nullptr;
+        table[h] = static_cast<int>(ip - base) + 1;
+        if (ref == nullptr || ip - ref > MAX_OFFSET || load32(ref) != seq) {
+            ip++;
+            continue;
+        }
+        const uint8_t *match_end = ip + MIN_MATCH;
+        const uint8_t *r = ref + MIN_MATCH;
+        while (match_end < ip_end && *match_end == *r) {
+            match_end++;
+            r++;
+        }
+        op = write_sequence(op, op_end, anchor, static_cast<int>(ip - anchor), static_cast<int>(ip - ref),
+                            static_cast<int>(match_end - ip));
+        if (op == nullptr) {
+            return 0;
+        }
+        ip = match_end;
+        anchor = ip;
+    }
+    op = write_sequence(op, op_end, anchor, static_cast<int>(ip_end - anchor), 0, 0);
+    if (op == nullptr) {
+        return 0;
+    }
+    return static_cast<int>(op - reinterpret_cast<uint8_t *>(dst));
+}
+
+int LzCodec::decompress(const char *src, int src_len, char *dst, int dst_capacity) {
+    const uint8_t *ip = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *ip_end = ip + src_len;
+    uint8_t *base = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *op = base;
+    uint8_t *op_end = base + dst_capacity;
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+        int lit_len = token >> 4;
+        if (lit_len == 15 && !read_length(ip, ip_end, lit_len)) {
+            return -1;
+        }
+        if (ip_end - ip < lit_len || op_end - op < lit_len) {
+            return -1;
+        }
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == ip_end) {
+            break;  // 最后一个序列只有字面量
+        }
+
+        if (ip_end - ip < 2) {
+            return -1;
+        }
+        int offset = ip[0] | ip[1] << 8;
+        ip += 2;
+        int match_len = token & 0x0f;
+        if (match_len == 15 && !read_length(ip, ip_end, match_len)) {
+            return -1;
+        }
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > op - base || op_end - op < match_len) {
+            return -1;
+        }
+        // 匹配可以与输出重叠（偏移小于长度时重复前面的字节），逐字节复制
+        const uint8_t *ref = op - offset;
+        if (offset >= match_len) {
+            memcpy(op, ref, match_len);
+            op += match_len;
+        } else {
+            for (int i = 0; i < match_len; i++) {
+                *op++ = ref[i];
+            }
+        }
+    }
+    return static_cast<int>(op - base);
+}
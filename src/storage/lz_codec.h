@@ -0,0 +1,44 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+/*
+LzCodec是LZ77系列的块压缩算法，编码格式与LZ4的块格式相同：数据由若干序列组成，每个序列依次是
+1字节token（高4位为字面量长度，低4位为匹配长度减4，取15时后面跟若干个扩展字节，每个扩展字节累加，直到某个字节不为255）、
+字面量、2字节小端序的匹配偏移；最后一个序列只有字面量。
+压缩时用哈希表记录每个4字节序列最近出现的位置，只找一个候选，速度优先于压缩率，
+适合定长CHAR字段中大量重复的填充和取值
+*/
+class LzCodec {
+   public:
+    static constexpr int MIN_MATCH = 4;
+    static constexpr int MAX_OFFSET = 65535;
+
+    /**
+     * @description: 压缩一段数据
+     * @return {int} 压缩后的长度，结果超过dst_capacity时返回0，调用者应改为存放原始数据
+     * @param {char*} src 原始数据
+     * @param {int} src_len 原始数据的长度
+     * @param {char*} dst 存放压缩结果
+     * @param {int} dst_capacity dst的大小
+     */
+    static int compress(const char *src, int src_len, char *dst, int dst_capacity);
+
+    /**
+     * @description: 解压一段数据
+     * @return {int} 解压后的长度，数据损坏或结果超过dst_capacity时返回-1
+     * @param {char*} src 压缩数据
+     * @param {int} src_len 压缩数据的长度
+     * @param {char*} dst 存放解压结果
+     * @param {int} dst_capacity dst的大小
+     */
+    static int decompress(const char *src, int src_len, char *dst, int dst_capacity);
+};
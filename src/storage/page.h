@@ -10,6 +10,10 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -21,7 +25,7 @@ struct PageId {
 
     friend bool operator==(const PageId &x, const PageId &y) { return x.fd == y.fd && x.page_no == y.page_no; }
     bool operator<(const PageId& x) const {
-        if(fd < x.fd) return true;
+        if (fd != x.fd) return fd < x.fd;
         return page_no < x.page_no;
     }
 
@@ -29,36 +33,51 @@ struct PageId {
         return "{fd: " + std::to_string(fd) + " page_no: " + std::to_string(page_no) + "}"; 
     }
 
+    /** @return 高32位为fd、低32位为page_no的64位键，不同的PageId对应不同的键 */
     inline int64_t Get() const {
-        return (static_cast<int64_t>(fd << 16) | page_no);
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 32) |
+                                    static_cast<uint32_t>(page_no));
     }
 };
 
-// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+// PageId的哈希算法：对64位的键做splitmix64的混合，键的每一位都会影响结果的所有位。
+// BufferPoolManager用结果的低位选择分区，PageTable用高位选择槽位，两者互不相关
 struct PageIdHash {
-    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+    size_t operator()(const PageId &x) const {
+        uint64_t h = static_cast<uint64_t>(x.Get());
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
 };
 
 template <>
 struct std::hash<PageId> {
-    size_t operator()(const PageId &obj) const { return std::hash<int64_t>()(obj.Get()); }
+    size_t operator()(const PageId &obj) const { return PageIdHash()(obj); }
 };
 
 /**
  * @description: Page类声明, Page是RMDB数据块的单位、是负责数据操作Record模块的操作对象，
  * Page对象在磁盘上有文件存储, 若在Buffer中则有帧偏移, 并非特指Buffer或Disk上的数据
+ * Page对象只保存帧的元数据，页面数据位于缓冲池的FrameArena中，因此元数据数组紧凑、数据按页对齐
  */
 class Page {
     friend class BufferPoolManager;
+    friend class BufferPoolPartition;
 
    public:
     
-    Page() { reset_memory(); }
+    Page() = default;
 
     ~Page() = default;
 
     PageId get_page_id() const { return id_; }
 
+    int get_pin_count() const { return static_cast<int>(state_.load() & PIN_MASK); }
+
     inline char *get_data() { return data_; }
 
     bool is_dirty() const { return is_dirty_; }
@@ -71,20 +90,100 @@ class Page {
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /** 页面内容的读写latch，由上层（如B+树的latch crabbing）在固定页面之后获取、unpin之前释放 */
+    void wlatch() { rw_latch_.lock(); }
+
+    void wunlatch() { rw_latch_.unlock(); }
+
+    void rlatch() { rw_latch_.lock_shared(); }
+
+    void runlatch() { rw_latch_.unlock_shared(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
-    /** page的唯一标识符 */
-    PageId id_;
+    // state_的布局：低32位为pin_count，第32位为IO_PENDING，更高的位是版本号。
+    // 版本号在每次I/O结束和每次更换id_时加一，因此无锁地固定页面时，
+    // 只要对读到的state_做CAS成功，就说明期间帧上没有发生I/O，读到的id_仍然有效
+    static constexpr uint64_t PIN_MASK = 0xffffffffULL;
+    static constexpr uint64_t IO_PENDING = 1ULL << 32;
+    static constexpr uint64_t VERSION_ONE = 1ULL << 33;
+
+    /** 帧上正在进行磁盘I/O（写回被淘汰的脏页或读入新页面），此时帧的内容和id_都不可用 */
+    bool io_pending() const { return state_.load() & IO_PENDING; }
+
+    bool io_busy() const { return io_pending() || flushing_; }
+
+    void pin() { state_.fetch_add(1); }
+
+    /** @return 解除一次固定后的pin_count */
+    int unpin() { return static_cast<int>((state_.fetch_sub(1) - 1) & PIN_MASK); }
+
+    /** 清除drop_file_pages遗留的固定，调用者需保证不会再有对应的unpin */
+    void reset_pin_count() { state_.fetch_and(~PIN_MASK); }
+
+    /** 无论是否被固定都置为io_pending，用于空闲帧和已移出页表的帧 */
+    void begin_io() { state_.fetch_or(IO_PENDING); }
+
+    /**
+     * @description: 仅当帧未被固定且没有进行中的I/O时将其置为io_pending，
+     * 与无锁的try_pin互斥：两者同时进行时只有一个能成功
+     * @return {bool} 是否成功
+     */
+    bool try_begin_io() {
+        uint64_t state = state_.load();
+        while ((state & (PIN_MASK | IO_PENDING)) == 0) {
+            if (state_.compare_exchange_weak(state, state | IO_PENDING)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void end_io() { state_.fetch_add(VERSION_ONE - IO_PENDING); }
+
+    void set_id(PageId id) {
+        id_ = id;
+        id_key_.store(id.Get());
+        state_.fetch_add(VERSION_ONE);
+    }
+
+    /**
+     * @description: 不持有latch地固定页面，只有帧上没有I/O且确实存放着page_id时才会成功
+     * @return {bool} 是否成功固定
+     * @param {PageId} page_id 期望帧中存放的页面
+     */
+    bool try_pin(PageId page_id) {
+        uint64_t state = state_.load(std::memory_order_acquire);
+        if ((state & IO_PENDING) != 0 || id_key_.load(std::memory_order_acquire) != page_id.Get()) {
+            return false;
+        }
+        return state_.compare_exchange_strong(state, state + 1, std::memory_order_acq_rel);
+    }
+
+    /** page的唯一标识符，只在持有所在分区的latch时通过set_id修改 */
+    PageId id_{-1, INVALID_PAGE_ID};
+
+    /** id_的64位键，供不持有latch的try_pin读取 */
+    std::atomic<int64_t> id_key_{PageId{-1, INVALID_PAGE_ID}.Get()};
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool中的偏移地址，指向FrameArena中按PAGE_SIZE对齐的一帧
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
 
     /** 脏页判断 */
     bool is_dirty_ = false;
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** pin_count、io_pending标志和版本号 */
+    std::atomic<uint64_t> state_{0};
+
+    /** 页面由预读载入且尚未被访问过，无锁命中时也会清除 */
+    std::atomic<bool> prefetched_{false};
+
+    /** 保护页面内容的读写latch，与缓冲池自身的分区latch无关 */
+    std::shared_mutex rw_latch_;
+
+    /** 后台清理线程正在写回该页面，此时页面仍可访问，但不能被淘汰、删除或由其他线程写回 */
+    bool flushing_ = false;
 };
\ No newline at end of file
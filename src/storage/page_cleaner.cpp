@@ -0,0 +1,43 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_cleaner.h"
+
+#include <chrono>
+
+#include "buffer_pool_manager.h"
+
+PageCleaner::PageCleaner(BufferPoolManager *bpm, double dirty_ratio, size_t max_pages_per_sec)
+    : bpm_(bpm), dirty_ratio_(dirty_ratio), max_pages_per_sec_(max_pages_per_sec) {
+    thread_ = std::thread(&PageCleaner::run, this);
+}
+
+PageCleaner::~PageCleaner() {
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+/**
+ * @description: 清理线程的主循环，每一轮的写回量不超过限速折算到一个周期内的配额
+ */
+void PageCleaner::run() {
+    const auto interval = std::chrono::milliseconds(PAGE_CLEANER_INTERVAL_MS);
+    const size_t budget = std::max<size_t>(1, max_pages_per_sec_ * PAGE_CLEANER_INTERVAL_MS / 1000);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+        lock.unlock();
+        pages_written_ += bpm_->clean_pages(dirty_ratio_, budget);
+        lock.lock();
+    }
+}
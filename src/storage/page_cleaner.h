@@ -0,0 +1,53 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "common/config.h"
+
+class BufferPoolManager;
+
+/**
+ * @description: 后台页面清理线程
+ * 每隔PAGE_CLEANER_INTERVAL_MS检查一次缓冲池，脏页比例超过目标时从各分区replacer的冷端挑选脏页写回，
+ * 每秒写回的页面数不超过限速。这样被淘汰的页面大多已是干净页，前台的fetch_page不必再承担写回的开销
+ */
+class PageCleaner {
+   public:
+    /**
+     * @description: 创建并启动清理线程
+     * @param {BufferPoolManager*} bpm 要清理的缓冲池
+     * @param {double} dirty_ratio 脏页比例的目标值，超过该值时开始写回
+     * @param {size_t} max_pages_per_sec 每秒最多写回的页面数
+     */
+    PageCleaner(BufferPoolManager *bpm, double dirty_ratio, size_t max_pages_per_sec);
+
+    ~PageCleaner();
+
+    size_t get_pages_written() const { return pages_written_; }
+
+   private:
+    void run();
+
+    BufferPoolManager *bpm_;
+    double dirty_ratio_;
+    size_t max_pages_per_sec_;
+    std::atomic<size_t> pages_written_{0};   // 累计写回的页面数
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
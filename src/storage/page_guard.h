@@ -0,0 +1,71 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <utility>
+
+#include "buffer_pool_manager.h"
+
+/**
+ * @description: 持有一个已pin住的页面，析构时unpin，只能移动不能复制
+ */
+class PageGuard {
+   public:
+    PageGuard() = default;
+
+    /**
+     * @param {BufferPoolManager*} buffer_pool_manager
+     * @param {Page*} page 已由fetch_page或new_page pin住的页面，由PageGuard负责unpin
+     */
+    PageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+        : buffer_pool_manager_(buffer_pool_manager), page_(page) {}
+
+    PageGuard(PageGuard &&other) noexcept
+        : buffer_pool_manager_(other.buffer_pool_manager_), page_(other.page_), is_dirty_(other.is_dirty_) {
+        other.page_ = nullptr;
+    }
+
+    PageGuard &operator=(PageGuard &&other) noexcept {
+        if (this != &other) {
+            release();
+            buffer_pool_manager_ = other.buffer_pool_manager_;
+            page_ = std::exchange(other.page_, nullptr);
+            is_dirty_ = other.is_dirty_;
+        }
+        return *this;
+    }
+
+    PageGuard(const PageGuard &) = delete;
+    PageGuard &operator=(const PageGuard &) = delete;
+
+    ~PageGuard() { release(); }
+
+    Page *get() const { return page_; }
+
+    explicit operator bool() const { return page_ != nullptr; }
+
+    // 释放时按脏页unpin
+    void mark_dirty() { is_dirty_ = true; }
+
+    // 提前unpin页面
+    void release() {
+        if (page_ != nullptr) {
+            buffer_pool_manager_->unpin_page(page_->get_page_id(), is_dirty_);
+            page_ = nullptr;
+        }
+        is_dirty_ = false;
+    }
+
+   private:
+    BufferPoolManager *buffer_pool_manager_ = nullptr;
+    Page *page_ = nullptr;
+    bool is_dirty_ = false;
+};
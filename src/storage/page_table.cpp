@@ -0,0 +1,83 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_table.h"
+
+#include <cassert>
+
+PageTable::PageTable(size_t max_entries) {
+    // 装载率不超过1/4，线性探测的平均探测长度接近1
+    int bits = 3;
+    while ((size_t{1} << bits) < max_entries * 4) {
+        bits++;
+    }
+    slots_ = std::make_unique<Slot[]>(size_t{1} << bits);
+    mask_ = (size_t{1} << bits) - 1;
+    shift_ = 64 - bits;
+}
+
+void PageTable::insert(PageId page_id, frame_id_t frame_id) {
+    const uint64_t key = static_cast<uint64_t>(page_id.Get());
+    assert(key != EMPTY_KEY);
+    for (size_t i = home_slot(page_id);; i = (i + 1) & mask_) {
+        uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+        if (slot_key == key) {
+            slots_[i].frame_id.store(frame_id, std::memory_order_relaxed);
+            return;
+        }
+        if (slot_key == EMPTY_KEY) {
+            assert(size_ < mask_);
+            // 先写帧号再发布键，读到该键的find一定能读到对应的帧号
+            slots_[i].frame_id.store(frame_id, std::memory_order_relaxed);
+            slots_[i].key.store(key, std::memory_order_release);
+            size_++;
+            return;
+        }
+    }
+}
+
+/**
+ * 删除后从空出的槽位向后扫描到第一个空槽位为止，把起始槽位不在(hole, j]之间的条目移入空位，
+ * 保证每个条目从其起始槽位到所在槽位之间没有空槽位。条目先复制到新位置再覆盖旧位置，
+ * 并发的find最多漏掉正在移动的条目，不会读到不存在的键
+ */
+bool PageTable::erase(PageId page_id) {
+    const uint64_t key = static_cast<uint64_t>(page_id.Get());
+    if (key == EMPTY_KEY) {
+        return false;
+    }
+    size_t hole = home_slot(page_id);
+    while (true) {
+        uint64_t slot_key = slots_[hole].key.load(std::memory_order_relaxed);
+        if (slot_key == key) {
+            break;
+        }
+        if (slot_key == EMPTY_KEY) {
+            return false;
+        }
+        hole = (hole + 1) & mask_;
+    }
+    for (size_t j = (hole + 1) & mask_;; j = (j + 1) & mask_) {
+        uint64_t slot_key = slots_[j].key.load(std::memory_order_relaxed);
+        if (slot_key == EMPTY_KEY) {
+            break;
+        }
+        size_t home = home_slot(key_to_page_id(slot_key));
+        // 起始槽位到j的距离不小于hole到j的距离时，条目可以移到hole
+        if (((j - home) & mask_) >= ((j - hole) & mask_)) {
+            slots_[hole].frame_id.store(slots_[j].frame_id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slots_[hole].key.store(slot_key, std::memory_order_release);
+            hole = j;
+        }
+    }
+    slots_[hole].key.store(EMPTY_KEY, std::memory_order_release);
+    size_--;
+    return true;
+}
@@ -0,0 +1,111 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "page.h"
+
+/*
+PageTable是缓冲池分区的页表，记录PageId到帧号的映射，采用线性探测的开放寻址哈希表：
+槽位数在创建时按最大条目数的4倍向上取2的幂，之后不再扩容，insert和erase都不分配内存；
+删除时把后面同一探测链上的条目向前移动（backward shift），因此不需要墓碑。
+修改操作由持有分区latch的线程进行；find不加锁，可以与修改并发执行，
+但并发时可能漏掉正在移动的条目，或读到刚被改写的帧号，调用者需要在帧上验证结果，失败时加锁重新查找。
+*/
+class PageTable {
+   public:
+    /**
+     * @description: 创建页表
+     * @param {size_t} max_entries 同时存在的最大条目数
+     */
+    explicit PageTable(size_t max_entries);
+
+    /**
+     * @description: 查找页面所在的帧，可以不持有latch调用
+     * @return {bool} 是否找到
+     * @param {PageId} page_id 页面
+     * @param {frame_id_t*} frame_id 找到时存储帧号
+     */
+    bool find(PageId page_id, frame_id_t *frame_id) const {
+        const uint64_t key = static_cast<uint64_t>(page_id.Get());
+        for (size_t i = home_slot(page_id);; i = (i + 1) & mask_) {
+            uint64_t slot_key = slots_[i].key.load(std::memory_order_acquire);
+            if (slot_key == key) {
+                *frame_id = slots_[i].frame_id.load(std::memory_order_relaxed);
+                return true;
+            }
+            if (slot_key == EMPTY_KEY) {
+                return false;
+            }
+        }
+    }
+
+    bool contains(PageId page_id) const {
+        frame_id_t frame_id;
+        return find(page_id, &frame_id);
+    }
+
+    // 以下函数的调用者需持有所在分区的latch
+
+    /**
+     * @description: 插入一个条目，页面已存在时修改其帧号
+     * @param {PageId} page_id 页面，不能是无效页面
+     * @param {frame_id_t} frame_id 帧号
+     */
+    void insert(PageId page_id, frame_id_t frame_id);
+
+    /**
+     * @description: 删除一个条目
+     * @return {bool} 页面是否存在
+     * @param {PageId} page_id 页面
+     */
+    bool erase(PageId page_id);
+
+    size_t size() const { return size_; }
+
+    /**
+     * @description: 依次对每个条目调用fn(PageId, frame_id_t)，fn中不能修改页表
+     */
+    template <typename Fn>
+    void for_each(Fn &&fn) const {
+        for (size_t i = 0; i <= mask_; i++) {
+            uint64_t key = slots_[i].key.load(std::memory_order_relaxed);
+            if (key != EMPTY_KEY) {
+                fn(key_to_page_id(key), slots_[i].frame_id.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+   private:
+    // PageId{-1, INVALID_PAGE_ID}的键，不会被插入，用来表示空槽位
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;
+
+    struct Slot {
+        std::atomic<uint64_t> key{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_id{INVALID_FRAME_ID};
+    };
+
+    /** 取哈希值的高位作为起始槽位，BufferPoolManager按低位选择分区，同一分区内的页面低位相同 */
+    size_t home_slot(PageId page_id) const { return PageIdHash()(page_id) >> shift_; }
+
+    static PageId key_to_page_id(uint64_t key) {
+        return PageId{static_cast<int>(key >> 32), static_cast<page_id_t>(static_cast<uint32_t>(key))};
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;       // 槽位数减一
+    int shift_;         // 64减去槽位数的对数
+    size_t size_ = 0;
+};
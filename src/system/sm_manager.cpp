@@ -201,8 +201,10 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<ColDef>&} col_defs 表的字段
  * @param {Context*} context 
+ * @param {TableOptions&} options 建表选项
  */
-void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context) {
+void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                             const TableOptions& options) {
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
@@ -210,7 +212,13 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     int curr_offset = 0;
     TabMeta tab;
     tab.name = tab_name;
+    std::vector<RmField> var_fields;
+    std::vector<RmField> columns;
     for (auto &col_def : col_defs) {
+        if (col_def.var_len) {
+            var_fields.push_back(RmField{curr_offset, col_def.len});
+        }
+        columns.push_back(RmField{curr_offset, col_def.len});
         ColMeta col = {.tab_name = tab_name,
                        .name = col_def.name,
                        .type = col_def.type,
@@ -222,7 +230,14 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     }
     // Create & open record file
     int record_size = curr_offset;  // record_size就是col meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    // 含VARCHAR列的表使用slotted格式，列值只存放实际长度；PAX格式按列存放，VARCHAR列按最大长度存放
+    if (options.pax) {
+        rm_manager_->create_file(tab_name, record_size, RM_PAGE_FORMAT_PAX, columns, options.compressed);
+    } else if (var_fields.empty()) {
+        rm_manager_->create_file(tab_name, record_size, RM_PAGE_FORMAT_FIXED, {}, options.compressed);
+    } else {
+        rm_manager_->create_file(tab_name, record_size, RM_PAGE_FORMAT_SLOTTED, var_fields, options.compressed);
+    }
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
@@ -265,7 +280,7 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
     
     // 删除表文件
     if (disk_manager_->is_file(tab_name)) {
-        disk_manager_->destroy_file(tab_name);
+        rm_manager_->destroy_file(tab_name);
     }
 
     // 从数据库元数据中删除该表
@@ -282,7 +297,53 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {Context*} context
  */
 void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
-    
+    TabMeta &tab = db_.get_table(tab_name);
+    if (tab.is_index(col_names)) {
+        throw IndexExistsError(tab_name, col_names);
+    }
+    IndexMeta index_meta = {.tab_name = tab_name, .col_tot_len = 0, .col_num = (int)col_names.size()};
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (auto &col_name : col_names) {
+        ColMeta &col = *tab.get_col(col_name);
+        index_meta.cols.push_back(col);
+        index_meta.col_tot_len += col.len;
+        col_types.push_back(col.type);
+        col_lens.push_back(col.len);
+    }
+
+    // 表上已有的数据先按键外部排序，再自底向上批量建立B+树，而不是逐条insert_entry
+    RmFileHandle *fh = fhs_.at(tab_name).get();
+    ix_manager_->create_index(tab_name, index_meta.cols, disk_manager_->is_compressed(fh->GetFd()));
+    auto ih = ix_manager_->open_index(tab_name, index_meta.cols);
+    try {
+        IxExternalSorter sorter(col_types, col_lens);
+        std::vector<char> key(index_meta.col_tot_len);
+        for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+            Rid rid = scan.rid();
+            RecordView record = fh->get_record_view(rid, context);
+            int offset = 0;
+            for (auto &col : index_meta.cols) {
+                memcpy(key.data() + offset, record.data() + col.offset, col.len);
+                offset += col.len;
+            }
+            sorter.add(key.data(), rid);
+        }
+        sorter.finish();
+        ih->bulk_load(&sorter);
+    } catch (...) {
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(tab_name, index_meta.cols);
+        throw;
+    }
+
+    for (auto &col_name : col_names) {
+        tab.get_col(col_name)->index = true;
+    }
+    tab.indexes.push_back(index_meta);
+    ihs_.emplace(ix_manager_->get_index_name(tab_name, col_names), std::move(ih));
+
+    flush_meta();
 }
 
 /**
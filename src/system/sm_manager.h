@@ -22,6 +22,13 @@ struct ColDef {
     std::string name;  // Column name
     ColType type;      // Type of column
     int len;           // Length of column
+    bool var_len = false;   // VARCHAR列，只存放实际长度
+};
+
+/* 建表选项 */
+struct TableOptions {
+    bool pax = false;   // 按列存放（PAX）：每个页面中同一列的值连续存放，适合只读取少数列的分析查询
+    bool compressed = false;    // 表文件按extent压缩存放，适合很少更新、以CHAR列为主的冷数据
 };
 
 /* 系统管理器，负责元数据管理和DDL语句的执行 */
@@ -48,6 +55,8 @@ class SmManager {
 
     BufferPoolManager* get_bpm() { return buffer_pool_manager_; }
 
+    DiskManager* get_disk_manager() { return disk_manager_; }
+
     RmManager* get_rm_manager() { return rm_manager_; }  
 
     IxManager* get_ix_manager() { return ix_manager_; }  
@@ -68,7 +77,8 @@ class SmManager {
 
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                      const TableOptions& options = {});
 
     void drop_table(const std::string& tab_name, Context* context);
 
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "record/rm.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeBulkLoadTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                  // 测试表名
+const std::vector<std::string> TEST_COL = {"col1"};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，创建两个INT字段的表TEST_FILE_NAME
+ * 然后向表中插入数据，再由SmManager::create_index批量建立col1上的索引 */
+class BPlusTreeBulkLoadTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef;
+        coldef.push_back({"col1", TYPE_INT, 4});
+        coldef.push_back({"col2", TYPE_INT, 4});
+        sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
+    }
+
+    void TearDown() override {
+        for (auto &entry : sm_->ihs_) {
+            ix_manager_->close_index(entry.second.get());
+        }
+        sm_->ihs_.clear();
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    // 向表中插入col1为keys[i]、col2为i的记录
+    void insert_rows(const std::vector<int> &keys) {
+        RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+        for (size_t i = 0; i < keys.size(); i++) {
+            int buf[2] = {keys[i], (int)i};
+            fh->insert_record(reinterpret_cast<char *>(buf), nullptr);
+        }
+    }
+
+    /**
+     * @brief 检查以page_no为根的子树：孩子的父指针、内部结点的key等于孩子的第一个key、结点大小在范围内
+     *
+     * @return 子树的高度，所有叶子必须在同一层
+     */
+    int check_subtree(IxIndexHandle *ih, page_id_t page_no, page_id_t parent, bool is_root) {
+        IxNodeHandle *node = ih->fetch_node(page_no);
+        EXPECT_EQ(node->get_parent_page_no(), parent);
+        EXPECT_LE(node->get_size(), ih->file_hdr_->btree_order_);
+        if (!is_root) {
+            EXPECT_GE(node->get_size(), node->get_min_size());
+        }
+        int height = 1;
+        if (!node->is_leaf_page()) {
+            int child_height = -1;
+            for (int i = 0; i < node->get_size(); i++) {
+                IxNodeHandle *child = ih->fetch_node(node->value_at(i));
+                EXPECT_EQ(node->key_at(i), child->key_at(0));
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                delete child;
+                int h = check_subtree(ih, node->value_at(i), page_no, false);
+                if (child_height == -1) {
+                    child_height = h;
+                }
+                EXPECT_EQ(h, child_height);
+            }
+            height += child_height;
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return height;
+    }
+
+    // 沿叶子链表从左到右读出所有键值对
+    std::vector<std::pair<int, Rid>> scan_leaves(IxIndexHandle *ih) {
+        std::vector<std::pair<int, Rid>> entries;
+        page_id_t prev = IX_LEAF_HEADER_PAGE;
+        page_id_t page_no = ih->file_hdr_->first_leaf_;
+        while (page_no != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle *leaf = ih->fetch_node(page_no);
+            EXPECT_TRUE(leaf->is_leaf_page());
+            EXPECT_EQ(leaf->get_prev_leaf(), prev);
+            for (int i = 0; i < leaf->get_size(); i++) {
+                entries.emplace_back(leaf->key_at(i), *leaf->get_rid(i));
+            }
+            prev = page_no;
+            page_no = leaf->get_next_leaf();
+            buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+            delete leaf;
+        }
+        EXPECT_EQ(prev, ih->file_hdr_->last_leaf_);
+        return entries;
+    }
+};
+
+/**
+ * @brief 内存上限很小时外部排序溢出为多个run，归并结果与std::sort一致
+ */
+TEST(IxExternalSorterTest, MultiRunMerge) {
+    const int n = 20000;
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = i / 3;  // 含重复key，重复时按Rid排序
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(1));
+
+    IxExternalSorter sorter({TYPE_INT}, {4}, 4096);
+    for (int i = 0; i < n; i++) {
+        sorter.add(reinterpret_cast<const char *>(&keys[i]), Rid{.page_no = i % 7, .slot_no = i});
+    }
+    sorter.finish();
+    EXPECT_GT(sorter.num_runs(), 1);
+    EXPECT_EQ(sorter.size(), (size_t)n);
+
+    std::vector<std::pair<int, std::pair<int, int>>> expected;
+    for (int i = 0; i < n; i++) {
+        expected.push_back({keys[i], {i % 7, i}});
+    }
+    std::sort(expected.begin(), expected.end());
+    int key;
+    Rid rid;
+    for (int i = 0; i < n; i++) {
+        ASSERT_TRUE(sorter.next(reinterpret_cast<char *>(&key), &rid));
+        EXPECT_EQ(key, expected[i].first);
+        EXPECT_EQ(rid.page_no, expected[i].second.first);
+        EXPECT_EQ(rid.slot_no, expected[i].second.second);
+    }
+    EXPECT_FALSE(sorter.next(reinterpret_cast<char *>(&key), &rid));
+}
+
+/**
+ * @brief 在已有数据的表上建索引，检查B+树结构、叶子链表和每个键对应的Rid
+ */
+TEST_F(BPlusTreeBulkLoadTests, BuildOnExistingTable) {
+    const int n = 50000;
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = i * 2 - n;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(2));
+    insert_rows(keys);
+
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    ASSERT_TRUE(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+    ASSERT_TRUE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+
+    int height = check_subtree(ih, ih->file_hdr_->root_page_, IX_NO_PAGE, true);
+    EXPECT_GE(height, 2);
+
+    auto entries = scan_leaves(ih);
+    ASSERT_EQ(entries.size(), (size_t)n);
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(entries[i].first, i * 2 - n);
+        auto rec = fh->get_record(entries[i].second, nullptr);
+        EXPECT_EQ(*reinterpret_cast<int *>(rec->data), entries[i].first);
+    }
+
+    // 叶子按填充率装填，而不是逐条插入后分裂得到的半满结点
+    size_t num_leaves = 0;
+    for (page_id_t p = ih->file_hdr_->first_leaf_; p != IX_LEAF_HEADER_PAGE; num_leaves++) {
+        IxNodeHandle *leaf = ih->fetch_node(p);
+        p = leaf->get_next_leaf();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    int fill = static_cast<int>(ih->file_hdr_->btree_order_ * IX_BULK_FILL_FACTOR);
+    EXPECT_EQ(num_leaves, (size_t)((n + fill - 1) / fill));
+}
+
+/**
+ * @brief 空表和只有一个叶子的情况，根结点仍为初始的叶子结点
+ */
+TEST_F(BPlusTreeBulkLoadTests, SmallTables) {
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+    EXPECT_EQ(ih->file_hdr_->root_page_, IX_INIT_ROOT_PAGE);
+    EXPECT_TRUE(scan_leaves(ih).empty());
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr), IndexExistsError);
+
+    insert_rows({3, 1, 2});
+    sm_->create_index(TEST_FILE_NAME, {"col2"}, nullptr);
+    ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, {"col2"})).get();
+    EXPECT_EQ(ih->file_hdr_->root_page_, IX_INIT_ROOT_PAGE);
+    EXPECT_EQ(check_subtree(ih, ih->file_hdr_->root_page_, IX_NO_PAGE, true), 1);
+    auto entries = scan_leaves(ih);
+    ASSERT_EQ(entries.size(), 3u);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(entries[i].first, i);
+    }
+}
+
+/**
+ * @brief 表中有重复的键时建索引失败，不留下索引文件和元数据
+ */
+TEST_F(BPlusTreeBulkLoadTests, DuplicateKey) {
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; i++) {
+        keys.push_back(i);
+    }
+    keys.push_back(500);
+    insert_rows(keys);
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr), IndexDuplicateKeyError);
+    EXPECT_FALSE(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+    EXPECT_FALSE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    EXPECT_TRUE(sm_->ihs_.empty());
+}
+
+/**
+ * @brief 直接bulk_load时遇到重复的键，索引恢复为空树，之后仍可以批量建立
+ */
+TEST_F(BPlusTreeBulkLoadTests, DuplicateKeyKeepsEmptyTree) {
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+    EXPECT_TRUE(ih->is_empty());
+
+    int n = 2000;
+    {
+        IxExternalSorter sorter({TYPE_INT}, {4});
+        for (int i = 0; i < n; i++) {
+            sorter.add(reinterpret_cast<const char *>(&i), Rid{.page_no = i, .slot_no = 0});
+        }
+        int dup = n - 1;
+        sorter.add(reinterpret_cast<const char *>(&dup), Rid{.page_no = n, .slot_no = 0});
+        sorter.finish();
+        EXPECT_THROW(ih->bulk_load(&sorter), IndexDuplicateKeyError);
+    }
+    EXPECT_TRUE(ih->is_empty());
+    EXPECT_EQ(ih->file_hdr_->root_page_, IX_INIT_ROOT_PAGE);
+    EXPECT_TRUE(scan_leaves(ih).empty());
+
+    IxExternalSorter sorter({TYPE_INT}, {4});
+    for (int i = 0; i < n; i++) {
+        sorter.add(reinterpret_cast<const char *>(&i), Rid{.page_no = i, .slot_no = 0});
+    }
+    sorter.finish();
+    ih->bulk_load(&sorter);
+    EXPECT_FALSE(ih->is_empty());
+    check_subtree(ih, ih->file_hdr_->root_page_, IX_NO_PAGE, true);
+    auto entries = scan_leaves(ih);
+    ASSERT_EQ(entries.size(), (size_t)n);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(entries[i].first, i);
+    }
+}
@@ -463,4 +463,75 @@ TEST_F(BPlusTreeConcurrentTest, MixScaleTest) {
         scan.next();
     }
     EXPECT_EQ(size, keys.size() - delete_keys.size());
-}
\ No newline at end of file
+}
+
+// helper function for the throughput benchmark: 70% lookups, 15% inserts and 15% deletes on random keys
+void MixedWorkloadHelper(IxIndexHandle *tree, int64_t key_range, int num_ops, uint64_t thread_itr = 0) {
+    Transaction *transaction = new Transaction(0);
+    std::default_random_engine rng(thread_itr + 1);
+    std::uniform_int_distribution<int64_t> key_dist(1, key_range);
+    std::uniform_int_distribution<int> op_dist(0, 99);
+    std::vector<Rid> rids;
+    for (int i = 0; i < num_ops; i++) {
+        int64_t key = key_dist(rng);
+        const char *index_key = (const char *)&key;
+        int op = op_dist(rng);
+        if (op < 70) {
+            rids.clear();
+            tree->get_value(index_key, &rids, transaction);
+        } else if (op < 85) {
+            Rid rid = {.page_no = 0, .slot_no = static_cast<int32_t>(key)};
+            tree->insert_entry(index_key, rid, transaction);
+        } else {
+            tree->delete_entry(index_key, transaction);
+        }
+    }
+    delete transaction;
+}
+
+/**
+ * @brief 混合负载下的吞吐量：对比只用latch crabbing的悲观模式和先只对叶子加写latch的乐观模式
+ * 每种模式、每个线程数都从同样的初始数据开始，最后检查叶子层的key有序且与get_value的结果一致
+ */
+TEST_F(BPlusTreeConcurrentTest, ThroughputBenchmark) {
+    const int64_t key_range = 40000;
+    const int total_ops = 200000;
+    const std::vector<int> thread_nums = {1, 2, 4, 8};
+
+    printf("%-12s %8s %14s\n", "mode", "threads", "ops/sec");
+    for (bool optimistic : {false, true}) {
+        for (int thread_num : thread_nums) {
+            // 每轮使用新的索引文件，初始插入一半的key
+            ix_manager_->close_index(ih_.get());
+            ix_manager_->destroy_index(TEST_FILE_NAME, TEST_COL);
+            std::vector<ColMeta> index_cols = {*sm_->db_.get_table(TEST_FILE_NAME).get_col(TEST_COL[0])};
+            ix_manager_->create_index(TEST_FILE_NAME, index_cols);
+            ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+            ih_->set_optimistic(optimistic);
+            std::vector<int64_t> keys;
+            for (int64_t key = 2; key <= key_range; key += 2) {
+                keys.push_back(key);
+            }
+            InsertHelper(ih_.get(), keys);
+
+            auto start = std::chrono::steady_clock::now();
+            LaunchParallelTest(thread_num, MixedWorkloadHelper, ih_.get(), key_range, total_ops / thread_num);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            printf("%-12s %8d %14.0f\n", optimistic ? "optimistic" : "crabbing", thread_num, total_ops / elapsed.count());
+
+            check_tree(ih_.get(), ih_->file_hdr_->root_page_);
+            check_leaf(ih_.get());
+            int64_t prev_key = 0;
+            std::vector<Rid> rids;
+            IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+            while (!scan.is_end()) {
+                int64_t key = scan.rid().slot_no;
+                EXPECT_LT(prev_key, key);
+                rids.clear();
+                EXPECT_TRUE(ih_->get_value((const char *)&key, &rids, txn_.get()));
+                prev_key = key;
+                scan.next();
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @brief 比较逐位查找与按字查找的Bitmap::next_bit在slot查找和顺序扫描上的耗时
+ *
+ * 用法: bitmap_benchmark [num_slots] [iterations]
+ * 负载：num_slots个slot的页面位图，分别为空页、半满（随机）、几乎全满（只剩最后一个空slot）和稀疏（约1%的slot有记录），
+ *      对每个位图执行first_bit(false)（插入时找空闲slot）和从头到尾的next_bit(true)（扫描时遍历记录）。
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "record/bitmap.h"
+
+// 原来逐位测试的实现，作为对照
+static int next_bit_bitwise(bool bit, const char *bm, int max_n, int curr) {
+    for (int i = curr + 1; i < max_n; i++) {
+        if (Bitmap::is_set(bm, i) == bit) {
+            return i;
+        }
+    }
+    return max_n;
+}
+
+template <typename NextBit>
+static double run(NextBit next_bit, const char *bm, int num_slots, int iterations, long *checksum) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        *checksum += next_bit(false, bm, num_slots, -1);
+        for (int i = next_bit(true, bm, num_slots, -1); i < num_slots; i = next_bit(true, bm, num_slots, i)) {
+            *checksum += i;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+}
+
+int main(int argc, char *argv[]) {
+    int num_slots = argc > 1 ? atoi(argv[1]) : 1000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20000;
+    std::mt19937 rng(1);
+
+    struct Workload {
+        const char *name;
+        std::vector<char> bm;
+    };
+    std::vector<Workload> workloads;
+    int num_bytes = (num_slots + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    for (const char *name : {"empty", "half", "almost_full", "sparse"}) {
+        std::vector<char> bm(num_bytes, 0);
+        std::string kind = name;
+        for (int i = 0; i < num_slots; i++) {
+            bool set = kind == "half" ? rng() % 2 == 0 : kind == "almost_full" ? i != num_slots - 1
+                     : kind == "sparse" ? rng() % 100 == 0 : false;
+            if (set) {
+                Bitmap::set(bm.data(), i);
+            }
+        }
+        workloads.push_back({name, std::move(bm)});
+    }
+
+    printf("slots=%d iterations=%d\n", num_slots, iterations);
+    printf("%-12s %14s %14s %8s\n", "bitmap", "bitwise(ns)", "word(ns)", "speedup");
+    for (auto &workload : workloads) {
+        long checksum_bitwise = 0;
+        long checksum_word = 0;
+        double bitwise = run(next_bit_bitwise, workload.bm.data(), num_slots, iterations, &checksum_bitwise);
+        double word = run(Bitmap::next_bit, workload.bm.data(), num_slots, iterations, &checksum_word);
+        if (checksum_bitwise != checksum_word) {
+            fprintf(stderr, "result mismatch on %s\n", workload.name);
+            return 1;
+        }
+        printf("%-12s %14.1f %14.1f %7.1fx\n", workload.name, bitwise, word, bitwise / word);
+    }
+    return 0;
+}
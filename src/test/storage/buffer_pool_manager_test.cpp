@@ -1,8 +1,11 @@
 #include "storage/buffer_pool_manager.h"
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <ctime>
+#include <fstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -115,8 +118,10 @@ TEST_F(BufferPoolManagerTest, SimpleTest) {
     for (int i = 0; i < 5; ++i) {
         EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, true));
     }
+    // 创建失败时分配的页号已归还，新页面的页号仍然连续
     for (int i = 0; i < 4; ++i) {
         EXPECT_NE(nullptr, bpm->new_page(&tmp_page_id));
+        EXPECT_EQ((int)buffer_pool_size + i, tmp_page_id.page_no);
     }
 
     // Scenario: We should be able to fetch the data we wrote a while ago.
@@ -427,3 +432,549 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
 
     disk_manager_->close_file(fd);
 }
+
+/**
+ * @brief 测试缓冲池在各种置换策略下都能正确地淘汰并重新读入页面
+ */
+TEST_F(BufferPoolManagerTest, ReplacerSelectionTest) {
+    const size_t buffer_pool_size = 16;
+    const int num_pages = 64;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    EXPECT_THROW(BufferPoolManager(buffer_pool_size, disk_manager, "MRU"), InternalError);
+
+    for (const std::string replacer_type : {"LRU", "CLOCK", "LRU-K", "2Q"}) {
+        const std::string filename = "replacer_selection_test_" + replacer_type;
+        auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, replacer_type);
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+        disk_manager_->set_fd2pageno(fd, 0);
+
+        // 写入远多于缓冲池容量的页面，迫使置换策略不断淘汰页面
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(i, page_id.page_no);
+            snprintf(page->get_data(), PAGE_SIZE, "page %d", i);
+            EXPECT_TRUE(bpm->unpin_page(page_id, true));
+        }
+        // 以随机顺序读回，内容应与写入时一致
+        for (int round = 0; round < 4 * num_pages; round++) {
+            int page_no = rand() % num_pages;
+            Page *page = bpm->fetch_page(PageId{fd, page_no});
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ("page " + std::to_string(page_no), std::string(page->get_data()));
+            EXPECT_TRUE(bpm->unpin_page(PageId{fd, page_no}, false));
+        }
+        bpm->flush_all_pages(fd);
+        disk_manager_->close_file(fd);
+    }
+}
+
+/**
+ * @brief 测试分区缓冲池：页面分散到各个分区，多线程并发读写、预读和按文件写回的结果正确
+ */
+TEST_F(BufferPoolManagerTest, PartitionedPoolTest) {
+    const size_t buffer_pool_size = 100;
+    const size_t num_partitions = 8;
+    const int num_pages = 400;
+    const int num_threads = 4;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    EXPECT_THROW(BufferPoolManager(buffer_pool_size, disk_manager, "LRU", 0), InternalError);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, "CLOCK", num_partitions);
+    EXPECT_EQ(buffer_pool_size, bpm->get_pool_size());
+    EXPECT_EQ(num_partitions, bpm->get_num_partitions());
+
+    const std::string filename = "partitioned_pool_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    // 页号必须连续分配，不因某个分区暂时没有空闲帧而跳号
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i, page_id.page_no);
+        snprintf(page->get_data(), PAGE_SIZE, "page %d", i);
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    // 各线程随机读写不同的页面集合，最终内容应与各自最后一次写入一致
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&bpm, fd, tid]() {
+            unsigned seed = tid;
+            for (int round = 0; round < 2000; round++) {
+                int page_no = (rand_r(&seed) % (num_pages / num_threads)) * num_threads + tid;
+                Page *page = bpm->fetch_page(PageId{fd, page_no});
+                while (page == nullptr) {
+                    page = bpm->fetch_page(PageId{fd, page_no});
+                }
+                EXPECT_EQ(0, strncmp(page->get_data(), "page ", 5));
+                snprintf(page->get_data(), PAGE_SIZE, "page %d tid %d", page_no, tid);
+                EXPECT_TRUE(bpm->unpin_page(PageId{fd, page_no}, true));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    bpm->flush_all_pages(fd);
+    EXPECT_EQ(bpm->prefetch_pages(fd, 0, 32), 32);
+    for (int page_no = 0; page_no < num_pages; page_no++) {
+        Page *page = bpm->fetch_page(PageId{fd, page_no});
+        ASSERT_NE(nullptr, page);
+        std::string expected = "page " + std::to_string(page_no);
+        std::string data = page->get_data();
+        EXPECT_TRUE(data == expected || data == expected + " tid " + std::to_string(page_no % num_threads));
+        EXPECT_TRUE(bpm->unpin_page(PageId{fd, page_no}, false));
+    }
+    EXPECT_EQ(bpm->get_prefetch_issued(), 32u);
+    EXPECT_EQ(bpm->get_prefetch_hits(), 32u);
+
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试磁盘I/O期间释放latch后的并发正确性：缓冲池远小于工作集，
+ *        多个线程同时读入同一页面、写回被淘汰的脏页，读到的内容始终是最后一次写入的内容
+ */
+TEST_F(BufferPoolManagerTest, InFlightIoTest) {
+    const size_t buffer_pool_size = 8;
+    const int num_shared_pages = 16;
+    const int num_private_pages = 32;
+    const int num_threads = 4;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    // 未命中的读和脏页写回经由异步I/O引擎完成，其余测试点覆盖同步读写
+    disk_manager->enable_async_io();
+    std::cout << "async io backend: " << disk_manager->async_io_backend() << std::endl;
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+
+    const std::string filename = "in_flight_io_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+    const int num_pages = num_shared_pages + num_private_pages;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->get_data(), PAGE_SIZE, "page %d round 0", i);
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    // 前num_shared_pages个页面只读且被所有线程访问，其余页面按页号分给各线程读写；
+    // 同时不断执行后台清理，其写回不能与淘汰、重新读入的页面交错而读到旧数据
+    std::atomic<bool> done{false};
+    std::thread cleaner([&bpm, &done]() {
+        while (!done) {
+            bpm->clean_pages(0.0, buffer_pool_size);
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&bpm, fd, tid]() {
+            unsigned seed = tid;
+            std::vector<int> rounds(num_private_pages, 0);
+            for (int op = 0; op < 3000; op++) {
+                bool shared = rand_r(&seed) % 2 == 0;
+                int idx = shared ? rand_r(&seed) % num_shared_pages
+                                 : (rand_r(&seed) % (num_private_pages / num_threads)) * num_threads + tid;
+                int page_no = shared ? idx : num_shared_pages + idx;
+                Page *page = bpm->fetch_page(PageId{fd, page_no});
+                while (page == nullptr) {
+                    std::this_thread::yield();
+                    page = bpm->fetch_page(PageId{fd, page_no});
+                }
+                int round = shared ? 0 : rounds[idx];
+                EXPECT_EQ("page " + std::to_string(page_no) + " round " + std::to_string(round),
+                          std::string(page->get_data()));
+                if (!shared) {
+                    rounds[idx]++;
+                    snprintf(page->get_data(), PAGE_SIZE, "page %d round %d", page_no, rounds[idx]);
+                }
+                EXPECT_TRUE(bpm->unpin_page(PageId{fd, page_no}, !shared));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    done = true;
+    cleaner.join();
+
+    // 所有固定都已释放，页面都可以被删除
+    for (int i = 0; i < num_pages; i++) {
+        EXPECT_TRUE(bpm->delete_page(PageId{fd, i}));
+    }
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试后台页面清理：只写回日志已落盘的页面，并把脏页比例降到目标值
+ */
+TEST_F(BufferPoolManagerTest, PageCleanerTest) {
+    const size_t buffer_pool_size = 128;
+    const int num_pages = 32;  // 远小于每个分区的容量，页面都留在缓冲池中
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, "LRU", 4);
+
+    const std::string filename = "page_cleaner_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        page->set_page_lsn(i);
+        snprintf(page->get_data() + Page::OFFSET_PAGE_HDR, PAGE_SIZE - Page::OFFSET_PAGE_HDR, "page %d", i);
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    EXPECT_EQ((size_t)num_pages, bpm->get_dirty_page_count());
+
+    // 日志只持久化到15，page_lsn更大的页面不能写回
+    bpm->set_persist_lsn_source([]() { return 15; });
+    EXPECT_EQ(16u, bpm->clean_pages(0.0, num_pages));
+    EXPECT_EQ(16u, bpm->get_dirty_page_count());
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, 15, buf, PAGE_SIZE);
+    EXPECT_EQ("page 15", std::string(buf + Page::OFFSET_PAGE_HDR));
+    disk_manager_->read_page(fd, 16, buf, PAGE_SIZE);
+    EXPECT_EQ("", std::string(buf + Page::OFFSET_PAGE_HDR));
+
+    // 脏页比例未超过目标值时不写回
+    bpm->set_persist_lsn_source([]() { return 1000; });
+    EXPECT_EQ(0u, bpm->clean_pages(0.5, num_pages));
+
+    // 后台线程把剩余的脏页全部写回
+    bpm->start_page_cleaner(0.0, 100000);
+    for (int i = 0; i < 100 && bpm->get_dirty_page_count() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(0u, bpm->get_dirty_page_count());
+    EXPECT_EQ(16u, bpm->get_pages_cleaned());
+    bpm->stop_page_cleaner();
+
+    // 所有页面都已写回，直接从磁盘读到的内容与缓冲池中一致
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->read_page(fd, i, buf, PAGE_SIZE);
+        EXPECT_EQ("page " + std::to_string(i), std::string(buf + Page::OFFSET_PAGE_HDR));
+    }
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试帧数据区：每一帧按PAGE_SIZE对齐且互不重叠，缓冲池中的页面数据都位于对齐的帧上
+ */
+TEST_F(BufferPoolManagerTest, FrameArenaTest) {
+    for (bool use_huge_pages : {true, false}) {
+        const size_t num_frames = 1000;
+        FrameArena arena(num_frames, FrameArena::online_numa_nodes()[0], use_huge_pages);
+        EXPECT_EQ(num_frames, arena.get_num_frames());
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(arena.frame(0)) % FrameArena::HUGE_PAGE_SIZE);
+        for (size_t i = 0; i < num_frames; i++) {
+            EXPECT_EQ(arena.frame(0) + i * PAGE_SIZE, arena.frame(i));
+            memset(arena.frame(i), (int)i, PAGE_SIZE);
+        }
+        for (size_t i = 0; i < num_frames; i++) {
+            EXPECT_EQ((char)i, arena.frame(i)[0]);
+            EXPECT_EQ((char)i, arena.frame(i)[PAGE_SIZE - 1]);
+        }
+        if (!use_huge_pages) {
+            EXPECT_FALSE(arena.uses_huge_pages());
+        }
+    }
+
+    // 预留的帧远多于使用中的帧时，显式大页只覆盖使用中的帧，grow之后原有帧的数据保持不变
+    {
+        const size_t num_frames = 4096, num_used = 600;
+        FrameArena arena(num_frames, -1, true, num_used);
+        EXPECT_LE(arena.get_huge_size(), (num_used * PAGE_SIZE + FrameArena::HUGE_PAGE_SIZE - 1) /
+                                             FrameArena::HUGE_PAGE_SIZE * FrameArena::HUGE_PAGE_SIZE);
+        for (size_t i = 0; i < num_used; i++) {
+            memset(arena.frame(i), (int)i, PAGE_SIZE);
+        }
+        size_t huge_size = arena.get_huge_size();
+        arena.grow(num_frames);
+        // 大页不足时新增的帧由普通映射提供
+        EXPECT_GE(arena.get_huge_size(), huge_size);
+        EXPECT_LE(arena.get_huge_size(), num_frames * PAGE_SIZE);
+        for (size_t i = 0; i < num_frames; i++) {
+            if (i < num_used) {
+                EXPECT_EQ((char)i, arena.frame(i)[PAGE_SIZE - 1]);
+            }
+            memset(arena.frame(i), (int)(i + 1), PAGE_SIZE);
+        }
+        arena.release(num_used, num_frames - num_used);
+        EXPECT_EQ((char)(num_used), arena.frame(num_used - 1)[0]);
+        std::cout << "huge pages: " << arena.get_huge_size() / FrameArena::HUGE_PAGE_SIZE << std::endl;
+    }
+
+    auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager_.get(), "LRU", 4);
+    const std::string filename = "frame_arena_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+    for (int i = 0; i < 8; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->get_data()) % PAGE_SIZE);
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试在线调整缓冲池大小：扩大后能容纳更多页面；缩小时等待被回收帧上的固定释放，
+ * 写回其中的脏页，期间其他线程照常读取页面
+ */
+TEST_F(BufferPoolManagerTest, ResizeTest) {
+    const int num_pages = 64;
+    auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager_.get(), "LRU", 2, 128);
+    EXPECT_EQ(128u, bpm->get_max_pool_size());
+    EXPECT_THROW(bpm->resize(1), InternalError);
+    EXPECT_THROW(bpm->resize(129), InternalError);
+
+    const std::string filename = "resize_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->get_data(), PAGE_SIZE, "page %d", i);
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    // 扩大后所有页面可以同时被固定
+    bpm->resize(128);
+    EXPECT_EQ(128u, bpm->get_pool_size());
+    for (int i = 0; i < num_pages; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page " + std::to_string(i), std::string(page->get_data()));
+        snprintf(page->get_data(), PAGE_SIZE, "page %d v2", i);
+    }
+
+    // 所有页面仍被固定，缩小需要等到它们被释放
+    std::atomic<bool> resized{false};
+    std::thread shrinker([&] {
+        bpm->resize(16);
+        resized = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(resized);
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        for (int round = 0; !done; round++) {
+            int page_no = round % num_pages;
+            Page *page = bpm->fetch_page(PageId{fd, page_no});
+            if (page == nullptr) {
+                continue;
+            }
+            EXPECT_EQ("page " + std::to_string(page_no) + " v2", std::string(page->get_data()));
+            bpm->unpin_page(PageId{fd, page_no}, false);
+        }
+    });
+    for (int i = 0; i < num_pages; i++) {
+        EXPECT_TRUE(bpm->unpin_page(PageId{fd, i}, true));
+    }
+    shrinker.join();
+    done = true;
+    reader.join();
+    EXPECT_TRUE(resized);
+    EXPECT_EQ(16u, bpm->get_pool_size());
+
+    // 缩小后最多只能同时固定16个页面，被淘汰的页面已写回磁盘
+    std::vector<PageId> pinned;
+    for (int i = 0; i < num_pages; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        if (page == nullptr) {
+            continue;
+        }
+        EXPECT_EQ("page " + std::to_string(i) + " v2", std::string(page->get_data()));
+        pinned.push_back(page->get_page_id());
+    }
+    EXPECT_GE(16u, pinned.size());
+    EXPECT_LT(0u, pinned.size());
+    for (auto &page_id : pinned) {
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试缓冲池统计：命中、缺失、淘汰和写回的计数，按文件的统计，I/O延迟直方图以及定期输出
+ */
+TEST_F(BufferPoolManagerTest, StatsTest) {
+    const int num_pages = 16;
+    auto bpm = std::make_unique<BufferPoolManager>(8, disk_manager_.get(), "LRU", 1);
+
+    const std::string filename = "stats_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+    // 创建16个脏页，后8个页面挤出前8个页面
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    for (int i = 8; i < num_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, i}));
+        EXPECT_TRUE(bpm->unpin_page(PageId{fd, i}, false));
+    }
+    for (int i = 0; i < 4; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, i}));
+        EXPECT_TRUE(bpm->unpin_page(PageId{fd, i}, false));
+    }
+
+    BufferPoolStats stats = bpm->get_stats();
+    EXPECT_EQ(8u, stats.pool_size);
+    EXPECT_EQ(8u, stats.hits);
+    EXPECT_EQ(4u, stats.misses);
+    EXPECT_EQ(12u, stats.evictions);
+    EXPECT_EQ(12u, stats.writebacks);
+    EXPECT_EQ(4u, stats.dirty_pages);
+    EXPECT_DOUBLE_EQ(8.0 / 12, stats.hit_ratio());
+    EXPECT_EQ(4u, stats.read_latency.count);
+    EXPECT_EQ(12u, stats.write_latency.count);
+    uint64_t bucketed = 0;
+    for (uint64_t count : stats.write_latency.buckets) {
+        bucketed += count;
+    }
+    EXPECT_EQ(12u, bucketed);
+    EXPECT_LT(0u, stats.latch_acquisitions);
+    ASSERT_EQ(1u, stats.files.count(fd));
+    EXPECT_EQ(8u, stats.files[fd].hits);
+    EXPECT_EQ(4u, stats.files[fd].misses);
+    EXPECT_EQ(12u, stats.files[fd].evictions);
+    EXPECT_EQ(12u, stats.files[fd].writebacks);
+    EXPECT_NE(std::string::npos, stats.to_string().find("hits=8 misses=4"));
+
+    // 定期输出到文件
+    const std::string dump_file = "stats_test_dump.txt";
+    std::remove(dump_file.c_str());
+    bpm->start_stats_dump(dump_file, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    bpm->stop_stats_dump();
+    std::ifstream dump(dump_file);
+    std::string content((std::istreambuf_iterator<char>(dump)), std::istreambuf_iterator<char>());
+    EXPECT_NE(std::string::npos, content.find("hits=8 misses=4"));
+    EXPECT_NE(std::string::npos, content.find("file " + filename));
+
+    // 关闭文件后不再保留它的统计，整个缓冲池的计数仍然累计
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+    stats = bpm->get_stats();
+    EXPECT_EQ(0u, stats.files.count(fd));
+    EXPECT_EQ(20u, stats.writebacks);
+}
+
+/**
+ * @brief 测试页表：页号超过65535时不同文件的页面互不冲突，插入、修改和删除（含向前移动的条目）与unordered_map一致
+ */
+TEST(PageTableTest, BasicTest) {
+    EXPECT_NE(PageId({1, 65536}).Get(), PageId({2, 0}).Get());
+    EXPECT_NE(PageIdHash()(PageId{1, 65536}), PageIdHash()(PageId{2, 0}));
+    EXPECT_TRUE(PageId({1, 5}) < PageId({2, 0}));
+    EXPECT_FALSE(PageId({2, 0}) < PageId({1, 5}));
+
+    const size_t max_entries = 1024;
+    PageTable page_table(max_entries);
+    std::unordered_map<PageId, frame_id_t> expected;
+    frame_id_t frame_id;
+    EXPECT_FALSE(page_table.find(PageId{1, 65536}, &frame_id));
+    EXPECT_FALSE(page_table.erase(PageId{-1, INVALID_PAGE_ID}));
+
+    unsigned seed = 7;
+    for (int round = 0; round < 100000; round++) {
+        // 少量文件和大页号的组合，既有旧哈希下会冲突的键，也让探测链足够长
+        PageId page_id{3 + static_cast<int>(rand_r(&seed) % 4), static_cast<page_id_t>(rand_r(&seed) % 1500) * 65536};
+        int op = rand_r(&seed) % 3;
+        if (op == 0 || (op == 1 && expected.size() < max_entries)) {
+            if (expected.size() < max_entries || expected.count(page_id)) {
+                frame_id_t value = rand_r(&seed) % 1000;
+                page_table.insert(page_id, value);
+                expected[page_id] = value;
+            }
+        } else {
+            EXPECT_EQ(expected.erase(page_id) == 1, page_table.erase(page_id));
+        }
+    }
+    EXPECT_EQ(expected.size(), page_table.size());
+    for (auto &entry : expected) {
+        ASSERT_TRUE(page_table.find(entry.first, &frame_id));
+        EXPECT_EQ(entry.second, frame_id);
+    }
+    size_t visited = 0;
+    page_table.for_each([&](PageId page_id, frame_id_t value) {
+        visited++;
+        ASSERT_EQ(1u, expected.count(page_id));
+        EXPECT_EQ(expected[page_id], value);
+    });
+    EXPECT_EQ(expected.size(), visited);
+}
+
+/**
+ * @brief 测试不持有latch的命中路径：多线程在频繁淘汰的小缓冲池中读取页面，固定到的页面内容始终是所请求的页面
+ */
+TEST_F(BufferPoolManagerTest, UnlatchedHitTest) {
+    const int num_pages = 256;
+    const int num_threads = 8;
+    for (const std::string replacer_type : {"CLOCK", "LRU"}) {
+        auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager_.get(), replacer_type, 4);
+        const std::string filename = "unlatched_hit_test_" + replacer_type;
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+        disk_manager_->set_fd2pageno(fd, 0);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            snprintf(page->get_data(), PAGE_SIZE, "page %d", i);
+            EXPECT_TRUE(bpm->unpin_page(page_id, true));
+        }
+
+        // 一半的访问落在8个热点页面上，使无锁命中与其他页面的淘汰、读入交错进行
+        std::atomic<uint64_t> fetches{0};
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.emplace_back([&bpm, &fetches, fd, tid]() {
+                unsigned seed = tid;
+                for (int round = 0; round < 5000; round++) {
+                    int page_no = rand_r(&seed) % 2 ? rand_r(&seed) % 8 : rand_r(&seed) % num_pages;
+                    PageId page_id{fd, page_no};
+                    Page *page = bpm->fetch_page(page_id);
+                    if (page == nullptr) {
+                        continue;   // 所有帧都被固定
+                    }
+                    fetches++;
+                    EXPECT_EQ(page_id, page->get_page_id());
+                    EXPECT_EQ("page " + std::to_string(page_no), std::string(page->get_data()));
+                    EXPECT_TRUE(bpm->unpin_page(page_id, false));
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        BufferPoolStats stats = bpm->get_stats();
+        EXPECT_EQ(fetches.load(), stats.hits + stats.misses);
+        EXPECT_LT(0u, stats.hits);
+
+        bpm->flush_all_pages(fd);
+        disk_manager_->close_file(fd);
+    }
+}
@@ -1,11 +1,15 @@
 #include "storage/disk_manager.h"
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "storage/lz_codec.h"
 
 constexpr int MAX_FILES = 32;
 constexpr int MAX_PAGES = 128;
@@ -147,3 +151,307 @@ TEST_F(DiskManagerTest, PageOperation) {
     disk_manager_->destroy_file(filename);
     EXPECT_EQ(disk_manager_->is_file(filename), false);
 }
+
+/**
+ * @brief 多个线程并发分配页面并立即写入，先分配的线程扩展文件时不能截掉其它线程已写入的页面
+ */
+TEST_F(DiskManagerTest, ConcurrentAllocatePage) {
+    const std::string filename = "ConcurrentAllocatePageTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    const int num_threads = 8;
+    const int pages_per_thread = 256;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&]() {
+            char data[PAGE_SIZE];
+            for (int i = 0; i < pages_per_thread; i++) {
+                page_id_t page_no = disk_manager_->allocate_page(fd);
+                std::memset(data, 0, sizeof(data));
+                std::memcpy(data, &page_no, sizeof(page_no));
+                disk_manager_->write_page(fd, page_no, data, PAGE_SIZE);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    int num_pages = num_threads * pages_per_thread;
+    EXPECT_EQ(disk_manager_->get_file_size(filename), num_pages * PAGE_SIZE);
+    char buf[PAGE_SIZE];
+    for (page_id_t page_no = 0; page_no < num_pages; page_no++) {
+        disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);
+        page_id_t stored;
+        std::memcpy(&stored, buf, sizeof(stored));
+        ASSERT_EQ(stored, page_no);
+    }
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试连续页面的向量化读写 read_pages/write_pages，以及不足一页时的补零写入
+ */
+TEST_F(DiskManagerTest, VectoredPageOperation) {
+    const std::string filename = "VectoredPageOperationTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    // 各页缓冲区在内存中不连续，通过一次write_pages写到连续的磁盘页面上
+    std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<char *> data_ptrs(MAX_PAGES);
+    for (int i = 0; i < MAX_PAGES; i++) {
+        rand_buf(data[i].data(), PAGE_SIZE);
+        data[i][0] = (char)i;
+        data_ptrs[i] = data[i].data();
+    }
+    disk_manager_->write_pages(fd, 1, data_ptrs.data(), MAX_PAGES);
+
+    // 逐页读取与整体读取都应得到相同的数据
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < MAX_PAGES; i++) {
+        disk_manager_->read_page(fd, 1 + i, buf, PAGE_SIZE);
+        EXPECT_EQ(std::memcmp(buf, data[i].data(), PAGE_SIZE), 0);
+    }
+    std::vector<std::vector<char>> read_back(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<char *> read_ptrs(MAX_PAGES);
+    for (int i = 0; i < MAX_PAGES; i++) {
+        read_ptrs[i] = read_back[i].data();
+    }
+    disk_manager_->read_pages(fd, 1, read_ptrs.data(), MAX_PAGES);
+    for (int i = 0; i < MAX_PAGES; i++) {
+        EXPECT_EQ(read_back[i], data[i]);
+    }
+
+    // 写入不足一页的数据时，页面剩余部分补零
+    const int partial = 100;
+    disk_manager_->write_page(fd, MAX_PAGES + 1, data[0].data(), partial);
+    disk_manager_->read_page(fd, MAX_PAGES + 1, buf, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf, data[0].data(), partial), 0);
+    for (int i = partial; i < PAGE_SIZE; i++) {
+        EXPECT_EQ(buf[i], 0);
+    }
+    EXPECT_EQ(disk_manager_->get_file_size(filename), (MAX_PAGES + 2) * PAGE_SIZE);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试异步页面I/O submit_read_page/submit_write_page，io_uring和线程池两种后端都需要测试
+ */
+TEST_F(DiskManagerTest, AsyncPageOperation) {
+    const std::string filename = "AsyncPageOperationTestFile";
+    for (IoBackendType backend : {IO_BACKEND_AUTO, IO_BACKEND_THREAD_POOL}) {
+        if (disk_manager_->is_file(filename)) {
+            disk_manager_->destroy_file(filename);
+        }
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+        disk_manager_->enable_async_io(backend);
+
+        // 一次提交所有写请求，再统一等待完成
+        std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+        std::vector<std::shared_ptr<AsyncIoHandle>> handles;
+        std::atomic<int> num_callbacks{0};
+        for (int i = 0; i < MAX_PAGES; i++) {
+            rand_buf(data[i].data(), PAGE_SIZE);
+            data[i][0] = (char)i;
+            handles.push_back(disk_manager_->submit_write_page(fd, i, data[i].data(), [&](ssize_t result) {
+                EXPECT_EQ(result, PAGE_SIZE);
+                num_callbacks++;
+            }));
+        }
+        for (auto &handle : handles) {
+            disk_manager_->complete_io(handle);
+        }
+        EXPECT_EQ(num_callbacks.load(), MAX_PAGES);
+
+        handles.clear();
+        std::vector<std::vector<char>> read_back(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+        for (int i = 0; i < MAX_PAGES; i++) {
+            handles.push_back(disk_manager_->submit_read_page(fd, i, read_back[i].data()));
+        }
+        for (int i = 0; i < MAX_PAGES; i++) {
+            disk_manager_->complete_io(handles[i]);
+            EXPECT_EQ(read_back[i], data[i]);
+        }
+
+        // 读取超过文件末尾的页面会得到不完整的结果
+        char buf[PAGE_SIZE];
+        auto handle = disk_manager_->submit_read_page(fd, MAX_PAGES + 10, buf);
+        EXPECT_THROW(disk_manager_->complete_io(handle), InternalError);
+
+        disk_manager_->disable_async_io();
+        disk_manager_->close_file(fd);
+        disk_manager_->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 测试O_DIRECT模式：对齐与未对齐的缓冲区、不足一页的读写都能得到正确的数据
+ */
+TEST_F(DiskManagerTest, DirectIoOperation) {
+    const std::string filename = "DirectIoOperationTestFile";
+    for (auto &name : {filename, filename + ".log"}) {
+        if (disk_manager_->is_file(name)) {
+            disk_manager_->destroy_file(name);
+        }
+    }
+    disk_manager_->create_file(filename);
+    disk_manager_->create_file(filename + ".log");
+    disk_manager_->set_direct_io(true);
+    int fd = disk_manager_->open_file(filename);
+    int buffered_fd = disk_manager_->open_file(filename + ".log", false);
+    disk_manager_->set_direct_io(false);
+    // ext4、xfs等支持O_DIRECT；不支持的文件系统会退回缓冲I/O，以下读写结果应相同
+    std::cout << "direct io: " << disk_manager_->is_direct_io(fd) << std::endl;
+    EXPECT_FALSE(disk_manager_->is_direct_io(buffered_fd));
+
+    // 对齐的缓冲区直接读写，未对齐的缓冲区经由中转缓冲区
+    std::unique_ptr<char, decltype(&free)> aligned(static_cast<char *>(aligned_alloc(PAGE_SIZE, MAX_PAGES * PAGE_SIZE)),
+                                                   &free);
+    std::vector<char> unaligned(MAX_PAGES * PAGE_SIZE + 1);
+    std::vector<char *> aligned_ptrs(MAX_PAGES);
+    std::vector<char *> unaligned_ptrs(MAX_PAGES);
+    for (int i = 0; i < MAX_PAGES; i++) {
+        aligned_ptrs[i] = aligned.get() + i * PAGE_SIZE;
+        unaligned_ptrs[i] = unaligned.data() + 1 + i * PAGE_SIZE;
+        rand_buf(aligned_ptrs[i], PAGE_SIZE);
+    }
+    disk_manager_->write_pages(fd, 1, aligned_ptrs.data(), MAX_PAGES);
+    disk_manager_->read_pages(fd, 1, unaligned_ptrs.data(), MAX_PAGES);
+    EXPECT_EQ(std::memcmp(aligned.get(), unaligned.data() + 1, MAX_PAGES * PAGE_SIZE), 0);
+
+    rand_buf(unaligned_ptrs[0], PAGE_SIZE);
+    disk_manager_->write_page(fd, 1, unaligned_ptrs[0], PAGE_SIZE);
+    disk_manager_->read_page(fd, 1, aligned_ptrs[0], PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(aligned_ptrs[0], unaligned_ptrs[0], PAGE_SIZE), 0);
+
+    // 不足一页的读写，如文件头
+    const int partial = 100;
+    char header[partial];
+    rand_buf(header, partial);
+    disk_manager_->write_page(fd, 0, header, partial);
+    char header_read[partial];
+    disk_manager_->read_page(fd, 0, header_read, partial);
+    EXPECT_EQ(std::memcmp(header, header_read, partial), 0);
+    disk_manager_->read_page(fd, 0, aligned_ptrs[0], PAGE_SIZE);
+    for (int i = partial; i < PAGE_SIZE; i++) {
+        EXPECT_EQ(aligned_ptrs[0][i], 0);
+    }
+
+    // 异步接口同样处理未对齐的缓冲区
+    disk_manager_->enable_async_io();
+    auto write_handle = disk_manager_->submit_write_page(fd, 2, unaligned_ptrs[1]);
+    disk_manager_->complete_io(write_handle);
+    auto read_handle = disk_manager_->submit_read_page(fd, 2, aligned_ptrs[1]);
+    disk_manager_->complete_io(read_handle);
+    EXPECT_EQ(std::memcmp(aligned_ptrs[1], unaligned_ptrs[1], PAGE_SIZE), 0);
+    disk_manager_->disable_async_io();
+
+    disk_manager_->sync_file(fd);
+    disk_manager_->close_file(fd);
+    disk_manager_->close_file(buffered_fd);
+    disk_manager_->destroy_file(filename);
+    disk_manager_->destroy_file(filename + ".log");
+}
+
+/**
+ * @brief 测试页面压缩：LzCodec的压缩与解压，以及压缩文件的读写、原地覆盖、重新分配位置和重新打开
+ */
+TEST_F(DiskManagerTest, CompressedPageOperation) {
+    // 重复度高的数据（类似定长CHAR列）压缩率高，随机数据压缩失败，两者都能正确解压
+    std::vector<char> text(CompressedFile::EXTENT_SIZE);
+    for (size_t i = 0; i < text.size(); i++) {
+        text[i] = "abcdefgh"[(i / 7 + i % 3) % 8];
+    }
+    std::vector<char> random(CompressedFile::EXTENT_SIZE);
+    rand_buf(random.data(), random.size());
+    std::vector<char> compressed(CompressedFile::EXTENT_SIZE * 2);  // 随机数据压缩后会略微变大
+    std::vector<char> decompressed(CompressedFile::EXTENT_SIZE);
+    int len = LzCodec::compress(text.data(), text.size(), compressed.data(), compressed.size());
+    EXPECT_GT(len, 0);
+    EXPECT_LT(len, (int)text.size() / 4);
+    EXPECT_EQ(LzCodec::decompress(compressed.data(), len, decompressed.data(), decompressed.size()), (int)text.size());
+    EXPECT_EQ(decompressed, text);
+    EXPECT_EQ(LzCodec::compress(random.data(), random.size(), compressed.data(), random.size() - 1), 0);
+    len = LzCodec::compress(random.data(), random.size(), compressed.data(), compressed.size());
+    EXPECT_EQ(LzCodec::decompress(compressed.data(), len, decompressed.data(), decompressed.size()), (int)random.size());
+    EXPECT_EQ(decompressed, random);
+    EXPECT_EQ(LzCodec::decompress(compressed.data(), len, decompressed.data(), 100), -1);
+
+    const std::string filename = "CompressedPageOperationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename, true);
+    EXPECT_TRUE(disk_manager_->is_file(CompressedFile::map_file_name(filename)));
+    EXPECT_EQ(disk_manager_->get_file_size(filename), PAGE_SIZE);
+    int fd = disk_manager_->open_file(filename);
+    EXPECT_TRUE(disk_manager_->is_compressed(fd));
+    disk_manager_->set_fd2pageno(fd, 1);
+
+    // 顺序分配并写入MAX_PAGES个重复度高的页面，每页内容不同
+    std::vector<std::vector<char>> data(MAX_PAGES + 1, std::vector<char>(PAGE_SIZE));
+    std::vector<char *> bufs;
+    for (int i = 1; i <= MAX_PAGES; i++) {
+        EXPECT_EQ(disk_manager_->allocate_page(fd), i);
+        memcpy(data[i].data(), text.data() + i, PAGE_SIZE);
+        snprintf(data[i].data(), 32, "page %d", i);
+        bufs.push_back(data[i].data());
+    }
+    disk_manager_->write_pages(fd, 1, bufs.data(), MAX_PAGES);
+    EXPECT_EQ(disk_manager_->get_file_size(filename), (MAX_PAGES + 1) * PAGE_SIZE);
+    EXPECT_LT(disk_manager_->get_physical_size(fd), (MAX_PAGES + 1) * PAGE_SIZE / 4);
+
+    // 不足一页的写入（如文件头），以及把部分页面改为随机数据使extent变大、换到新位置
+    const int partial = 100;
+    rand_buf(data[0].data(), partial);
+    disk_manager_->write_page(fd, 0, data[0].data(), partial);
+    for (int i = 3; i <= MAX_PAGES; i += 17) {
+        rand_buf(data[i].data(), PAGE_SIZE);
+        data[i][0] = (char)i;
+        disk_manager_->write_page(fd, i, data[i].data(), PAGE_SIZE);
+    }
+    // 再改回重复度高的数据，extent缩小后原地覆盖
+    memcpy(data[3].data(), text.data(), PAGE_SIZE);
+    disk_manager_->write_page(fd, 3, data[3].data(), PAGE_SIZE);
+
+    // 关闭后重新打开，映射文件中的页面数和映射项都应保留
+    disk_manager_->close_file(fd);
+    EXPECT_EQ(disk_manager_->get_file_size(filename), (MAX_PAGES + 1) * PAGE_SIZE);
+    fd = disk_manager_->open_file(filename);
+    std::vector<char> buf(PAGE_SIZE);
+    disk_manager_->read_page(fd, 0, buf.data(), partial);
+    EXPECT_EQ(std::memcmp(buf.data(), data[0].data(), partial), 0);
+    std::vector<std::vector<char>> read_back(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<char *> read_bufs;
+    for (auto &page : read_back) {
+        read_bufs.push_back(page.data());
+    }
+    disk_manager_->read_pages(fd, 1, read_bufs.data(), MAX_PAGES);
+    for (int i = 1; i <= MAX_PAGES; i++) {
+        EXPECT_EQ(read_back[i - 1], data[i]) << "page " << i;
+    }
+    // 已分配但从未写过的页面为全零，超过文件大小的页面无法读取
+    EXPECT_EQ(disk_manager_->allocate_page(fd), MAX_PAGES + 1);
+    disk_manager_->read_page(fd, MAX_PAGES + 1, buf.data(), PAGE_SIZE);
+    EXPECT_EQ(buf, std::vector<char>(PAGE_SIZE, 0));
+    EXPECT_THROW(disk_manager_->read_page(fd, MAX_PAGES + 10, buf.data(), PAGE_SIZE), InternalError);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+    EXPECT_FALSE(disk_manager_->is_file(CompressedFile::map_file_name(filename)));
+}
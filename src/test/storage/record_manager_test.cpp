@@ -8,6 +8,8 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <random>
+#include <thread>
 #include <unordered_map>
 
 #include "gtest/gtest.h"
@@ -63,6 +65,112 @@ std::ostream &operator<<(std::ostream &os, const Rid &rid) {
     return os << '(' << rid.page_no << ", " << rid.slot_no << ')';
 }
 
+/**
+ * @brief 按字查找的next_bit和count与逐位查找的结果一致，覆盖不同的长度、起始位置和稀疏程度
+ */
+TEST(BitmapTest, WordSearchTest) {
+    std::mt19937 rng(42);
+    char bm[1024];
+    for (int max_n : {1, 7, 8, 63, 64, 65, 200, 511, 512, 777, 4096, 8000}) {
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        // 依次为全0、全1、只有最后一位不同，以及不同密度的随机位图
+        for (int pattern = 0; pattern < 6; pattern++) {
+            Bitmap::init(bm, sizeof(bm));
+            for (int i = 0; i < max_n; i++) {
+                bool set = false;
+                if (pattern == 1) {
+                    set = true;
+                } else if (pattern == 2) {
+                    set = i == max_n - 1;
+                } else if (pattern >= 3) {
+                    set = rng() % (pattern == 3 ? 2 : pattern == 4 ? 50 : 1000) == 0;
+                }
+                if (set) {
+                    Bitmap::set(bm, i);
+                }
+            }
+            // 位图之后的填充位和字节不应影响结果
+            if (max_n % BITMAP_WIDTH != 0) {
+                bm[num_bytes - 1] |= static_cast<char>(0xff >> (max_n % BITMAP_WIDTH));
+            }
+            memset(bm + num_bytes, 0x5a, sizeof(bm) - num_bytes);
+
+            int expected_count = 0;
+            for (int i = 0; i < max_n; i++) {
+                expected_count += Bitmap::is_set(bm, i) ? 1 : 0;
+            }
+            ASSERT_EQ(Bitmap::count(bm, max_n), expected_count) << "max_n=" << max_n << " pattern=" << pattern;
+            for (bool bit : {false, true}) {
+                for (int curr = -1; curr < max_n; curr++) {
+                    int expected = curr + 1;
+                    while (expected < max_n && Bitmap::is_set(bm, expected) != bit) {
+                        expected++;
+                    }
+                    ASSERT_EQ(Bitmap::next_bit(bit, bm, max_n, curr), expected)
+                        << "max_n=" << max_n << " pattern=" << pattern << " bit=" << bit << " curr=" << curr;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief RmRecord的复制、移动和赋值：小记录存放在对象内部，大记录移动时只转移指针，arena中的记录不由RmRecord释放
+ */
+TEST(RmRecordTest, StorageTest) {
+    char buf[RM_MAX_RECORD_SIZE];
+    rand_buf(sizeof(buf), buf);
+    for (int size : {1, RM_RECORD_INLINE_SIZE, RM_RECORD_INLINE_SIZE + 1, RM_MAX_RECORD_SIZE}) {
+        bool is_inline = size <= RM_RECORD_INLINE_SIZE;
+        RmRecord record(size, buf);
+        EXPECT_EQ(record.allocated_, !is_inline);
+
+        RmRecord copy(record);
+        EXPECT_NE(copy.data, record.data);
+        EXPECT_EQ(memcmp(copy.data, buf, size), 0);
+
+        char *heap_data = record.data;
+        RmRecord moved(std::move(record));
+        EXPECT_EQ(moved.size, size);
+        EXPECT_EQ(memcmp(moved.data, buf, size), 0);
+        EXPECT_EQ(moved.data == heap_data, !is_inline);
+        EXPECT_EQ(record.data, nullptr);
+
+        // 赋值时释放或复用原来的空间
+        RmRecord other(RM_MAX_RECORD_SIZE);
+        other = copy;
+        EXPECT_EQ(other.size, size);
+        EXPECT_EQ(memcmp(other.data, buf, size), 0);
+        other = std::move(moved);
+        EXPECT_EQ(memcmp(other.data, buf, size), 0);
+        other = other;
+        EXPECT_EQ(memcmp(other.data, buf, size), 0);
+    }
+
+    Arena arena(1024);
+    {
+        RmRecord record(RM_MAX_RECORD_SIZE, &arena);
+        EXPECT_FALSE(record.allocated_);
+        EXPECT_EQ(arena.get_bytes_allocated(), (size_t)RM_MAX_RECORD_SIZE);
+        memcpy(record.data, buf, RM_MAX_RECORD_SIZE);
+        RmRecord moved(std::move(record));
+        EXPECT_FALSE(moved.allocated_);
+        EXPECT_EQ(memcmp(moved.data, buf, RM_MAX_RECORD_SIZE), 0);
+        RmRecord small(8, &arena);
+        EXPECT_EQ(arena.get_bytes_allocated(), (size_t)RM_MAX_RECORD_SIZE);
+    }
+    // 超过块大小的分配单独占用一块，之后的小分配仍使用原来的块；分配的地址按要求对齐
+    arena.allocate(4096);
+    EXPECT_EQ(arena.get_num_blocks(), 2u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(arena.allocate(3, 64)) % 64, 0u);
+    EXPECT_EQ(arena.get_num_blocks(), 2u);
+    arena.allocate(1000);
+    EXPECT_EQ(arena.get_num_blocks(), 3u);
+    arena.reset();
+    EXPECT_EQ(arena.get_bytes_allocated(), 0u);
+    EXPECT_EQ(arena.get_num_blocks(), 0u);
+}
+
 /**
  * @brief 简单测试record的基本功能
  * @note lab1 计分：15 points
@@ -223,4 +331,468 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief 测试顺序扫描时的预读：扫描结果正确，且后续页面由预读载入后被命中
+ */
+TEST(RecordManagerTest, ReadAheadTest) {
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(256, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "read_ahead.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    int record_size = 200;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+
+    // 写入足够多的页面，关闭文件使页面全部写回磁盘并从缓冲池中移除
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    char write_buf[PAGE_SIZE];
+    for (int i = 0; i < 10000; i++) {
+        rand_buf(record_size, write_buf);
+        Rid rid = file_handle->insert_record(write_buf, context);
+        mock[rid] = std::string(write_buf, record_size);
+    }
+    int num_pages = file_handle->file_hdr_.num_pages;
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+
+    size_t num_records = 0;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+        assert(mock.count(scan.rid()) > 0);
+        num_records++;
+    }
+    assert(num_records == mock.size());
+    // 除第一个页面外，其余页面都应由预读载入，且不会超过缓冲池的预读上限而被浪费
+    EXPECT_EQ(buffer_pool_manager->get_prefetch_issued(), (size_t)(num_pages - 2));
+    EXPECT_EQ(buffer_pool_manager->get_prefetch_hits(), (size_t)(num_pages - 2));
+    EXPECT_EQ(buffer_pool_manager->get_prefetch_wasted(), 0u);
+
+    // 关闭预读时不发起任何预读
+    size_t issued = buffer_pool_manager->get_prefetch_issued();
+    for (RmScan scan(file_handle.get(), false); !scan.is_end(); scan.next()) {
+    }
+    EXPECT_EQ(buffer_pool_manager->get_prefetch_issued(), issued);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试空闲空间映射：并发插入的记录全部可见，删除后页面重新标为未满，FSM文件丢失后打开表时重建
+ */
+TEST(RecordManagerTest, FreeSpaceMapTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(1024, disk_manager.get(), "LRU", 4);
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "free_space_map.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    int record_size = 64;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+
+    // 多个线程并发插入，每条记录以线程号和序号开头
+    constexpr int NUM_THREADS = 8;
+    constexpr int RECORDS_PER_THREAD = 2000;
+    std::vector<std::vector<Rid>> rids(NUM_THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            char buf[64] = {};
+            for (int i = 0; i < RECORDS_PER_THREAD; i++) {
+                memcpy(buf, &t, sizeof(int));
+                memcpy(buf + sizeof(int), &i, sizeof(int));
+                rids[t].push_back(file_handle->insert_record(buf, nullptr));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        for (int i = 0; i < RECORDS_PER_THREAD; i++) {
+            std::string record(record_size, '\0');
+            memcpy(&record[0], &t, sizeof(int));
+            memcpy(&record[sizeof(int)], &i, sizeof(int));
+            mock[rids[t][i]] = record;
+        }
+    }
+    ASSERT_EQ(mock.size(), (size_t)NUM_THREADS * RECORDS_PER_THREAD);
+    check_equal(file_handle.get(), mock);
+
+    // 未满的页面数不超过插入者个数，其余页面都已写满
+    RmFreeSpaceMap *fsm = file_handle->fsm_.get();
+    int num_pages = file_handle->file_hdr_.num_pages;
+    int num_full = 0;
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < num_pages; page_no++) {
+        RmPageHandle page_handle = file_handle->fetch_page_handle(page_no);
+        bool has_free = page_handle.page_hdr->num_records < file_handle->file_hdr_.num_records_per_page;
+        EXPECT_EQ(fsm->is_free(page_no), has_free);
+        num_full += has_free ? 0 : 1;
+        buffer_pool_manager->unpin_page(page_handle.page->get_page_id(), false);
+    }
+    EXPECT_LE(fsm->get_num_free(), NUM_THREADS);
+    EXPECT_EQ(fsm->get_num_free() + num_full, num_pages - 1);
+
+    // 在已满的页面上删除一条记录后，页面重新标为未满，之后的插入不再创建新页面
+    for (int t = 0; t < NUM_THREADS; t++) {
+        Rid rid = rids[t][0];
+        if (!fsm->is_free(rid.page_no)) {
+            file_handle->delete_record(rid, nullptr);
+            mock.erase(rid);
+            EXPECT_TRUE(fsm->is_free(rid.page_no));
+        }
+    }
+    int num_free = fsm->get_num_free();
+    EXPECT_GT(num_free, 0);
+
+    // 删除FSM文件后重新打开，扫描表文件重建的FSM与原来一致
+    rm_manager->close_file(file_handle.get());
+    disk_manager->destroy_file(RmFreeSpaceMap::file_name(filename));
+    file_handle = rm_manager->open_file(filename);
+    fsm = file_handle->fsm_.get();
+    EXPECT_EQ(fsm->get_num_free(), num_free);
+    EXPECT_EQ(fsm->find_free_page(0) == RM_NO_PAGE, num_free == 0);
+    check_equal(file_handle.get(), mock);
+
+    char buf[64] = {};
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    EXPECT_LT(rid.page_no, num_pages);
+    EXPECT_EQ(file_handle->file_hdr_.num_pages, num_pages);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+    EXPECT_FALSE(disk_manager->is_file(RmFreeSpaceMap::file_name(filename)));
+}
+
+/**
+ * @brief 同一线程交替向两个表插入记录，每个表都从该线程上次在本表中插入的页面开始查找
+ */
+TEST(RecordManagerTest, InsertHintPerFileTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(1024, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::vector<std::string> filenames = {"insert_hint_a.txt", "insert_hint_b.txt"};
+    std::vector<std::unique_ptr<RmFileHandle>> handles;
+    for (auto &filename : filenames) {
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 500);
+        handles.push_back(rm_manager->open_file(filename));
+    }
+    RmFileHandle *a = handles[0].get(), *b = handles[1].get();
+    int per_page = b->file_hdr_.num_records_per_page;
+
+    // 在新线程中进行，使插入位置不受其他测试点留下的线程局部状态影响
+    std::thread([&]() {
+        char buf[500] = {};
+        // b中页面1写满后开始使用页面2，再删除页面1中的一条记录使两页都未满
+        std::vector<Rid> b_rids;
+        for (int i = 0; i <= per_page; i++) {
+            b_rids.push_back(b->insert_record(buf, nullptr));
+        }
+        EXPECT_EQ(b_rids.back().page_no, 2);
+        b->delete_record(b_rids[0], nullptr);
+        EXPECT_TRUE(b->fsm_->is_free(1));
+
+        // a使用到页面4，页号按b的页面数取模后落在页面1上
+        Rid rid;
+        for (int i = 0; i <= 3 * per_page; i++) {
+            rid = a->insert_record(buf, nullptr);
+        }
+        EXPECT_EQ(rid.page_no, 4);
+        EXPECT_EQ(b->insert_record(buf, nullptr).page_no, 2);
+        EXPECT_EQ(a->insert_record(buf, nullptr).page_no, 4);
+    }).join();
+
+    for (size_t i = 0; i < filenames.size(); i++) {
+        rm_manager->close_file(handles[i].get());
+        rm_manager->destroy_file(filenames[i]);
+    }
+}
+
+/**
+ * @brief 测试slotted格式：变长字段只存放实际长度，删除和缩短后压缩页面，过长的记录存放到溢出页，
+ * 随机插入、更新、删除后记录、扫描结果和FSM都正确，重新打开后仍然一致
+ */
+TEST(RecordManagerTest, SlottedPageTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(256, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "slotted_page.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    // int | varchar(300) | int | varchar(3000)
+    const std::vector<RmField> var_fields = {{4, 300}, {308, 3000}};
+    int record_size = 3308;
+    rm_manager->create_file(filename, record_size, RM_PAGE_FORMAT_SLOTTED, var_fields);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_slotted());
+
+    std::mt19937 rng(7);
+    auto make_record = [&](bool allow_overflow) {
+        std::string record(record_size, '\0');
+        int a = rng(), b = rng();
+        memcpy(&record[0], &a, sizeof(int));
+        memcpy(&record[304], &b, sizeof(int));
+        int s_len = rng() % 301;
+        // 大部分记录较短，少数记录超过页面的1/4，需要溢出页
+        int t_len = allow_overflow && rng() % 8 == 0 ? 1000 + rng() % 2001 : rng() % 50;
+        for (int i = 0; i < s_len; i++) {
+            record[4 + i] = 'a' + rng() % 26;
+        }
+        for (int i = 0; i < t_len; i++) {
+            record[308 + i] = 'A' + rng() % 26;
+        }
+        return record;
+    };
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    std::vector<Rid> deleted;
+    auto check = [&]() {
+        for (auto &entry : mock) {
+            auto rec = file_handle->get_record(entry.first, nullptr);
+            ASSERT_NE(rec, nullptr);
+            ASSERT_EQ(memcmp(rec->data, entry.second.data(), record_size), 0);
+        }
+        for (auto &rid : deleted) {
+            if (mock.count(rid) == 0) {
+                EXPECT_FALSE(file_handle->is_record(rid));
+            }
+        }
+        size_t num_records = 0;
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            ASSERT_GT(mock.count(scan.rid()), 0u);
+            num_records++;
+        }
+        EXPECT_EQ(num_records, mock.size());
+        // FSM与页面中的空闲空间一致，溢出页不会被标为未满
+        for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_handle->file_hdr_.num_pages; page_no++) {
+            PageGuard page_guard(buffer_pool_manager.get(), file_handle->fetch_page_handle(page_no).page);
+            EXPECT_EQ(file_handle->fsm_->is_free(page_no), file_handle->page_has_free_space(page_guard.get()));
+        }
+    };
+
+    constexpr int NUM_INSERTS = 2000;
+    for (int i = 0; i < NUM_INSERTS; i++) {
+        std::string record = make_record(true);
+        Rid rid = file_handle->insert_record(&record[0], nullptr);
+        ASSERT_EQ(mock.count(rid), 0u);
+        mock[rid] = record;
+    }
+    check();
+    // 定长格式每页只能放一条记录，slotted格式按实际长度存放
+    EXPECT_LT(file_handle->file_hdr_.num_pages, NUM_INSERTS / 2);
+
+    for (int i = 0; i < 3000; i++) {
+        int op = rng() % 3;
+        if (op == 0 || mock.empty()) {
+            std::string record = make_record(true);
+            Rid rid = file_handle->insert_record(&record[0], nullptr);
+            ASSERT_EQ(mock.count(rid), 0u);
+            mock[rid] = record;
+        } else {
+            auto it = std::next(mock.begin(), rng() % mock.size());
+            Rid rid = it->first;
+            if (op == 1) {
+                std::string record = make_record(true);
+                file_handle->update_record(rid, &record[0], nullptr);
+                it->second = record;
+            } else {
+                file_handle->delete_record(rid, nullptr);
+                mock.erase(it);
+                deleted.push_back(rid);
+            }
+        }
+    }
+    check();
+
+    // 重新打开后内容不变；删除全部记录后溢出页被回收为数据页，再插入不需要溢出页的记录不创建新页面
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_slotted());
+    check();
+    for (auto &entry : mock) {
+        file_handle->delete_record(entry.first, nullptr);
+    }
+    mock.clear();
+    int num_pages = file_handle->file_hdr_.num_pages;
+    EXPECT_EQ(file_handle->fsm_->get_num_free(), num_pages - 1);
+    for (int i = 0; i < 200; i++) {
+        std::string record = make_record(false);
+        mock[file_handle->insert_record(&record[0], nullptr)] = record;
+    }
+    EXPECT_EQ(file_handle->file_hdr_.num_pages, num_pages);
+    check();
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试PAX格式：同一列的值在页面中连续存放，按列读取的列向量和按行读取的记录都与写入的一致
+ */
+TEST(RecordManagerTest, PaxLayoutTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(256, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "pax_layout.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    const std::vector<RmField> columns = {{0, 4}, {4, 16}, {20, 8}, {28, 36}};
+    int record_size = 64;
+    rm_manager->create_file(filename, record_size, RM_PAGE_FORMAT_PAX, columns);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_pax());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    char buf[64];
+    for (int i = 0; i < 3000; i++) {
+        rand_buf(record_size, buf);
+        mock[file_handle->insert_record(buf, nullptr)] = std::string(buf, record_size);
+    }
+    for (int i = 0; i < 1000; i++) {
+        auto it = std::next(mock.begin(), rand() % mock.size());
+        if (i % 2 == 0) {
+            rand_buf(record_size, buf);
+            file_handle->update_record(it->first, buf, nullptr);
+            it->second = std::string(buf, record_size);
+        } else {
+            file_handle->delete_record(it->first, nullptr);
+            mock.erase(it);
+        }
+    }
+    check_equal(file_handle.get(), mock);
+
+    // 每一列的列向量中，第slot_no个值就是该记录中的对应字段
+    size_t num_records = 0;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next_page()) {
+        RmColumnPage column_page = file_handle->get_column_page(scan.rid().page_no);
+        ASSERT_TRUE(column_page);
+        for (int slot_no = scan.rid().slot_no; slot_no < column_page.num_slots();
+             slot_no = column_page.next_used(slot_no)) {
+            const std::string &record = mock.at(Rid{column_page.page_no(), slot_no});
+            for (int col_no = 0; col_no < (int)columns.size(); col_no++) {
+                int width = column_page.column_width(col_no);
+                ASSERT_EQ(width, columns[col_no].len);
+                ASSERT_EQ(memcmp(column_page.column(col_no) + slot_no * width, &record[columns[col_no].offset], width),
+                          0);
+            }
+            num_records++;
+        }
+    }
+    EXPECT_EQ(num_records, mock.size());
+
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_pax());
+    check_equal(file_handle.get(), mock);
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试批量插入insert_records：先填满已有页面中的空闲slot，再顺序填充新页面，
+ * 每条记录的Rid互不相同且内容正确，FSM与页面一致；定长格式和slotted格式都需要测试
+ */
+TEST(RecordManagerTest, BulkInsertTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(256, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::mt19937 rng(11);
+    for (RmPageFormat page_format : {RM_PAGE_FORMAT_FIXED, RM_PAGE_FORMAT_SLOTTED}) {
+        std::string filename = "bulk_insert.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        // int | char(60)，slotted格式中第二列为varchar(60)
+        int record_size = 64;
+        std::vector<RmField> var_fields;
+        if (page_format == RM_PAGE_FORMAT_SLOTTED) {
+            var_fields.push_back({4, 60});
+        }
+        rm_manager->create_file(filename, record_size, page_format, var_fields);
+        auto file_handle = rm_manager->open_file(filename);
+
+        auto make_record = [&](int id) {
+            std::string record(record_size, '\0');
+            memcpy(&record[0], &id, sizeof(int));
+            int len = rng() % 61;
+            for (int i = 0; i < len; i++) {
+                record[4 + i] = 'a' + rng() % 26;
+            }
+            return record;
+        };
+
+        // 先逐条插入，再删除其中的一部分，留下空洞
+        std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+        std::vector<Rid> rids;
+        for (int i = 0; i < 1000; i++) {
+            std::string record = make_record(i);
+            Rid rid = file_handle->insert_record(&record[0], nullptr);
+            mock[rid] = record;
+            rids.push_back(rid);
+        }
+        for (size_t i = 0; i < rids.size(); i += 3) {
+            file_handle->delete_record(rids[i], nullptr);
+            mock.erase(rids[i]);
+        }
+        int num_pages_before = file_handle->file_hdr_.num_pages;
+
+        constexpr int NUM_BULK = 5000;
+        std::vector<std::string> records;
+        std::vector<char *> bufs;
+        for (int i = 0; i < NUM_BULK; i++) {
+            records.push_back(make_record(10000 + i));
+        }
+        for (auto &record : records) {
+            bufs.push_back(&record[0]);
+        }
+        std::vector<Rid> bulk_rids(NUM_BULK);
+        file_handle->insert_records(bufs.data(), NUM_BULK, bulk_rids.data(), nullptr);
+        for (int i = 0; i < NUM_BULK; i++) {
+            ASSERT_EQ(mock.count(bulk_rids[i]), 0u);
+            mock[bulk_rids[i]] = records[i];
+        }
+
+        // 删除留下的空洞先被填满：前num_pages_before个页面中不再有空闲空间
+        for (int page_no = RM_FIRST_RECORD_PAGE; page_no < num_pages_before; page_no++) {
+            EXPECT_FALSE(file_handle->fsm_->is_free(page_no));
+        }
+        for (auto &entry : mock) {
+            auto rec = file_handle->get_record(entry.first, nullptr);
+            ASSERT_NE(rec, nullptr);
+            ASSERT_EQ(memcmp(rec->data, entry.second.data(), record_size), 0);
+        }
+        size_t num_records = 0;
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            num_records++;
+        }
+        EXPECT_EQ(num_records, mock.size());
+        for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_handle->file_hdr_.num_pages; page_no++) {
+            PageGuard page_guard(buffer_pool_manager.get(), file_handle->fetch_page_handle(page_no).page);
+            EXPECT_EQ(file_handle->fsm_->is_free(page_no), file_handle->page_has_free_space(page_guard.get()));
+        }
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
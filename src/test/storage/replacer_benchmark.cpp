@@ -0,0 +1,115 @@
+/**
+ * @brief 比较各置换策略在“点查询 + 全表扫描”混合负载下的命中率
+ *
+ * 用法: replacer_benchmark [pool_frames] [table_pages] [num_ops]
+ * 负载：点查询中80%落在大小为缓冲池一半的热点页面上，其余均匀分布在整张表上；
+ *      每执行scan_interval次点查询就插入一次对整张表的顺序扫描。
+ * 只模拟缓冲池的页表和置换，不产生磁盘I/O，分别统计点查询和全部访问的命中率。
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+#include "replacer/two_q_replacer.h"
+
+struct SimResult {
+    size_t point_hits = 0;
+    size_t point_accesses = 0;
+    size_t hits = 0;
+    size_t accesses = 0;
+    double seconds = 0;
+};
+
+class PoolSimulator {
+   public:
+    PoolSimulator(Replacer *replacer, size_t pool_frames)
+        : replacer_(replacer), frame2page_(pool_frames, -1), next_free_(0) {}
+
+    bool access(int page_no) {
+        auto it = page_table_.find(page_no);
+        if (it != page_table_.end()) {
+            replacer_->pin(it->second);
+            replacer_->unpin(it->second);
+            return true;
+        }
+        frame_id_t frame_id;
+        if (next_free_ < frame2page_.size()) {
+            frame_id = next_free_++;
+        } else {
+            if (!replacer_->victim(&frame_id)) {
+                abort();
+            }
+            page_table_.erase(frame2page_[frame_id]);
+        }
+        frame2page_[frame_id] = page_no;
+        page_table_[page_no] = frame_id;
+        replacer_->pin(frame_id);
+        replacer_->unpin(frame_id);
+        return false;
+    }
+
+   private:
+    Replacer *replacer_;
+    std::unordered_map<int, frame_id_t> page_table_;
+    std::vector<int> frame2page_;
+    size_t next_free_;
+};
+
+SimResult run(Replacer *replacer, size_t pool_frames, int table_pages, size_t num_ops) {
+    std::mt19937 rng(42);  // 所有策略使用相同的访问序列
+    const int hot_pages = (int)pool_frames / 2;
+    const size_t scan_interval = num_ops / 8;
+    std::uniform_int_distribution<int> hot_dist(0, hot_pages - 1);
+    std::uniform_int_distribution<int> all_dist(0, table_pages - 1);
+    std::uniform_int_distribution<int> dice(0, 99);
+
+    PoolSimulator sim(replacer, pool_frames);
+    SimResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t op = 0; op < num_ops; op++) {
+        if (op > 0 && op % scan_interval == 0) {
+            for (int page_no = 0; page_no < table_pages; page_no++) {
+                result.hits += sim.access(page_no);
+                result.accesses++;
+            }
+        }
+        // 热点页面分散在表中，避免与扫描的顺序产生偶然的相关性
+        int page_no = dice(rng) < 80 ? (int)((hot_dist(rng) * 7919L) % table_pages) : all_dist(rng);
+        bool hit = sim.access(page_no);
+        result.point_hits += hit;
+        result.point_accesses++;
+        result.hits += hit;
+        result.accesses++;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    size_t pool_frames = argc > 1 ? std::stoul(argv[1]) : 8192;
+    int table_pages = argc > 2 ? std::stoi(argv[2]) : 65536;
+    size_t num_ops = argc > 3 ? std::stoul(argv[3]) : 2000000;
+
+    printf("pool=%zu frames, table=%d pages, %zu point lookups, 8 full scans\n", pool_frames, table_pages, num_ops);
+    printf("%-8s %16s %16s %10s\n", "replacer", "point hit rate", "total hit rate", "time(s)");
+
+    std::vector<std::pair<std::string, std::unique_ptr<Replacer>>> replacers;
+    replacers.emplace_back("LRU", std::make_unique<LRUReplacer>(pool_frames));
+    replacers.emplace_back("CLOCK", std::make_unique<ClockReplacer>(pool_frames));
+    replacers.emplace_back("LRU-K", std::make_unique<LRUKReplacer>(pool_frames));
+    replacers.emplace_back("2Q", std::make_unique<TwoQReplacer>(pool_frames));
+    for (auto &entry : replacers) {
+        SimResult r = run(entry.second.get(), pool_frames, table_pages, num_ops);
+        printf("%-8s %15.2f%% %15.2f%% %10.3f\n", entry.first.c_str(), 100.0 * r.point_hits / r.point_accesses,
+               100.0 * r.hits / r.accesses, r.seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+#include "replacer/two_q_replacer.h"
+
+/**
+ * @brief 所有置换策略都必须满足的Replacer接口语义
+ */
+template <typename T>
+class ReplacerTest : public ::testing::Test {};
+
+using ReplacerTypes = ::testing::Types<LRUReplacer, ClockReplacer, LRUKReplacer, TwoQReplacer>;
+TYPED_TEST_SUITE(ReplacerTest, ReplacerTypes);
+
+TYPED_TEST(ReplacerTest, BasicContract) {
+    TypeParam replacer(7);
+    frame_id_t value;
+    EXPECT_FALSE(replacer.victim(&value));
+
+    for (frame_id_t i = 1; i <= 6; i++) {
+        replacer.pin(i);
+        replacer.unpin(i);
+    }
+    replacer.unpin(1);  // 重复unpin不产生影响
+    EXPECT_EQ(6u, replacer.Size());
+
+    // 被pin的frame不会成为victim
+    replacer.pin(3);
+    replacer.pin(4);
+    EXPECT_EQ(4u, replacer.Size());
+
+    std::vector<frame_id_t> victims;
+    while (replacer.victim(&value)) {
+        victims.push_back(value);
+    }
+    std::sort(victims.begin(), victims.end());
+    EXPECT_EQ(victims, (std::vector<frame_id_t>{1, 2, 5, 6}));
+    EXPECT_EQ(0u, replacer.Size());
+
+    replacer.unpin(4);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(4, value);
+}
+
+TYPED_TEST(ReplacerTest, ColdFrames) {
+    TypeParam replacer(8);
+    for (frame_id_t i = 0; i < 5; i++) {
+        replacer.unpin(i);
+    }
+    std::vector<frame_id_t> cold;
+    replacer.cold_frames(3, &cold);
+    EXPECT_EQ(cold, (std::vector<frame_id_t>{0, 1, 2}));
+    EXPECT_EQ(5u, replacer.Size());  // 只列出，不淘汰
+
+    // 列出的顺序就是随后被淘汰的顺序
+    cold.clear();
+    replacer.cold_frames(8, &cold);
+    std::vector<frame_id_t> victims;
+    frame_id_t value;
+    while (replacer.victim(&value)) {
+        victims.push_back(value);
+    }
+    EXPECT_EQ(cold, victims);
+}
+
+TYPED_TEST(ReplacerTest, ConcurrencyTest) {
+    const int num_threads = 5;
+    const int value_size = 1000;
+    TypeParam replacer(value_size);
+    std::vector<int> value(value_size);
+    for (int i = 0; i < value_size; i++) {
+        value[i] = i;
+    }
+    std::shuffle(value.begin(), value.end(), std::default_random_engine{});
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([tid, &replacer, &value]() {
+            int share = value_size / num_threads;
+            for (int i = 0; i < share; i++) {
+                replacer.pin(value[tid * share + i]);
+                replacer.unpin(value[tid * share + i]);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::vector<int> out_values;
+    frame_id_t result;
+    for (int i = 0; i < value_size; i++) {
+        EXPECT_TRUE(replacer.victim(&result));
+        out_values.push_back(result);
+    }
+    std::sort(value.begin(), value.end());
+    std::sort(out_values.begin(), out_values.end());
+    EXPECT_EQ(value, out_values);
+    EXPECT_FALSE(replacer.victim(&result));
+}
+
+/**
+ * @brief CLOCK：访问位为1的frame获得第二次机会
+ */
+TEST(ClockReplacerTest, SecondChance) {
+    ClockReplacer replacer(4);
+    for (frame_id_t i = 0; i < 4; i++) {
+        replacer.unpin(i);
+    }
+    frame_id_t value;
+    // 第一轮扫描清除所有访问位，随后按时钟顺序淘汰
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    // frame 1再次被访问，访问位重新置1，下一次淘汰跳过它
+    replacer.pin(1);
+    replacer.unpin(1);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(1, value);
+}
+
+/**
+ * @brief 无锁CLOCK：多个线程并发淘汰和pin/unpin时，每个可淘汰的frame恰好被淘汰一次
+ */
+TEST(ClockReplacerTest, ConcurrentVictim) {
+    const int num_frames = 4096;
+    const int num_threads = 4;
+    ClockReplacer replacer(num_frames);
+    for (frame_id_t i = 0; i < num_frames; i++) {
+        replacer.unpin(i);
+    }
+    // 一个线程对前一半frame反复做pin/unpin，与淘汰线程竞争
+    std::atomic<bool> touching{true};
+    std::thread toucher([&]() {
+        for (int round = 0; round < 50; round++) {
+            for (frame_id_t i = 0; i < num_frames / 2; i++) {
+                replacer.pin(i);
+                replacer.unpin(i);
+            }
+        }
+        touching = false;
+    });
+    std::vector<std::vector<frame_id_t>> victims(num_threads);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&, tid]() {
+            frame_id_t frame_id;
+            while (true) {
+                bool still_touching = touching;
+                if (replacer.victim(&frame_id)) {
+                    victims[tid].push_back(frame_id);
+                } else if (!still_touching) {
+                    break;
+                }
+            }
+        });
+    }
+    toucher.join();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // 后一半frame只被unpin过一次，恰好被淘汰一次；前一半在淘汰后可能被toucher重新加入
+    std::vector<int> count(num_frames, 0);
+    for (auto &list : victims) {
+        for (frame_id_t frame_id : list) {
+            count[frame_id]++;
+        }
+    }
+    for (int i = num_frames / 2; i < num_frames; i++) {
+        EXPECT_EQ(1, count[i]);
+    }
+    for (int i = 0; i < num_frames / 2; i++) {
+        EXPECT_GE(count[i], 1);
+    }
+    EXPECT_EQ(0u, replacer.Size());
+}
+
+/**
+ * @brief LRU-K：只访问过一次的frame（扫描）先于访问过K次的frame被淘汰，同类中按对应的时间先后淘汰
+ */
+TEST(LRUKReplacerTest, ScanResistance) {
+    LRUKReplacer replacer(8, 2);
+    // 热点frame 0、1各访问两次
+    for (int round = 0; round < 2; round++) {
+        for (frame_id_t i = 0; i < 2; i++) {
+            replacer.pin(i);
+            replacer.unpin(i);
+        }
+    }
+    // 扫描frame 2~7，各访问一次
+    for (frame_id_t i = 2; i < 8; i++) {
+        replacer.pin(i);
+        replacer.unpin(i);
+    }
+    frame_id_t value;
+    for (frame_id_t expected = 2; expected < 8; expected++) {
+        EXPECT_TRUE(replacer.victim(&value));
+        EXPECT_EQ(expected, value);
+    }
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    // 被淘汰的frame历史清空，重新装入的页面只算一次访问
+    replacer.pin(0);
+    replacer.unpin(0);
+    replacer.pin(1);
+    replacer.unpin(1);
+    replacer.pin(1);
+    replacer.unpin(1);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+}
+
+/**
+ * @brief 2Q：扫描页面只在A1中轮转，Am中的热点页面保持不被淘汰
+ */
+TEST(TwoQReplacerTest, ScanResistance) {
+    const int num_frames = 16;
+    TwoQReplacer replacer(num_frames);
+    // frame 0~7 为热点，各访问两次后进入Am
+    for (int round = 0; round < 2; round++) {
+        for (frame_id_t i = 0; i < 8; i++) {
+            replacer.pin(i);
+            if (round == 1) replacer.unpin(i);
+        }
+    }
+    // frame 8~15 被扫描访问一次后进入A1，超过A1容量（16 / 4 = 4）的部分先于热点被淘汰
+    for (frame_id_t i = 8; i < num_frames; i++) {
+        replacer.pin(i);
+        replacer.unpin(i);
+    }
+    frame_id_t value;
+    for (frame_id_t expected = 8; expected < 12; expected++) {
+        EXPECT_TRUE(replacer.victim(&value));
+        EXPECT_EQ(expected, value);
+    }
+    // A1不超过容量后从Am按LRU淘汰
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+}